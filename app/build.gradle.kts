@@ -1,7 +1,81 @@
+import javax.inject.Inject
+import org.gradle.process.ExecOperations
+
 plugins {
     alias(libs.plugins.android.application)
 }
 
+// Compiles src/main/shaders to the SPIR-V the renderer loads from its assets: the GLSL
+// shaders with the NDK's glslc, shader.slang with slangc from the Vulkan SDK
+abstract class CompileShadersTask : DefaultTask() {
+    @get:InputDirectory
+    @get:PathSensitive(PathSensitivity.RELATIVE)
+    abstract val sourceDir: DirectoryProperty
+
+    @get:Internal
+    abstract val ndkDir: DirectoryProperty
+
+    @get:OutputDirectory
+    abstract val outputDir: DirectoryProperty
+
+    @get:Inject
+    abstract val execOperations: ExecOperations
+
+    @TaskAction
+    fun compile() {
+        val sources = sourceDir.get().asFile
+        val output = outputDir.get().asFile
+        val windows = System.getProperty("os.name").startsWith("Windows")
+
+        val glslc = ndkDir.get().asFile.resolve("shader-tools").listFiles().orEmpty()
+            .map { it.resolve(if (windows) "glslc.exe" else "glslc") }
+            .firstOrNull { it.canExecute() }
+            ?: throw GradleException("glslc not found under ${ndkDir.get().asFile}/shader-tools")
+        for ((shader, arguments) in glslShaders) {
+            execOperations.exec {
+                commandLine(listOf(glslc.path) + arguments +
+                            listOf(sources.resolve(shader).path, "-o", output.resolve("$shader.spv").path))
+            }
+        }
+
+        val slangDirs = listOfNotNull(System.getenv("VULKAN_SDK")?.let { "$it/bin" }) +
+                        System.getenv("PATH").orEmpty().split(File.pathSeparator)
+        val slangc = slangDirs.map { File(it, if (windows) "slangc.exe" else "slangc") }
+            .firstOrNull { it.canExecute() }
+            ?: throw GradleException("slangc not found: install the Vulkan SDK (VULKAN_SDK) or put slangc on PATH")
+        execOperations.exec {
+            commandLine(listOf(slangc.path, sources.resolve("shader.slang").path, "-target", "spirv") +
+                        slangEntryPoints.flatMap { (entry, stage) -> listOf("-entry", entry, "-stage", stage) } +
+                        listOf("-o", output.resolve("shader.spv").path))
+        }
+    }
+
+    companion object {
+        // Source file and extra glslc arguments; each one becomes <source>.spv
+        val glslShaders = listOf(
+            "shader.vert" to listOf<String>(),
+            "shader_packed.vert" to listOf<String>(),
+            "shader.frag" to listOf<String>(),
+            "shader_atlas.frag" to listOf<String>(),
+            "shader_bindless.frag" to listOf("--target-env=vulkan1.1"),
+            "shader_virtual.frag" to listOf<String>(),
+            "mipmap.comp" to listOf<String>(),
+            "meshlet.task" to listOf("--target-env=vulkan1.1", "--target-spv=spv1.4"),
+            "meshlet.mesh" to listOf("--target-env=vulkan1.1", "--target-spv=spv1.4"),
+        )
+
+        // Entry points of shader.spv, all in one module
+        val slangEntryPoints = listOf(
+            "vertexMain" to "vertex",
+            "vertexMainPacked" to "vertex",
+            "fragmentMain" to "fragment",
+            "fragmentMainAtlas" to "fragment",
+            "fragmentMainBindless" to "fragment",
+            "fragmentMainVirtual" to "fragment",
+        )
+    }
+}
+
 android {
     namespace = "com.example.myapplication"
     compileSdk {
@@ -44,6 +118,11 @@ android {
     buildFeatures {
         prefab = true
     }
+    androidResources {
+        // Preprocessed meshes, KTX2 textures and virtual texture tiles are mapped in place
+        // with AAsset_getBuffer (KTX2 levels and .vtex tiles are zstd compressed already)
+        noCompress += listOf("vmesh", "ktx2", "vtex")
+    }
     externalNativeBuild {
         cmake {
             path = file("src/main/cpp/CMakeLists.txt")
@@ -52,6 +131,17 @@ android {
     }
 }
 
+androidComponents {
+    onVariants { variant ->
+        val compileShaders = tasks.register<CompileShadersTask>(
+            "compile${variant.name.replaceFirstChar { it.uppercase() }}Shaders") {
+            sourceDir.set(layout.projectDirectory.dir("src/main/shaders"))
+            ndkDir.set(androidComponents.sdkComponents.ndkDirectory)
+        }
+        variant.sources.assets?.addGeneratedSourceDirectory(compileShaders, CompileShadersTask::outputDir)
+    }
+}
+
 dependencies {
     implementation(libs.androidx.core.ktx)
     implementation(libs.androidx.appcompat)
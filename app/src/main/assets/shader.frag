@@ -1,14 +0,0 @@
-#version 450
-#extension GL_EXT_nonuniform_qualifier : enable
-
-layout(binding = 1) uniform sampler2D texSamplers[16];
-
-layout(location = 0) in vec3 fragColor;
-layout(location = 1) in vec2 fragTexCoord;
-layout(location = 2) flat in int fragTexIndex;
-
-layout(location = 0) out vec4 outColor;
-
-void main() {
-    outColor = texture(texSamplers[fragTexIndex], fragTexCoord);
-}
\ No newline at end of file
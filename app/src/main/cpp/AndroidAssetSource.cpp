@@ -0,0 +1,20 @@
+#include "AndroidAssetSource.h"
+
+AssetData AndroidAssetSource::open(const std::string& path) {
+    AssetData data;
+    AAsset* asset = AAssetManager_open(assetManager, path.c_str(), AASSET_MODE_BUFFER);
+    if (!asset) {
+        return data;
+    }
+
+    const void* buffer = AAsset_getBuffer(asset);
+    if (!buffer) {
+        AAsset_close(asset);
+        return data;
+    }
+
+    data.data = buffer;
+    data.size = static_cast<size_t>(AAsset_getLength64(asset));
+    data.owner = std::shared_ptr<const void>(asset, AAsset_close);
+    return data;
+}
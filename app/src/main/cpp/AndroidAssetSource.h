@@ -0,0 +1,17 @@
+#pragma once
+
+#include "AssetSource.h"
+
+#include <android/asset_manager.h>
+
+// APK assets through the AAssetManager. Entries stored uncompressed (png, vmesh, see
+// noCompress in build.gradle.kts) are returned as an mmap of the APK; compressed ones
+// are inflated once by the asset manager, never copied again.
+class AndroidAssetSource : public AssetSource {
+public:
+    explicit AndroidAssetSource(AAssetManager* assetManager) : assetManager(assetManager) {}
+    AssetData open(const std::string& path) override;
+
+private:
+    AAssetManager* assetManager;
+};
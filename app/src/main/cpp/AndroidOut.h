@@ -9,8 +9,11 @@
  *
  * ex:
  *  aout << "Hello World" << std::endl;
+ *
+ * Every thread has its own buffer, so loader tasks on worker threads can log without
+ * interleaving their lines.
  */
-extern std::ostream aout;
+extern thread_local std::ostream aout;
 
 /*!
  * Use this class to create an output stream that writes to logcat. By default, a global one is
@@ -0,0 +1,245 @@
+#include "AssetCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+const char* const kTempSuffix = ".tmp";
+
+uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t read64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t hashRound(uint64_t accumulator, uint64_t input) {
+    return rotl(accumulator + input * kPrime2, 31) * kPrime1;
+}
+
+uint64_t merge(uint64_t hash, uint64_t lane) {
+    return (hash ^ hashRound(0, lane)) * kPrime1 + kPrime4;
+}
+
+uint64_t nowNs() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+bool writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= size_t(written);
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t hash;
+
+    // Four independent lanes, 32 bytes per step
+    if (size >= 32) {
+        uint64_t lanes[4] = {seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1};
+        for (; p + 32 <= end; p += 32) {
+            for (int i = 0; i < 4; i++) {
+                lanes[i] = hashRound(lanes[i], read64(p + i * 8));
+            }
+        }
+        hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+        for (uint64_t lane : lanes) {
+            hash = merge(hash, lane);
+        }
+    } else {
+        hash = seed + kPrime5;
+    }
+    hash += uint64_t(size);
+
+    for (; p + 8 <= end; p += 8) {
+        hash = rotl(hash ^ hashRound(0, read64(p)), 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        uint32_t word;
+        std::memcpy(&word, p, sizeof(word));
+        hash = rotl(hash ^ (uint64_t(word) * kPrime1), 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash = rotl(hash ^ (*p * kPrime5), 11) * kPrime1;
+    }
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+AssetCache::AssetCache(std::string directory, uint64_t capacity)
+    : root(std::move(directory)), capacity(capacity), files(root) {
+    if (!root.empty() && root.back() != '/') {
+        root += '/';
+    }
+
+    // Create every missing component
+    for (size_t slash = root.find('/', 1); slash != std::string::npos; slash = root.find('/', slash + 1)) {
+        ::mkdir(root.substr(0, slash).c_str(), 0700);
+    }
+
+    // Index what earlier runs left behind; temporary files are from interrupted writes
+    DIR* dir = ::opendir(root.c_str());
+    if (!dir) {
+        return;
+    }
+    while (dirent* item = ::readdir(dir)) {
+        std::string name = item->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string path = root + name;
+        struct stat info;
+        if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+            continue;
+        }
+        if (name.find(kTempSuffix) != std::string::npos) {
+            ::unlink(path.c_str());
+            continue;
+        }
+        uint64_t lastUse = uint64_t(info.st_mtim.tv_sec) * 1000000000ull + uint64_t(info.st_mtim.tv_nsec);
+        entries[name] = Entry{uint64_t(info.st_size), lastUse};
+        counters.bytes += uint64_t(info.st_size);
+    }
+    ::closedir(dir);
+    evict(std::string());
+}
+
+std::string AssetCache::makeKey(const char* kind, uint32_t version, uint64_t contentHash) {
+    char key[96];
+    std::snprintf(key, sizeof(key), "%s-v%u-%016llx", kind, version, (unsigned long long)contentHash);
+    return key;
+}
+
+AssetData AssetCache::load(const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            counters.misses++;
+            return AssetData{};
+        }
+        it->second.lastUse = nowNs();
+    }
+
+    AssetData data = files.open(key);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!data) {
+        // Deleted behind our back
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            counters.bytes -= it->second.size;
+            entries.erase(it);
+        }
+        counters.misses++;
+        return data;
+    }
+    counters.hits++;
+    // Persist the use for the LRU order of the next run
+    ::utimensat(AT_FDCWD, (root + key).c_str(), nullptr, 0);
+    return data;
+}
+
+bool AssetCache::store(const std::string& key, const void* header, size_t headerSize, const void* payload,
+                       size_t payloadSize) {
+    const uint64_t size = uint64_t(headerSize) + payloadSize;
+    if (size > capacity) {
+        return false;
+    }
+
+    std::string temp;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        temp = root + key + kTempSuffix + std::to_string(::getpid()) + "-" + std::to_string(tempCounter++);
+    }
+
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = writeAll(fd, header, headerSize) && writeAll(fd, payload, payloadSize) && ::fsync(fd) == 0;
+    written = ::close(fd) == 0 && written;
+    if (!written || ::rename(temp.c_str(), (root + key).c_str()) != 0) {
+        ::unlink(temp.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto [it, inserted] = entries.emplace(key, Entry{size, nowNs()});
+    if (!inserted) {
+        counters.bytes -= it->second.size;
+        it->second = Entry{size, nowNs()};
+    }
+    counters.bytes += size;
+    counters.stores++;
+    evict(key);
+    return true;
+}
+
+AssetCache::Stats AssetCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void AssetCache::evict(const std::string& keep) {
+    if (counters.bytes <= capacity) {
+        return;
+    }
+
+    // Oldest first; readers holding a mapping of an evicted file keep their bytes
+    std::vector<std::pair<uint64_t, std::string>> order;
+    order.reserve(entries.size());
+    for (const auto& [name, entry] : entries) {
+        if (name != keep) {
+            order.emplace_back(entry.lastUse, name);
+        }
+    }
+    std::sort(order.begin(), order.end());
+    for (const auto& [lastUse, name] : order) {
+        if (counters.bytes <= capacity) {
+            break;
+        }
+        ::unlink((root + name).c_str());
+        counters.bytes -= entries[name].size;
+        entries.erase(name);
+        counters.evictions++;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "AssetSource.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// 64-bit content hash for cache keys (xxHash64-style, not cryptographic)
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+// On-disk cache of derived assets (built meshes, decoded textures), one file per entry
+// in 'directory'. Keys name the loader, its version and a hash of every source byte the
+// artifact depends on, so a changed source or loader never matches an old entry.
+//
+// Writes go to a temporary file that is renamed over the entry, so a crash or a
+// concurrent reader never sees a partial file. When the entries exceed the capacity the
+// least recently used ones are deleted; file mtimes carry the order across runs. All
+// methods are safe to call from worker threads.
+class AssetCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+        uint64_t bytes = 0;  // size of all entries
+    };
+
+    explicit AssetCache(std::string directory, uint64_t capacity = 256ull << 20);
+
+    static std::string makeKey(const char* kind, uint32_t version, uint64_t contentHash);
+
+    // Maps the entry read-only; empty on a miss
+    AssetData load(const std::string& key);
+
+    // Stores an entry made of a header and a payload (either may be empty). Returns
+    // false when the entry does not fit or cannot be written; the cache stays valid.
+    bool store(const std::string& key, const void* header, size_t headerSize, const void* payload,
+               size_t payloadSize);
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        uint64_t size;
+        uint64_t lastUse;  // ns since epoch
+    };
+
+    void evict(const std::string& keep);
+
+    std::string root;  // with trailing '/'
+    uint64_t capacity;
+    DirectoryAssetSource files;
+    std::unordered_map<std::string, Entry> entries;
+    Stats counters;
+    uint64_t tempCounter = 0;
+    mutable std::mutex mutex;
+};
@@ -0,0 +1,46 @@
+#include "AssetSource.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+DirectoryAssetSource::DirectoryAssetSource(std::string root) : root(std::move(root)) {
+    if (!this->root.empty() && this->root.back() != '/') {
+        this->root += '/';
+    }
+}
+
+AssetData DirectoryAssetSource::open(const std::string& path) {
+    AssetData asset;
+    int fd = ::open((root + path).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return asset;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return asset;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size == 0) {
+        // mmap rejects empty ranges; any non-null pointer will do
+        static const char empty = 0;
+        ::close(fd);
+        asset.data = &empty;
+        return asset;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file referenced
+    if (mapping == MAP_FAILED) {
+        return asset;
+    }
+
+    asset.data = mapping;
+    asset.size = size;
+    asset.owner = std::shared_ptr<const void>(mapping, [size](void* address) { munmap(address, size); });
+    return asset;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Read-only bytes of one asset. The bytes stay valid as long as any copy of the
+// AssetData exists (owner keeps the AAsset, mapping or buffer alive).
+struct AssetData {
+    const void* data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const void> owner;
+
+    const char* chars() const { return static_cast<const char*>(data); }
+    const uint8_t* bytes() const { return static_cast<const uint8_t*>(data); }
+    explicit operator bool() const { return data != nullptr; }
+};
+
+// Where loaders get their input from. open() returns an empty AssetData when the
+// asset does not exist; implementations must be safe to call from worker threads.
+class AssetSource {
+public:
+    virtual ~AssetSource() = default;
+    virtual AssetData open(const std::string& path) = 0;
+};
+
+// Files below a directory, mmapped read-only. Used by the host tools, and lets the
+// loaders run on Linux against app/src/main/assets.
+class DirectoryAssetSource : public AssetSource {
+public:
+    explicit DirectoryAssetSource(std::string root);
+    AssetData open(const std::string& path) override;
+
+private:
+    std::string root;
+};
@@ -0,0 +1,82 @@
+#include "BasisTranscoder.h"
+
+#include "Ktx2File.h"
+
+#include "transcoder/basisu_transcoder.h"
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+bool toTranscoderFormat(uint32_t vkFormat, basist::transcoder_texture_format& format) {
+    switch (vkFormat) {
+        case kKtx2FormatAstc4x4Srgb:
+            format = basist::transcoder_texture_format::cTFASTC_4x4_RGBA;
+            return true;
+        case kKtx2FormatBc7Srgb:
+            format = basist::transcoder_texture_format::cTFBC7_RGBA;
+            return true;
+        case kKtx2FormatEtc2Rgb8Srgb:
+            // ETC1 blocks are valid ETC2 RGB blocks
+            format = basist::transcoder_texture_format::cTFETC1_RGB;
+            return true;
+        case kKtx2FormatEtc2Rgba8Srgb:
+            format = basist::transcoder_texture_format::cTFETC2_RGBA;
+            return true;
+        case kKtx2FormatRgba8Srgb:
+            format = basist::transcoder_texture_format::cTFRGBA32;
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+bool basisTranscodesTo(uint32_t vkFormat) {
+    basist::transcoder_texture_format format;
+    return toTranscoderFormat(vkFormat, format);
+}
+
+std::vector<uint8_t> transcodeBasisKtx2(const AssetData& file, uint32_t opaqueFormat, uint32_t alphaFormat) {
+    // Builds the transcoder's global tables once; the instances below are per call
+    static std::once_flag initialized;
+    std::call_once(initialized, [] { basist::basisu_transcoder_init(); });
+
+    basist::ktx2_transcoder transcoder;
+    if (!transcoder.init(file.data, static_cast<uint32_t>(file.size))) {
+        throw std::runtime_error("basis: not a Basis Universal .ktx2");
+    }
+    if (transcoder.get_faces() != 1 || transcoder.get_layers() > 1) {
+        throw std::runtime_error("basis: not a single 2D image");
+    }
+    if (!transcoder.start_transcoding()) {
+        throw std::runtime_error("basis: corrupt global data");
+    }
+
+    const uint32_t vkFormat = transcoder.get_has_alpha() ? alphaFormat : opaqueFormat;
+    basist::transcoder_texture_format format;
+    if (!toTranscoderFormat(vkFormat, format)) {
+        throw std::runtime_error("basis: no transcode to format " + std::to_string(vkFormat));
+    }
+    const bool pixels = basist::basis_transcoder_format_is_uncompressed(format);
+    const uint32_t unitBytes = basist::basis_get_bytes_per_block_or_pixel(format);
+
+    std::vector<std::vector<uint8_t>> levels(transcoder.get_levels());
+    for (uint32_t level = 0; level < levels.size(); level++) {
+        basist::ktx2_image_level_info info;
+        if (!transcoder.get_image_level_info(info, level, 0, 0)) {
+            throw std::runtime_error("basis: level " + std::to_string(level) + " is missing");
+        }
+        // Block formats are sized in blocks, RGBA8 in pixels
+        const uint32_t units = pixels ? info.m_orig_width * info.m_orig_height : info.m_total_blocks;
+        levels[level].resize(size_t(units) * unitBytes);
+        if (!transcoder.transcode_image_level(level, 0, 0, levels[level].data(), units, format)) {
+            throw std::runtime_error("basis: level " + std::to_string(level) + " failed to transcode");
+        }
+    }
+    return serializeKtx2(vkFormat, transcoder.get_width(), transcoder.get_height(), levels, nullptr);
+}
+
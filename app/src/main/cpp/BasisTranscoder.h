@@ -0,0 +1,20 @@
+#pragma once
+
+#include "AssetSource.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Basis Universal .ktx2 files (ETC1S or UASTC payloads, vkFormat 0) are shipped once and
+// transcoded on the device by the Basis Universal transcoder (lib/basis_universal, or
+// fetched by CMake).
+
+// Whether Basis payloads can be transcoded to vkFormat: ASTC 4x4, BC7, ETC2 (ETC1
+// blocks for opaque textures) or RGBA8, all sRGB
+bool basisTranscodesTo(uint32_t vkFormat);
+
+// Transcodes every level of a Basis .ktx2 into opaqueFormat, or alphaFormat if the file
+// has alpha, and returns them as a plain .ktx2 (see serializeKtx2). Throws
+// std::runtime_error if the file is not a Basis .ktx2 or fails to transcode.
+std::vector<uint8_t> transcodeBasisKtx2(const AssetData& file, uint32_t opaqueFormat, uint32_t alphaFormat);
@@ -0,0 +1,266 @@
+#include "Ktx2File.h"
+
+#include "Zstd.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const uint8_t kIdentifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// Data format descriptor values (Khronos Data Format Specification 1.3)
+constexpr uint8_t kModelRgbsda = 1;
+constexpr uint8_t kModelBc7 = 134;
+constexpr uint8_t kModelEtc2 = 161;
+constexpr uint8_t kModelAstc = 162;
+constexpr uint8_t kPrimariesBt709 = 1;
+constexpr uint8_t kTransferLinear = 1;
+constexpr uint8_t kTransferSrgb = 2;
+constexpr uint8_t kChannelRed = 0;
+constexpr uint8_t kChannelGreen = 1;
+constexpr uint8_t kChannelBlue = 2;
+constexpr uint8_t kChannelAlpha = 15;
+constexpr uint8_t kChannelEtc2Color = 2;
+constexpr uint8_t kQualifierLinear = 0x10;  // alpha of an sRGB format
+
+struct FormatEntry {
+    uint32_t vkFormat;
+    Ktx2FormatInfo info;
+};
+
+const FormatEntry kFormats[] = {
+        {kKtx2FormatRgba8Unorm, {1, 1, 4, false}},
+        {kKtx2FormatRgba8Srgb, {1, 1, 4, true}},
+        {kKtx2FormatBc7Unorm, {4, 4, 16, false}},
+        {kKtx2FormatBc7Srgb, {4, 4, 16, true}},
+        {kKtx2FormatEtc2Rgb8Unorm, {4, 4, 8, false}},
+        {kKtx2FormatEtc2Rgb8Srgb, {4, 4, 8, true}},
+        {kKtx2FormatEtc2Rgba8Unorm, {4, 4, 16, false}},
+        {kKtx2FormatEtc2Rgba8Srgb, {4, 4, 16, true}},
+        {kKtx2FormatAstc4x4Unorm, {4, 4, 16, false}},
+        {kKtx2FormatAstc4x4Srgb, {4, 4, 16, true}},
+        {kKtx2FormatAstc6x6Unorm, {6, 6, 16, false}},
+        {kKtx2FormatAstc6x6Srgb, {6, 6, 16, true}},
+};
+
+template <typename T>
+void append(std::vector<uint8_t>& bytes, T value) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+    bytes.insert(bytes.end(), p, p + sizeof(T));
+}
+
+struct Sample {
+    uint16_t bitOffset;
+    uint8_t bitLength;  // minus one
+    uint8_t channel;    // channel id and qualifiers
+    uint32_t upper;
+};
+
+// Basic descriptor block for the format, with its total size in front
+std::vector<uint8_t> makeDataFormatDescriptor(uint32_t vkFormat, const Ktx2FormatInfo& info, bool supercompressed) {
+    uint8_t model;
+    std::vector<Sample> samples;
+    samples.reserve(4);
+    switch (vkFormat) {
+        case kKtx2FormatRgba8Unorm:
+        case kKtx2FormatRgba8Srgb:
+            model = kModelRgbsda;
+            samples = {{0, 7, kChannelRed, 255},
+                       {8, 7, kChannelGreen, 255},
+                       {16, 7, kChannelBlue, 255},
+                       {24, 7, uint8_t(kChannelAlpha | (info.srgb ? kQualifierLinear : 0)), 255}};
+            break;
+        case kKtx2FormatBc7Unorm:
+        case kKtx2FormatBc7Srgb:
+            model = kModelBc7;
+            samples = {{0, 127, 0, UINT32_MAX}};
+            break;
+        case kKtx2FormatEtc2Rgb8Unorm:
+        case kKtx2FormatEtc2Rgb8Srgb:
+            model = kModelEtc2;
+            samples = {{0, 63, kChannelEtc2Color, UINT32_MAX}};
+            break;
+        case kKtx2FormatEtc2Rgba8Unorm:
+        case kKtx2FormatEtc2Rgba8Srgb:
+            model = kModelEtc2;
+            samples = {{0, 63, kChannelAlpha, UINT32_MAX}, {64, 63, kChannelEtc2Color, UINT32_MAX}};
+            break;
+        default:
+            model = kModelAstc;
+            samples = {{0, 127, 0, UINT32_MAX}};
+            break;
+    }
+
+    const uint16_t blockSize = uint16_t(24 + 16 * samples.size());
+    std::vector<uint8_t> bytes;
+    append<uint32_t>(bytes, 4u + blockSize);
+    append<uint32_t>(bytes, 0);  // Khronos vendor, basic descriptor type
+    append<uint16_t>(bytes, 2);  // version 1.3
+    append<uint16_t>(bytes, blockSize);
+    bytes.push_back(model);
+    bytes.push_back(kPrimariesBt709);
+    bytes.push_back(info.srgb ? kTransferSrgb : kTransferLinear);
+    bytes.push_back(0);  // straight alpha
+    bytes.push_back(uint8_t(info.blockWidth - 1));
+    bytes.push_back(uint8_t(info.blockHeight - 1));
+    bytes.push_back(0);
+    bytes.push_back(0);
+    // bytesPlane0 is unknown once the levels are supercompressed
+    bytes.push_back(supercompressed ? 0 : uint8_t(info.blockBytes));
+    bytes.insert(bytes.end(), 7, 0);
+    for (const Sample& sample : samples) {
+        append<uint16_t>(bytes, sample.bitOffset);
+        bytes.push_back(sample.bitLength);
+        bytes.push_back(sample.channel);
+        append<uint32_t>(bytes, 0);  // sample position
+        append<uint32_t>(bytes, 0);  // lower
+        append<uint32_t>(bytes, sample.upper);
+    }
+    return bytes;
+}
+
+bool rangeInBounds(uint64_t offset, uint64_t bytes, uint64_t fileSize) {
+    return offset <= fileSize && bytes <= fileSize - offset;
+}
+
+} // namespace
+
+const Ktx2FormatInfo* ktx2FormatInfo(uint32_t vkFormat) {
+    for (const FormatEntry& entry : kFormats) {
+        if (entry.vkFormat == vkFormat) {
+            return &entry.info;
+        }
+    }
+    return nullptr;
+}
+
+size_t ktx2LevelSize(uint32_t vkFormat, uint32_t width, uint32_t height) {
+    const Ktx2FormatInfo* info = ktx2FormatInfo(vkFormat);
+    if (!info) {
+        return 0;
+    }
+    const size_t blocksX = (width + info->blockWidth - 1) / info->blockWidth;
+    const size_t blocksY = (height + info->blockHeight - 1) / info->blockHeight;
+    return blocksX * blocksY * info->blockBytes;
+}
+
+std::vector<uint8_t> serializeKtx2(uint32_t vkFormat, uint32_t width, uint32_t height,
+                                   const std::vector<std::vector<uint8_t>>& levels, ZstdCompressor compress) {
+    const Ktx2FormatInfo* info = ktx2FormatInfo(vkFormat);
+    if (!info || levels.empty() || width == 0 || height == 0) {
+        throw std::runtime_error("ktx2: nothing to write");
+    }
+    const bool zstd = compress != nullptr;
+
+    Ktx2Header header{};
+    std::memcpy(header.identifier, kIdentifier, sizeof(kIdentifier));
+    header.vkFormat = vkFormat;
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.faceCount = 1;
+    header.levelCount = uint32_t(levels.size());
+    header.supercompressionScheme = zstd ? kKtx2SupercompressionZstd : kKtx2SupercompressionNone;
+
+    std::vector<uint8_t> descriptor = makeDataFormatDescriptor(vkFormat, *info, zstd);
+    header.dfdByteOffset = uint32_t(sizeof(Ktx2Header) + levels.size() * sizeof(Ktx2LevelIndex));
+    header.dfdByteLength = uint32_t(descriptor.size());
+
+    std::vector<std::vector<uint8_t>> stored(levels.size());
+    for (size_t i = 0; i < levels.size(); i++) {
+        const uint32_t levelWidth = std::max(1u, width >> i);
+        const uint32_t levelHeight = std::max(1u, height >> i);
+        if (levels[i].size() != ktx2LevelSize(vkFormat, levelWidth, levelHeight)) {
+            throw std::runtime_error("ktx2: level " + std::to_string(i) + " has the wrong size");
+        }
+        stored[i] = zstd ? compress(levels[i].data(), levels[i].size()) : levels[i];
+    }
+
+    // Smallest level first; stored levels start on a block boundary
+    const uint64_t alignment = zstd ? 1 : info->blockBytes;
+    std::vector<Ktx2LevelIndex> index(levels.size());
+    uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+    for (size_t i = levels.size(); i-- > 0;) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        index[i] = {offset, stored[i].size(), levels[i].size()};
+        offset += stored[i].size();
+    }
+
+    std::vector<uint8_t> bytes(offset, 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), index.data(), index.size() * sizeof(Ktx2LevelIndex));
+    std::memcpy(bytes.data() + header.dfdByteOffset, descriptor.data(), descriptor.size());
+    for (size_t i = 0; i < levels.size(); i++) {
+        std::memcpy(bytes.data() + index[i].byteOffset, stored[i].data(), stored[i].size());
+    }
+    return bytes;
+}
+
+Ktx2Texture readKtx2File(const AssetData& file) {
+    if (file.size < sizeof(Ktx2Header)) {
+        throw std::runtime_error("ktx2: file too small");
+    }
+    Ktx2Header header;
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.identifier, kIdentifier, sizeof(kIdentifier)) != 0) {
+        throw std::runtime_error("ktx2: bad identifier");
+    }
+    if (header.vkFormat == 0) {
+        // ETC1S and UASTC files leave the format to a Basis Universal transcoder
+        throw std::runtime_error("ktx2: Basis Universal payloads are not supported");
+    }
+    if (!ktx2FormatInfo(header.vkFormat)) {
+        throw std::runtime_error("ktx2: unsupported vkFormat " + std::to_string(header.vkFormat));
+    }
+    if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth != 0 || header.layerCount > 1 ||
+        header.faceCount != 1) {
+        throw std::runtime_error("ktx2: not a single 2D image");
+    }
+    if (header.supercompressionScheme != kKtx2SupercompressionNone &&
+        header.supercompressionScheme != kKtx2SupercompressionZstd) {
+        throw std::runtime_error("ktx2: unsupported supercompression scheme " +
+                                 std::to_string(header.supercompressionScheme));
+    }
+
+    // 0 asks the loader to generate the chain; only the stored level is used then
+    const uint32_t levelCount = std::max(header.levelCount, 1u);
+    const uint32_t fullChain = 32 - uint32_t(__builtin_clz(std::max(header.pixelWidth, header.pixelHeight)));
+    if (levelCount > fullChain ||
+        !rangeInBounds(sizeof(Ktx2Header), uint64_t(levelCount) * sizeof(Ktx2LevelIndex), file.size)) {
+        throw std::runtime_error("ktx2: level index out of bounds");
+    }
+
+    Ktx2Texture texture;
+    texture.vkFormat = header.vkFormat;
+    texture.width = header.pixelWidth;
+    texture.height = header.pixelHeight;
+    texture.supercompressionScheme = header.supercompressionScheme;
+    for (uint32_t i = 0; i < levelCount; i++) {
+        Ktx2LevelIndex level;
+        std::memcpy(&level, file.bytes() + sizeof(Ktx2Header) + i * sizeof(Ktx2LevelIndex), sizeof(level));
+        const size_t expected = ktx2LevelSize(header.vkFormat, std::max(1u, header.pixelWidth >> i),
+                                              std::max(1u, header.pixelHeight >> i));
+        if (!rangeInBounds(level.byteOffset, level.byteLength, file.size) || level.uncompressedByteLength != expected) {
+            throw std::runtime_error("ktx2: level " + std::to_string(i) + " out of bounds");
+        }
+
+        const uint8_t* stored = file.bytes() + level.byteOffset;
+        if (header.supercompressionScheme == kKtx2SupercompressionNone) {
+            if (level.byteLength != expected) {
+                throw std::runtime_error("ktx2: level " + std::to_string(i) + " has the wrong size");
+            }
+            texture.levels.push_back(AssetData{stored, expected, file.owner});
+            continue;
+        }
+
+        auto buffer = std::make_shared<std::vector<uint8_t>>(expected);
+        if (zstdDecompress(stored, level.byteLength, buffer->data(), buffer->size()) != expected) {
+            throw std::runtime_error("ktx2: level " + std::to_string(i) + " decompressed to the wrong size");
+        }
+        texture.levels.push_back(AssetData{buffer->data(), expected, buffer});
+    }
+    return texture;
+}
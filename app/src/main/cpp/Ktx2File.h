@@ -0,0 +1,97 @@
+#pragma once
+
+#include "AssetSource.h"
+#include "Zstd.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// .ktx2 (Khronos KTX 2.0) textures holding pre-encoded mip levels that are copied to
+// the image as they are.
+//
+// Layout (little endian):
+//   Ktx2Header
+//   Ktx2LevelIndex[levelCount]     level 0 (full size) first
+//   data format descriptor         written for other tools, not read back
+//   mip level data                 smallest level first
+//
+// Only what the renderer samples directly is accepted: one 2D image (no layers, faces
+// or depth) in one of the formats below. Levels are either stored as they are or
+// zstd supercompressed one by one (scheme 2).
+
+// VkFormat values, so the tools build without the Vulkan headers
+constexpr uint32_t kKtx2FormatRgba8Unorm = 37;      // VK_FORMAT_R8G8B8A8_UNORM
+constexpr uint32_t kKtx2FormatRgba8Srgb = 43;       // VK_FORMAT_R8G8B8A8_SRGB
+constexpr uint32_t kKtx2FormatBc7Unorm = 145;       // VK_FORMAT_BC7_UNORM_BLOCK
+constexpr uint32_t kKtx2FormatBc7Srgb = 146;        // VK_FORMAT_BC7_SRGB_BLOCK
+constexpr uint32_t kKtx2FormatEtc2Rgb8Unorm = 147;  // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+constexpr uint32_t kKtx2FormatEtc2Rgb8Srgb = 148;   // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+constexpr uint32_t kKtx2FormatEtc2Rgba8Unorm = 151; // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+constexpr uint32_t kKtx2FormatEtc2Rgba8Srgb = 152;  // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+constexpr uint32_t kKtx2FormatAstc4x4Unorm = 157;   // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+constexpr uint32_t kKtx2FormatAstc4x4Srgb = 158;    // VK_FORMAT_ASTC_4x4_SRGB_BLOCK
+constexpr uint32_t kKtx2FormatAstc6x6Unorm = 165;   // VK_FORMAT_ASTC_6x6_UNORM_BLOCK
+constexpr uint32_t kKtx2FormatAstc6x6Srgb = 166;    // VK_FORMAT_ASTC_6x6_SRGB_BLOCK
+
+// Ktx2Header::supercompressionScheme
+constexpr uint32_t kKtx2SupercompressionNone = 0;
+constexpr uint32_t kKtx2SupercompressionZstd = 2;
+
+struct Ktx2Header {
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+static_assert(sizeof(Ktx2Header) == 80, "Ktx2Header layout changed");
+
+struct Ktx2LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+struct Ktx2FormatInfo {
+    uint32_t blockWidth;
+    uint32_t blockHeight;
+    uint32_t blockBytes;
+    bool srgb;
+};
+
+// nullptr for formats this loader does not handle
+const Ktx2FormatInfo* ktx2FormatInfo(uint32_t vkFormat);
+
+// Bytes of one mip level of a supported format
+size_t ktx2LevelSize(uint32_t vkFormat, uint32_t width, uint32_t height);
+
+struct Ktx2Texture {
+    uint32_t vkFormat = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t supercompressionScheme = kKtx2SupercompressionNone;
+    // Level 0 (full size) first. Stored levels point into the file, supercompressed
+    // ones into their own decompressed buffer.
+    std::vector<AssetData> levels;
+};
+
+// Serializes levels (level 0 first, each ktx2LevelSize bytes) into .ktx2 bytes,
+// compressing every level with zstd (supercompression scheme 2) when given a compressor
+std::vector<uint8_t> serializeKtx2(uint32_t vkFormat, uint32_t width, uint32_t height,
+                                   const std::vector<std::vector<uint8_t>>& levels, ZstdCompressor compress);
+
+// Checks the header and level bounds and undoes the supercompression. Throws
+// std::runtime_error if the file is truncated, corrupt or not a supported texture.
+Ktx2Texture readKtx2File(const AssetData& file);
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Renderer vertex layout. Kept free of Vulkan types so the offline tools can use it.
+// The texture is per draw range (DrawRange::texture), so vertices shared by two
+// materials are stored once.
+struct Vertex {
+    glm::vec3 pos;
+    glm::vec3 color;
+    glm::vec2 texCoord;
+
+    bool operator==(const Vertex& other) const {
+        return pos == other.pos && color == other.color && texCoord == other.texCoord;
+    }
+};
+
+// Compact vertex layout for the packed pipeline (VertexQuantizer.h): 12 bytes instead
+// of 32. Position is snorm16 and texCoord unorm16, both relative to the mesh bounds;
+// the constant white color is dropped.
+struct PackedVertex {
+    int16_t pos[4];  // w is padding: RGBA16 is a mandatory vertex format, RGB16 is not
+    uint16_t texCoord[2];
+};
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must stay 12 bytes");
+
+enum class VertexFormat {
+    Float,   // Vertex
+    Packed   // PackedVertex, dequantized in the vertex shader
+};
+
+// 64-bit hash consistent with Vertex::operator== (-0.0 and 0.0 hash the same).
+// Every word is multiplied and rotated in, then finalized with the murmur3 mixer, so
+// vertices that only differ in one UV bit still land far apart.
+inline uint64_t hashVertex(const Vertex& vertex) {
+    auto bits = [](float value) -> uint64_t {
+        uint32_t word;
+        value = value == 0.0f ? 0.0f : value;
+        std::memcpy(&word, &value, sizeof(word));
+        return word;
+    };
+    const uint64_t words[4] = {
+        bits(vertex.pos.x) | bits(vertex.pos.y) << 32,
+        bits(vertex.pos.z) | bits(vertex.color.x) << 32,
+        bits(vertex.color.y) | bits(vertex.color.z) << 32,
+        bits(vertex.texCoord.x) | bits(vertex.texCoord.y) << 32
+    };
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (uint64_t word : words) {
+        h ^= word * 0x87C37B91114253D5ull;
+        h = (h << 31 | h >> 33) * 0x4CF5AD432745937Full;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+namespace std {
+    template<> struct hash<Vertex> {
+        size_t operator()(Vertex const& vertex) const {
+            return static_cast<size_t>(hashVertex(vertex));
+        }
+    };
+}
+
+// One vkCmdDrawIndexed: indexCount indices from firstIndex, each added to vertexOffset.
+// vertexCount is the number of vertices the range's indices can reach. Every range
+// uses a single material; texture is its slot in the texture table, pushed as a push
+// constant so the fragment shader indexes the sampler array uniformly.
+struct DrawRange {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t vertexOffset;
+    uint32_t vertexCount;
+    uint32_t texture;
+};
+
+// One level of detail: ranges [firstRange, firstRange + rangeCount) draw it. error is
+// the simplifier's deviation from level 0 in mesh units (0 for level 0).
+struct MeshLod {
+    uint32_t firstRange;
+    uint32_t rangeCount;
+    uint32_t indexCount;
+    float error;
+};
+
+// Meshlet limits: 64 vertices / 124 triangles fit the output limits of every mesh
+// shader implementation, and 124 * 3 one-byte indices plus a count fit in 384 bytes
+constexpr uint32_t kMeshletMaxVertices = 64;
+constexpr uint32_t kMeshletMaxTriangles = 124;
+
+// A run of consecutive triangles of one draw range, so the indexed path can draw it
+// straight from the index buffer (MeshletBuilder.h). Layout matches the std430 struct
+// in meshlet.task and meshlet.mesh.
+struct Meshlet {
+    glm::vec4 sphere;         // xyz center, w radius
+    glm::vec4 cone;           // xyz average front face normal, w cutoff (1 disables the test)
+    uint32_t firstIndex;      // into the index buffer; the run is 3 * triangleCount long
+    uint32_t triangleCount;
+    int32_t baseVertex;       // vertexOffset of the draw range
+    uint32_t firstVertex;     // into meshletVertices
+    uint32_t vertexCount;
+    uint32_t firstTriangle;   // into meshletTriangles
+    uint32_t range;           // draw range the meshlet was cut from
+    uint32_t texture;         // texture of that range
+};
+static_assert(sizeof(Meshlet) == 64, "Meshlet must match the shader struct");
+
+// Renderer-ready mesh: welded vertices, triangle list indices sorted by material with
+// one range per material, and the texture table the ranges point into. After
+// splitForShortIndices the indices live in shortIndices, relative to the vertexOffset
+// of their range. With a LOD chain (buildLodChain) every level is a set of ranges over
+// the same vertex and index data.
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint16_t> shortIndices;
+    std::vector<DrawRange> ranges;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> meshletVertices;   // index values (relative to baseVertex) per meshlet
+    std::vector<uint32_t> meshletTriangles;  // three meshlet-local vertex numbers, one byte each
+    std::vector<std::string> textures;
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+};
+
+// Non-owning view of a mesh, either over a MeshData or over a mapped .vmesh file.
+// Vertex and index data are raw bytes so they can be copied straight into a staging
+// buffer without any alignment requirement on the source.
+// Every view has at least one range and one LOD when it has indices.
+struct MeshView {
+    const void* vertexData = nullptr;
+    size_t vertexCount = 0;
+    const void* indexData = nullptr;
+    size_t indexCount = 0;
+    uint32_t indexSize = sizeof(uint32_t);  // 2 or 4 bytes
+    std::vector<DrawRange> ranges;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    const uint32_t* meshletVertices = nullptr;
+    size_t meshletVertexCount = 0;
+    const uint32_t* meshletTriangles = nullptr;
+    size_t meshletTriangleCount = 0;
+    std::vector<std::string> textures;
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+
+    size_t vertexBytes() const { return vertexCount * sizeof(Vertex); }
+    size_t indexBytes() const { return indexCount * indexSize; }
+};
+
+// A single range drawing the whole mesh, for 32-bit meshes that were never split
+inline DrawRange wholeMeshRange(size_t indexCount, size_t vertexCount) {
+    return DrawRange{0, static_cast<uint32_t>(indexCount), 0, static_cast<uint32_t>(vertexCount), 0};
+}
+
+// A single level drawing every range, for meshes without a LOD chain
+inline MeshLod wholeMeshLod(const std::vector<DrawRange>& ranges) {
+    uint32_t indexCount = 0;
+    for (const DrawRange& range : ranges) {
+        indexCount += range.indexCount;
+    }
+    return MeshLod{0, static_cast<uint32_t>(ranges.size()), indexCount, 0.0f};
+}
+
+inline MeshView makeMeshView(const MeshData& mesh) {
+    MeshView view;
+    view.vertexData = mesh.vertices.data();
+    view.vertexCount = mesh.vertices.size();
+    if (!mesh.shortIndices.empty()) {
+        view.indexData = mesh.shortIndices.data();
+        view.indexCount = mesh.shortIndices.size();
+        view.indexSize = sizeof(uint16_t);
+    } else {
+        view.indexData = mesh.indices.data();
+        view.indexCount = mesh.indices.size();
+    }
+    view.ranges = mesh.ranges;
+    if (view.ranges.empty() && view.indexCount > 0) {
+        view.ranges.push_back(wholeMeshRange(view.indexCount, view.vertexCount));
+    }
+    view.lods = mesh.lods;
+    if (view.lods.empty() && !view.ranges.empty()) {
+        view.lods.push_back(wholeMeshLod(view.ranges));
+    }
+    view.meshlets = mesh.meshlets;
+    view.meshletVertices = mesh.meshletVertices.data();
+    view.meshletVertexCount = mesh.meshletVertices.size();
+    view.meshletTriangles = mesh.meshletTriangles.data();
+    view.meshletTriangleCount = mesh.meshletTriangles.size();
+    view.textures = mesh.textures;
+    view.boundsMin = mesh.boundsMin;
+    view.boundsMax = mesh.boundsMax;
+    return view;
+}
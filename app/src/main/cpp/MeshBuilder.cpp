@@ -0,0 +1,308 @@
+#include "MeshBuilder.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+
+std::string inferTextureFile(const std::string& materialName) {
+    return materialName.substr(0, materialName.find('.')) + "_baseColor.png";
+}
+
+void buildMesh(const ObjData& obj, const std::vector<MtlMaterial>& materials, MeshData& out,
+               ThreadPool* pool, WeldMode weldMode) {
+    out = MeshData{};
+
+    // Texture table: unique files of all MTL materials, sorted for a stable order
+    std::unordered_map<std::string, std::string> materialTexture;
+    std::set<std::string> textureFiles;
+    for (const auto& material : materials) {
+        std::string file = material.diffuseTexture.empty() ? inferTextureFile(material.name) : material.diffuseTexture;
+        materialTexture[material.name] = file;
+        textureFiles.insert(file);
+    }
+    out.textures.assign(textureFiles.begin(), textureFiles.end());
+
+    // usemtl id -> texture slot
+    std::vector<int> materialSlot(obj.materialNames.size(), 0);
+    for (size_t i = 0; i < obj.materialNames.size(); i++) {
+        auto it = materialTexture.find(obj.materialNames[i]);
+        if (it != materialTexture.end()) {
+            materialSlot[i] = int(std::lower_bound(out.textures.begin(), out.textures.end(), it->second) - out.textures.begin());
+        }
+    }
+
+    // Expand every corner to a full vertex, then weld identical ones
+    std::vector<Vertex> corners(obj.indices.size());
+    auto expandCorners = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const ObjIndex& corner = obj.indices[i];
+
+            Vertex vertex{};
+
+            vertex.pos = {
+                obj.positions[3 * corner.position + 0],
+                -obj.positions[3 * corner.position + 1],
+                obj.positions[3 * corner.position + 2]
+            };
+
+            if (corner.texCoord >= 0) {
+                vertex.texCoord = {
+                    obj.texCoords[2 * corner.texCoord + 0],
+                    1.0f - obj.texCoords[2 * corner.texCoord + 1]
+                };
+            }
+
+            vertex.color = {1.0f, 1.0f, 1.0f};
+            corners[i] = vertex;
+        }
+    };
+
+    if (pool && pool->size() > 1 && corners.size() > 64 * 1024) {
+        size_t blockCount = pool->size() * 4;
+        size_t blockSize = (corners.size() + blockCount - 1) / blockCount;
+        pool->parallelFor(blockCount, [&](size_t block) {
+            expandCorners(std::min(corners.size(), block * blockSize), std::min(corners.size(), (block + 1) * blockSize));
+        });
+    } else {
+        expandCorners(0, corners.size());
+    }
+
+    std::vector<uint32_t> cornerIndices;
+    weldVertices(corners.data(), corners.size(), out.vertices, cornerIndices, weldMode, pool);
+
+    // Group the triangles by texture slot (stable, so file order is kept inside a
+    // material) and give each slot its own draw range. Faces before the first usemtl
+    // use slot 0.
+    size_t triangleCount = cornerIndices.size() / 3;
+    std::vector<uint32_t> triangleSlot(triangleCount);
+    std::vector<uint32_t> slotStart(std::max<size_t>(out.textures.size(), 1) + 1, 0);
+    for (size_t t = 0; t < triangleCount; t++) {
+        int32_t material = obj.triangleMaterials[t];
+        triangleSlot[t] = material >= 0 ? uint32_t(materialSlot[material]) : 0;
+        slotStart[triangleSlot[t] + 1]++;
+    }
+    for (size_t slot = 0; slot + 1 < slotStart.size(); slot++) {
+        slotStart[slot + 1] += slotStart[slot];
+    }
+    out.indices.resize(cornerIndices.size());
+    std::vector<uint32_t> fill(slotStart.begin(), slotStart.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        size_t destination = 3 * size_t(fill[triangleSlot[t]]++);
+        for (int k = 0; k < 3; k++) {
+            out.indices[destination + k] = cornerIndices[3 * t + k];
+        }
+    }
+    for (size_t slot = 0; slot + 1 < slotStart.size(); slot++) {
+        if (slotStart[slot + 1] > slotStart[slot]) {
+            out.ranges.push_back(DrawRange{3 * slotStart[slot], 3 * (slotStart[slot + 1] - slotStart[slot]), 0,
+                                           uint32_t(out.vertices.size()), uint32_t(slot)});
+        }
+    }
+
+    if (!out.vertices.empty()) {
+        out.boundsMin = glm::vec3(FLT_MAX);
+        out.boundsMax = glm::vec3(-FLT_MAX);
+        for (const auto& vertex : out.vertices) {
+            out.boundsMin = glm::min(out.boundsMin, vertex.pos);
+            out.boundsMax = glm::max(out.boundsMax, vertex.pos);
+        }
+    }
+}
+
+void splitForShortIndices(MeshData& mesh, size_t maxRangeVertices) {
+    if (maxRangeVertices < 3 || maxRangeVertices > 65536) {
+        throw std::runtime_error("splitForShortIndices: range size must be between 3 and 65536");
+    }
+    std::vector<DrawRange> sourceRanges;
+    sourceRanges.swap(mesh.ranges);
+    mesh.shortIndices.clear();
+    if (mesh.indices.empty()) {
+        mesh.lods.clear();
+        return;
+    }
+    if (sourceRanges.empty()) {
+        sourceRanges.push_back(wholeMeshRange(mesh.indices.size(), mesh.vertices.size()));
+    }
+
+    mesh.shortIndices.reserve(mesh.indices.size());
+
+    // Everything fits: the vertex buffer and the ranges stay as they are
+    if (mesh.vertices.size() <= maxRangeVertices) {
+        mesh.shortIndices.assign(mesh.indices.begin(), mesh.indices.end());
+        mesh.ranges.swap(sourceRanges);
+        mesh.indices.clear();
+        mesh.indices.shrink_to_fit();
+        return;
+    }
+
+    // Vertex blocks of at most maxRangeVertices, concatenated into the new vertex buffer
+    // at the end. blockOf/localIndex hold the last block that took a vertex. Coarser LOD
+    // levels look vertices up in older blocks too, so with a LOD chain the slots a
+    // vertex had before are moved to olderSlots.
+    size_t finestRanges = mesh.lods.empty() ? sourceRanges.size()
+                                            : size_t(mesh.lods[0].firstRange) + mesh.lods[0].rangeCount;
+    bool keepOlderSlots = finestRanges < sourceRanges.size();
+    constexpr uint32_t kNoBlock = UINT32_MAX;
+    std::vector<uint32_t> blockOf(mesh.vertices.size(), kNoBlock);
+    std::vector<uint16_t> localIndex(mesh.vertices.size());
+    std::unordered_map<uint64_t, uint16_t> olderSlots;
+    std::vector<std::vector<uint32_t>> blocks;
+    auto slotOf = [&](uint32_t vertex, uint32_t block) -> int32_t {
+        if (blockOf[vertex] == block) {
+            return localIndex[vertex];
+        }
+        if (blockOf[vertex] == kNoBlock || olderSlots.empty()) {
+            return -1;
+        }
+        auto it = olderSlots.find((uint64_t(vertex) << 32) | block);
+        return it == olderSlots.end() ? -1 : it->second;
+    };
+    auto slotIn = [&](uint32_t vertex, uint32_t block) -> uint16_t {
+        int32_t slot = slotOf(vertex, block);
+        if (slot >= 0) {
+            return uint16_t(slot);
+        }
+        if (blockOf[vertex] != kNoBlock && keepOlderSlots) {
+            olderSlots.emplace((uint64_t(vertex) << 32) | blockOf[vertex], localIndex[vertex]);
+        }
+        blockOf[vertex] = block;
+        localIndex[vertex] = uint16_t(blocks[block].size());
+        blocks[block].push_back(vertex);
+        return localIndex[vertex];
+    };
+    // The block being filled is the last to take its vertices, so blockOf alone answers
+    // for it; other blocks need the slot lookup
+    auto missingIn = [&](const uint32_t* triangle, uint32_t block, bool filling) {
+        uint32_t missing = 0;
+        for (int k = 0; k < 3; k++) {
+            bool repeated = (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+            bool present = filling ? blockOf[triangle[k]] == block : slotOf(triangle[k], block) >= 0;
+            if (!repeated && !present) {
+                missing++;
+            }
+        }
+        return missing;
+    };
+
+    // Ranges of the finest level are split greedily in triangle order into fresh blocks.
+    // Coarser levels reuse the vertices of the level above, so their triangles go into
+    // whichever block already holds their corners; only triangles straddling a block
+    // boundary copy vertices, instead of every level re-storing the whole mesh.
+    std::vector<uint32_t> rangeBlock;
+    // firstSplit[i] is the first output range of source range i
+    std::vector<uint32_t> firstSplit;
+    std::vector<std::pair<uint32_t, size_t>> placed;
+    for (size_t r = 0; r < sourceRanges.size(); r++) {
+        const DrawRange& source = sourceRanges[r];
+        firstSplit.push_back(uint32_t(mesh.ranges.size()));
+        size_t end = size_t(source.firstIndex) + source.indexCount;
+
+        if (r < finestRanges) {
+            DrawRange range{uint32_t(mesh.shortIndices.size()), 0, 0, 0, source.texture};
+            uint32_t block = uint32_t(blocks.size());
+            blocks.emplace_back();
+            for (size_t t = source.firstIndex; t < end; t += 3) {
+                const uint32_t* triangle = &mesh.indices[t];
+                if (blocks[block].size() + missingIn(triangle, block, true) > maxRangeVertices) {
+                    mesh.ranges.push_back(range);
+                    rangeBlock.push_back(block);
+                    range = DrawRange{uint32_t(mesh.shortIndices.size()), 0, 0, 0, source.texture};
+                    block = uint32_t(blocks.size());
+                    blocks.emplace_back();
+                }
+                for (int k = 0; k < 3; k++) {
+                    mesh.shortIndices.push_back(slotIn(triangle[k], block));
+                }
+                range.indexCount += 3;
+            }
+            mesh.ranges.push_back(range);
+            rangeBlock.push_back(block);
+            continue;
+        }
+
+        // Try the previous triangle's block, the first block of each corner and the block
+        // collecting this range's straddling triangles, and take the one needing the
+        // fewest new vertices. Triangles are then grouped by block (in order of first
+        // use, keeping their order within a block) so a level draws once per block.
+        std::vector<uint32_t> useOrder;
+        placed.clear();
+        uint32_t last = kNoBlock;
+        uint32_t straddling = kNoBlock;
+        for (size_t t = source.firstIndex; t < end; t += 3) {
+            const uint32_t* triangle = &mesh.indices[t];
+            uint32_t candidates[5] = {last, blockOf[triangle[0]], blockOf[triangle[1]], blockOf[triangle[2]],
+                                      straddling};
+            uint32_t best = kNoBlock;
+            uint32_t bestMissing = 4;
+            for (uint32_t candidate : candidates) {
+                if (candidate == kNoBlock || candidate == best) {
+                    continue;
+                }
+                uint32_t missing = missingIn(triangle, candidate, false);
+                if (missing < bestMissing && blocks[candidate].size() + missing <= maxRangeVertices) {
+                    best = candidate;
+                    bestMissing = missing;
+                }
+                if (bestMissing == 0) {
+                    break;
+                }
+            }
+            if (best == kNoBlock) {
+                best = uint32_t(blocks.size());
+                straddling = best;
+                blocks.emplace_back();
+            }
+            for (int k = 0; k < 3; k++) {
+                slotIn(triangle[k], best);
+            }
+            auto used = std::find(useOrder.begin(), useOrder.end(), best);
+            if (used == useOrder.end()) {
+                useOrder.push_back(best);
+                used = useOrder.end() - 1;
+            }
+            placed.emplace_back(uint32_t(used - useOrder.begin()), t);
+            last = best;
+        }
+        std::stable_sort(placed.begin(), placed.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (size_t p = 0; p < placed.size(); p++) {
+            if (p == 0 || placed[p].first != placed[p - 1].first) {
+                mesh.ranges.push_back(DrawRange{uint32_t(mesh.shortIndices.size()), 0, 0, 0, source.texture});
+                rangeBlock.push_back(useOrder[placed[p].first]);
+            }
+            uint32_t block = useOrder[placed[p].first];
+            for (int k = 0; k < 3; k++) {
+                mesh.shortIndices.push_back(uint16_t(slotOf(mesh.indices[placed[p].second + k], block)));
+            }
+            mesh.ranges.back().indexCount += 3;
+        }
+    }
+    firstSplit.push_back(uint32_t(mesh.ranges.size()));
+
+    for (MeshLod& lod : mesh.lods) {
+        uint32_t first = firstSplit[lod.firstRange];
+        lod.rangeCount = firstSplit[lod.firstRange + lod.rangeCount] - first;
+        lod.firstRange = first;
+    }
+
+    std::vector<int32_t> blockOffset(blocks.size());
+    std::vector<Vertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (size_t b = 0; b < blocks.size(); b++) {
+        blockOffset[b] = int32_t(vertices.size());
+        for (uint32_t vertex : blocks[b]) {
+            vertices.push_back(mesh.vertices[vertex]);
+        }
+    }
+    for (size_t r = 0; r < mesh.ranges.size(); r++) {
+        mesh.ranges[r].vertexOffset = blockOffset[rangeBlock[r]];
+        mesh.ranges[r].vertexCount = uint32_t(blocks[rangeBlock[r]].size());
+    }
+
+    mesh.vertices.swap(vertices);
+    mesh.indices.clear();
+    mesh.indices.shrink_to_fit();
+}
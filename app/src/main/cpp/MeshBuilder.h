@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Mesh.h"
+#include "ObjParser.h"
+#include "VertexWelder.h"
+
+#include <string>
+#include <vector>
+
+// Texture used for a material without map_Kd: "lambert5SG.001" -> "lambert5SG_baseColor.png"
+std::string inferTextureFile(const std::string& materialName);
+
+// Builds the renderer mesh from parsed OBJ/MTL data. Positions get Y flipped and UVs
+// get V flipped for Vulkan, identical corners are welded, and every triangle's material
+// is resolved to a slot in the sorted texture table (materials missing from the MTL
+// use slot 0). Triangles are grouped by slot into one draw range per material. This
+// is the shared path of loadModel and the vmesh converter.
+void buildMesh(const ObjData& obj, const std::vector<MtlMaterial>& materials, MeshData& out,
+               ThreadPool* pool = nullptr, WeldMode weldMode = WeldMode::Auto);
+
+// Converts mesh.indices into 16-bit indices in mesh.shortIndices. Meshes with more than
+// maxRangeVertices vertices are split into ranges that each reach one contiguous block
+// of at most that many vertices; vertices shared across a split are duplicated. The
+// finest level's ranges (materials) are split into consecutive triangles. Coarser LOD
+// levels draw from the same blocks, grouped by block and copying only the vertices of
+// triangles that straddle two, so the chain does not store the mesh once per level.
+// Ranges keep their texture and mesh.lods is updated to the new ranges. Triangle order
+// is kept within each range, so this runs after optimizeMesh and buildLodChain.
+void splitForShortIndices(MeshData& mesh, size_t maxRangeVertices = 65535);
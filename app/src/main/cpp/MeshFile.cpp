@@ -0,0 +1,217 @@
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint64_t kSectionAlignment = 16;
+
+uint64_t alignSection(uint64_t offset) {
+    return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+bool sectionInBounds(uint64_t offset, uint64_t bytes, uint64_t fileSize) {
+    return offset <= fileSize && bytes <= fileSize - offset;
+}
+
+} // namespace
+
+std::vector<uint8_t> serializeMesh(const MeshData& mesh) {
+    MeshFileHeader header{};
+    header.magic = kMeshFileMagic;
+    header.version = kMeshFileVersion;
+    header.vertexStride = sizeof(Vertex);
+    header.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+
+    // Same choice as makeMeshView: short indices win when present
+    MeshView view = makeMeshView(mesh);
+    if (view.indexSize == sizeof(uint16_t)) {
+        header.flags |= kMeshFileShortIndices;
+    }
+    header.indexCount = static_cast<uint32_t>(view.indexCount);
+    header.rangeCount = static_cast<uint32_t>(view.ranges.size());
+    header.lodCount = static_cast<uint32_t>(view.lods.size());
+    header.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+    header.meshletVertexCount = static_cast<uint32_t>(mesh.meshletVertices.size());
+    header.meshletTriangleCount = static_cast<uint32_t>(mesh.meshletTriangles.size());
+    header.textureCount = static_cast<uint32_t>(mesh.textures.size());
+    for (int i = 0; i < 3; i++) {
+        header.boundsMin[i] = mesh.boundsMin[i];
+        header.boundsMax[i] = mesh.boundsMax[i];
+    }
+
+    std::vector<MeshFileString> table;
+    std::string strings;
+    for (const auto& texture : mesh.textures) {
+        table.push_back({static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(texture.size())});
+        strings += texture;
+    }
+
+    header.vertexOffset = alignSection(sizeof(MeshFileHeader));
+    header.indexOffset = alignSection(header.vertexOffset + mesh.vertices.size() * sizeof(Vertex));
+    header.rangeOffset = alignSection(header.indexOffset + view.indexBytes());
+    header.lodOffset = alignSection(header.rangeOffset + view.ranges.size() * sizeof(DrawRange));
+    header.meshletOffset = alignSection(header.lodOffset + view.lods.size() * sizeof(MeshLod));
+    header.meshletVertexOffset = alignSection(header.meshletOffset + mesh.meshlets.size() * sizeof(Meshlet));
+    header.meshletTriangleOffset =
+        alignSection(header.meshletVertexOffset + mesh.meshletVertices.size() * sizeof(uint32_t));
+    header.textureTableOffset =
+        alignSection(header.meshletTriangleOffset + mesh.meshletTriangles.size() * sizeof(uint32_t));
+    header.stringsOffset = alignSection(header.textureTableOffset + table.size() * sizeof(MeshFileString));
+    header.fileSize = header.stringsOffset + strings.size();
+
+    std::vector<uint8_t> bytes(header.fileSize, 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    if (!mesh.vertices.empty()) {
+        std::memcpy(bytes.data() + header.vertexOffset, mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+    }
+    if (view.indexCount > 0) {
+        std::memcpy(bytes.data() + header.indexOffset, view.indexData, view.indexBytes());
+    }
+    if (!view.ranges.empty()) {
+        std::memcpy(bytes.data() + header.rangeOffset, view.ranges.data(), view.ranges.size() * sizeof(DrawRange));
+    }
+    if (!view.lods.empty()) {
+        std::memcpy(bytes.data() + header.lodOffset, view.lods.data(), view.lods.size() * sizeof(MeshLod));
+    }
+    if (!mesh.meshlets.empty()) {
+        std::memcpy(bytes.data() + header.meshletOffset, mesh.meshlets.data(), mesh.meshlets.size() * sizeof(Meshlet));
+        std::memcpy(bytes.data() + header.meshletVertexOffset, mesh.meshletVertices.data(),
+                    mesh.meshletVertices.size() * sizeof(uint32_t));
+        std::memcpy(bytes.data() + header.meshletTriangleOffset, mesh.meshletTriangles.data(),
+                    mesh.meshletTriangles.size() * sizeof(uint32_t));
+    }
+    if (!table.empty()) {
+        std::memcpy(bytes.data() + header.textureTableOffset, table.data(), table.size() * sizeof(MeshFileString));
+    }
+    if (!strings.empty()) {
+        std::memcpy(bytes.data() + header.stringsOffset, strings.data(), strings.size());
+    }
+    return bytes;
+}
+
+void writeMeshFile(const std::string& path, const MeshData& mesh) {
+    std::vector<uint8_t> bytes = serializeMesh(mesh);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open " + path + " for writing");
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    if (!file) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+MeshView readMeshFile(const void* data, size_t size) {
+    if (size < sizeof(MeshFileHeader)) {
+        throw std::runtime_error("vmesh: file too small");
+    }
+
+    // The mapping may only be 4-byte aligned, so copy the header out
+    MeshFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMeshFileMagic) {
+        throw std::runtime_error("vmesh: bad magic");
+    }
+    if (header.version != kMeshFileVersion || header.vertexStride != sizeof(Vertex)) {
+        throw std::runtime_error("vmesh: unsupported version " + std::to_string(header.version));
+    }
+    uint32_t indexSize = (header.flags & kMeshFileShortIndices) ? sizeof(uint16_t) : sizeof(uint32_t);
+    if (header.fileSize > size ||
+        !sectionInBounds(header.vertexOffset, uint64_t(header.vertexCount) * sizeof(Vertex), header.fileSize) ||
+        !sectionInBounds(header.indexOffset, uint64_t(header.indexCount) * indexSize, header.fileSize) ||
+        !sectionInBounds(header.rangeOffset, uint64_t(header.rangeCount) * sizeof(DrawRange), header.fileSize) ||
+        !sectionInBounds(header.lodOffset, uint64_t(header.lodCount) * sizeof(MeshLod), header.fileSize) ||
+        !sectionInBounds(header.meshletOffset, uint64_t(header.meshletCount) * sizeof(Meshlet), header.fileSize) ||
+        !sectionInBounds(header.meshletVertexOffset, uint64_t(header.meshletVertexCount) * sizeof(uint32_t),
+                         header.fileSize) ||
+        !sectionInBounds(header.meshletTriangleOffset, uint64_t(header.meshletTriangleCount) * sizeof(uint32_t),
+                         header.fileSize) ||
+        !sectionInBounds(header.textureTableOffset, uint64_t(header.textureCount) * sizeof(MeshFileString), header.fileSize) ||
+        header.stringsOffset > header.fileSize) {
+        throw std::runtime_error("vmesh: section out of bounds");
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t stringsSize = header.fileSize - header.stringsOffset;
+
+    MeshView view;
+    view.vertexData = bytes + header.vertexOffset;
+    view.vertexCount = header.vertexCount;
+    view.indexData = bytes + header.indexOffset;
+    view.indexCount = header.indexCount;
+    view.indexSize = indexSize;
+
+    view.ranges.resize(header.rangeCount);
+    if (header.rangeCount > 0) {
+        std::memcpy(view.ranges.data(), bytes + header.rangeOffset, header.rangeCount * sizeof(DrawRange));
+    }
+    for (const DrawRange& range : view.ranges) {
+        if (!sectionInBounds(range.firstIndex, range.indexCount, header.indexCount) || range.vertexOffset < 0 ||
+            !sectionInBounds(uint64_t(range.vertexOffset), range.vertexCount, header.vertexCount) ||
+            range.texture >= std::max(header.textureCount, 1u)) {
+            throw std::runtime_error("vmesh: draw range out of bounds");
+        }
+    }
+    if (view.ranges.empty() && view.indexCount > 0) {
+        view.ranges.push_back(wholeMeshRange(view.indexCount, view.vertexCount));
+    }
+
+    view.lods.resize(header.lodCount);
+    if (header.lodCount > 0) {
+        std::memcpy(view.lods.data(), bytes + header.lodOffset, header.lodCount * sizeof(MeshLod));
+    }
+    for (const MeshLod& lod : view.lods) {
+        if (lod.rangeCount == 0 || !sectionInBounds(lod.firstRange, lod.rangeCount, view.ranges.size())) {
+            throw std::runtime_error("vmesh: LOD out of bounds");
+        }
+    }
+    if (view.lods.empty() && !view.ranges.empty()) {
+        view.lods.push_back(wholeMeshLod(view.ranges));
+    }
+
+    // Meshlets are checked against their range so the CPU culling path can draw them
+    // without further checks; the mesh shader only reads inside the meshlet sections
+    view.meshlets.resize(header.meshletCount);
+    if (header.meshletCount > 0) {
+        std::memcpy(view.meshlets.data(), bytes + header.meshletOffset, header.meshletCount * sizeof(Meshlet));
+    }
+    uint32_t previousRange = 0;
+    for (const Meshlet& meshlet : view.meshlets) {
+        if (meshlet.range >= view.ranges.size() || meshlet.range < previousRange) {
+            throw std::runtime_error("vmesh: meshlet out of bounds");
+        }
+        const DrawRange& range = view.ranges[meshlet.range];
+        if (meshlet.baseVertex != range.vertexOffset || meshlet.texture != range.texture ||
+            meshlet.firstIndex < range.firstIndex ||
+            meshlet.triangleCount > kMeshletMaxTriangles || meshlet.vertexCount > kMeshletMaxVertices ||
+            !sectionInBounds(meshlet.firstIndex - range.firstIndex, uint64_t(meshlet.triangleCount) * 3, range.indexCount) ||
+            !sectionInBounds(meshlet.firstVertex, meshlet.vertexCount, header.meshletVertexCount) ||
+            !sectionInBounds(meshlet.firstTriangle, meshlet.triangleCount, header.meshletTriangleCount)) {
+            throw std::runtime_error("vmesh: meshlet out of bounds");
+        }
+        previousRange = meshlet.range;
+    }
+    view.meshletVertices = reinterpret_cast<const uint32_t*>(bytes + header.meshletVertexOffset);
+    view.meshletVertexCount = header.meshletVertexCount;
+    view.meshletTriangles = reinterpret_cast<const uint32_t*>(bytes + header.meshletTriangleOffset);
+    view.meshletTriangleCount = header.meshletTriangleCount;
+
+    view.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    view.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+
+    view.textures.reserve(header.textureCount);
+    for (uint32_t i = 0; i < header.textureCount; i++) {
+        MeshFileString entry;
+        std::memcpy(&entry, bytes + header.textureTableOffset + i * sizeof(MeshFileString), sizeof(entry));
+        if (!sectionInBounds(entry.offset, entry.length, stringsSize)) {
+            throw std::runtime_error("vmesh: texture name out of bounds");
+        }
+        view.textures.emplace_back(reinterpret_cast<const char*>(bytes + header.stringsOffset + entry.offset), entry.length);
+    }
+
+    return view;
+}
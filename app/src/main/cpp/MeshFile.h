@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// .vmesh: binary container holding a MeshData exactly as the renderer uploads it.
+//
+// Layout (little endian, every section starts on a 16-byte boundary):
+//   MeshFileHeader
+//   Vertex[vertexCount]
+//   uint16_t or uint32_t[indexCount]   (kMeshFileShortIndices)
+//   DrawRange[rangeCount]          one texture each, sorted by material within a LOD
+//   MeshLod[lodCount]              level 0 first, each a run of ranges
+//   Meshlet[meshletCount]          in range order, each a run of its range's indices
+//   uint32_t[meshletVertexCount]   index values of the meshlet vertices
+//   uint32_t[meshletTriangleCount] meshlet-local corners, one byte each
+//   MeshFileString[textureCount]   offsets relative to the string blob
+//   char[] string blob (not null terminated)
+//
+// The file is meant to be mmapped / AAsset_getBuffer-ed and the vertex and index
+// sections copied straight into staging memory. Bump kMeshFileVersion whenever the
+// layout or the Vertex struct changes; old files are then rejected and the loader
+// falls back to the OBJ.
+
+constexpr uint32_t kMeshFileMagic = 0x48534D56;  // "VMSH"
+constexpr uint32_t kMeshFileVersion = 5;
+
+// MeshFileHeader::flags
+constexpr uint32_t kMeshFileShortIndices = 1;  // 16-bit indices, relative to their range
+
+struct MeshFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexStride;
+    uint32_t flags;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t textureCount;
+    uint32_t rangeCount;
+    uint32_t lodCount;
+    uint32_t meshletCount;
+    uint32_t meshletVertexCount;
+    uint32_t meshletTriangleCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t rangeOffset;
+    uint64_t lodOffset;
+    uint64_t meshletOffset;
+    uint64_t meshletVertexOffset;
+    uint64_t meshletTriangleOffset;
+    uint64_t textureTableOffset;
+    uint64_t stringsOffset;
+    uint64_t fileSize;
+};
+static_assert(sizeof(MeshFileHeader) == 152, "MeshFileHeader layout changed");
+static_assert(sizeof(DrawRange) == 20, "DrawRange layout changed");
+static_assert(sizeof(MeshLod) == 16, "MeshLod layout changed");
+static_assert(sizeof(Meshlet) == 64, "Meshlet layout changed");
+
+struct MeshFileString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+// Serializes a mesh into .vmesh bytes
+std::vector<uint8_t> serializeMesh(const MeshData& mesh);
+
+// Writes a .vmesh file. Throws std::runtime_error on I/O failure.
+void writeMeshFile(const std::string& path, const MeshData& mesh);
+
+// Checks the header and section bounds and returns a view pointing into 'data', which
+// must stay alive while the view is used. Throws std::runtime_error if the file is
+// truncated, corrupt, or from another version.
+MeshView readMeshFile(const void* data, size_t size);
@@ -0,0 +1,332 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+// FIFO cache simulated with timestamps: a vertex is cached if fewer than cacheSize
+// misses happened since it was last loaded. Bumping the clock by cacheSize + 1
+// flushes everything without touching the per-vertex array.
+class FifoCache {
+public:
+    FifoCache(size_t vertexCount, unsigned cacheSize)
+        : loadTime(vertexCount, 0), cacheSize(cacheSize), time(cacheSize + 1) {}
+
+    // Returns the number of misses (0..3) for the triangle
+    unsigned access(const uint32_t* triangle) {
+        unsigned misses = 0;
+        for (int k = 0; k < 3; k++) {
+            uint32_t vertex = triangle[k];
+            if (time - loadTime[vertex] > cacheSize) {
+                loadTime[vertex] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    void flush() {
+        time += cacheSize + 1;
+    }
+
+private:
+    std::vector<uint32_t> loadTime;
+    unsigned cacheSize;
+    uint32_t time;
+};
+
+// Triangles using each vertex, in compressed sparse row form
+struct VertexAdjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    VertexAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+        : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+        for (uint32_t index : indices) {
+            offsets[index + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) {
+            triangles[fill[indices[i]]++] = uint32_t(i / 3);
+        }
+    }
+
+    uint32_t count(uint32_t vertex) const {
+        return offsets[vertex + 1] - offsets[vertex];
+    }
+};
+
+} // namespace
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                    unsigned cacheSize) {
+    VertexCacheStats stats;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return stats;
+    }
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+    size_t misses = 0;
+    size_t uniqueVertices = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        misses += cache.access(indices + 3 * t);
+        for (int k = 0; k < 3; k++) {
+            uint32_t vertex = indices[3 * t + k];
+            if (!referenced[vertex]) {
+                referenced[vertex] = true;
+                uniqueVertices++;
+            }
+        }
+    }
+
+    stats.acmr = float(misses) / float(triangleCount);
+    stats.atvr = float(misses) / float(uniqueVertices);
+    return stats;
+}
+
+std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount,
+                                          unsigned cacheSize) {
+    std::vector<uint32_t> clusterStarts;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return clusterStarts;
+    }
+
+    VertexAdjacency adjacency(indices, vertexCount);
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        liveTriangles[v] = adjacency.count(uint32_t(v));
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    uint32_t time = cacheSize + 1;
+    uint32_t cursor = 0;
+
+    // Next fanning vertex when the candidates are exhausted: the most recently used
+    // vertex that still has triangles, else the next one in input order
+    auto skipDeadEnd = [&]() -> uint32_t {
+        while (!deadEnds.empty()) {
+            uint32_t vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                return vertex;
+            }
+        }
+        while (cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) {
+                return cursor;
+            }
+            cursor++;
+        }
+        return kInvalidIndex;
+    };
+
+    uint32_t fan = skipDeadEnd();
+    clusterStarts.push_back(0);
+
+    while (fan != kInvalidIndex) {
+        candidates.clear();
+
+        for (uint32_t a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; a++) {
+            uint32_t triangle = adjacency.triangles[a];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = true;
+
+            for (int k = 0; k < 3; k++) {
+                uint32_t vertex = indices[3 * triangle + k];
+                output.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (time - cacheTime[vertex] > cacheSize) {
+                    cacheTime[vertex] = time++;
+                }
+            }
+        }
+
+        // Prefer the candidate that stays in the cache longest while its remaining
+        // triangles are emitted; candidates that would be evicted get priority -1
+        uint32_t next = kInvalidIndex;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+                priority = time - cacheTime[vertex];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+
+        if (next == kInvalidIndex) {
+            next = skipDeadEnd();
+            if (next != kInvalidIndex && time - cacheTime[next] > cacheSize) {
+                clusterStarts.push_back(uint32_t(output.size() / 3));
+            }
+        }
+        fan = next;
+    }
+
+    indices.swap(output);
+    return clusterStarts;
+}
+
+size_t optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                        const std::vector<uint32_t>& clusterStarts, float threshold, unsigned cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return 0;
+    }
+
+    // Soft boundaries: inside each cluster, start a new one as soon as the running ACMR
+    // from a cold cache is within threshold of the whole cluster's ACMR
+    std::vector<uint32_t> starts;
+    FifoCache cache(vertices.size(), cacheSize);
+    for (size_t c = 0; c < clusterStarts.size(); c++) {
+        size_t begin = clusterStarts[c];
+        size_t end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+
+        cache.flush();
+        size_t clusterMisses = 0;
+        for (size_t t = begin; t < end; t++) {
+            clusterMisses += cache.access(&indices[3 * t]);
+        }
+        float clusterThreshold = threshold * float(clusterMisses) / float(end - begin);
+
+        cache.flush();
+        starts.push_back(uint32_t(begin));
+        size_t misses = 0;
+        size_t triangles = 0;
+        for (size_t t = begin; t < end; t++) {
+            misses += cache.access(&indices[3 * t]);
+            triangles++;
+            if (t + 1 < end && float(misses) <= clusterThreshold * float(triangles)) {
+                starts.push_back(uint32_t(t + 1));
+                cache.flush();
+                misses = 0;
+                triangles = 0;
+            }
+        }
+    }
+
+    // Area weighted centroid and normal of every cluster and of the whole mesh
+    struct Cluster {
+        uint32_t begin;
+        uint32_t end;
+        glm::vec3 centroid;
+        glm::vec3 normal;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters(starts.size());
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < starts.size(); c++) {
+        Cluster& cluster = clusters[c];
+        cluster.begin = starts[c];
+        cluster.end = c + 1 < starts.size() ? starts[c + 1] : uint32_t(triangleCount);
+        cluster.centroid = glm::vec3(0.0f);
+        cluster.normal = glm::vec3(0.0f);
+
+        float clusterArea = 0.0f;
+        for (uint32_t t = cluster.begin; t < cluster.end; t++) {
+            const glm::vec3& p0 = vertices[indices[3 * t + 0]].pos;
+            const glm::vec3& p1 = vertices[indices[3 * t + 1]].pos;
+            const glm::vec3& p2 = vertices[indices[3 * t + 2]].pos;
+            glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(cross);
+            cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+            cluster.normal += cross;
+            clusterArea += area;
+        }
+        meshCentroid += cluster.centroid;
+        meshArea += clusterArea;
+        cluster.centroid = clusterArea > 0.0f ? cluster.centroid / clusterArea : vertices[indices[3 * cluster.begin]].pos;
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    // Whether the winding makes cross products point outward depends on the loader's
+    // axis flips; the sign of the enclosed volume tells which way is out
+    float orientation = 0.0f;
+    for (const Cluster& cluster : clusters) {
+        orientation += glm::dot(cluster.centroid - meshCentroid, cluster.normal);
+    }
+    float outward = orientation < 0.0f ? -1.0f : 1.0f;
+
+    for (Cluster& cluster : clusters) {
+        float length = glm::length(cluster.normal);
+        cluster.sortKey = length > 0.0f
+                ? glm::dot(cluster.centroid - meshCentroid, cluster.normal * (outward / length))
+                : -std::numeric_limits<float>::max();
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (const Cluster& cluster : clusters) {
+        output.insert(output.end(), indices.begin() + 3 * cluster.begin, indices.begin() + 3 * cluster.end);
+    }
+    indices.swap(output);
+    return clusters.size();
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> remap(vertices.size(), kInvalidIndex);
+    std::vector<Vertex> output;
+    output.reserve(vertices.size());
+
+    for (uint32_t& index : indices) {
+        if (remap[index] == kInvalidIndex) {
+            remap[index] = uint32_t(output.size());
+            output.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(output);
+}
+
+MeshOptimizationStats optimizeMesh(MeshData& mesh, unsigned cacheSize) {
+    MeshOptimizationStats stats;
+    stats.before = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), cacheSize);
+
+    if (mesh.ranges.empty()) {
+        std::vector<uint32_t> clusterStarts = optimizeVertexCache(mesh.indices, mesh.vertices.size(), cacheSize);
+        stats.clusterCount = optimizeOverdraw(mesh.indices, mesh.vertices, clusterStarts, 1.05f, cacheSize);
+    } else {
+        std::vector<uint32_t> rangeIndices;
+        for (const DrawRange& range : mesh.ranges) {
+            auto first = mesh.indices.begin() + range.firstIndex;
+            rangeIndices.assign(first, first + range.indexCount);
+            std::vector<uint32_t> clusterStarts = optimizeVertexCache(rangeIndices, mesh.vertices.size(), cacheSize);
+            stats.clusterCount += optimizeOverdraw(rangeIndices, mesh.vertices, clusterStarts, 1.05f, cacheSize);
+            std::copy(rangeIndices.begin(), rangeIndices.end(), first);
+        }
+    }
+    optimizeVertexFetch(mesh.vertices, mesh.indices);
+
+    stats.after = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), cacheSize);
+    return stats;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// FIFO size used for the post-transform cache simulation; Mali and Adreno both
+// behave close to a small FIFO, 16 entries is a conservative middle ground
+constexpr unsigned kDefaultVertexCacheSize = 16;
+
+struct VertexCacheStats {
+    float acmr = 0.0f;  // Cache misses per triangle (0.5 is the ideal for large meshes, 3 is the worst)
+    float atvr = 0.0f;  // Cache misses per unique vertex (1.0 is the ideal)
+};
+
+struct MeshOptimizationStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+    size_t clusterCount = 0;
+};
+
+// Simulates a FIFO post-transform cache over the index buffer
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                    unsigned cacheSize = kDefaultVertexCacheSize);
+
+// Tipsify (Sander et al. 2007): reorders triangles so consecutive ones reuse vertices
+// still in the cache. Returns the triangle index where each cluster starts; a new
+// cluster begins whenever the walk has to jump to a vertex that is no longer cached.
+std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount,
+                                          unsigned cacheSize = kDefaultVertexCacheSize);
+
+// Splits the clusters further where the cache efficiency allows (ACMR within
+// threshold of the original), then sorts them so clusters facing away from the mesh
+// center are drawn first. Those are the ones most likely to occlude the rest from
+// an orbiting camera, which lets early depth testing reject more fragments.
+// Returns the number of clusters after splitting.
+size_t optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                        const std::vector<uint32_t>& clusterStarts, float threshold = 1.05f,
+                        unsigned cacheSize = kDefaultVertexCacheSize);
+
+// Renumbers vertices in order of first use by the index buffer, so vertex fetches walk
+// the buffer mostly sequentially. Unreferenced vertices are dropped.
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+// Runs the three passes above on a welded mesh, in that order. The cache and overdraw
+// passes run inside each draw range, so material ranges stay intact.
+MeshOptimizationStats optimizeMesh(MeshData& mesh, unsigned cacheSize = kDefaultVertexCacheSize);
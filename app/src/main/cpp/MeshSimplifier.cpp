@@ -0,0 +1,611 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <numeric>
+
+namespace {
+
+// Border planes count this much more than surface planes, per unit of squared length
+constexpr double kBorderWeight = 10.0;
+
+uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return uint64_t(a) << 32 | b;
+}
+
+} // namespace
+
+void MeshSimplifier::Quadric::addPlane(const glm::dvec3& normal, double distance, double scale) {
+    a00 += scale * normal.x * normal.x;
+    a01 += scale * normal.x * normal.y;
+    a02 += scale * normal.x * normal.z;
+    a11 += scale * normal.y * normal.y;
+    a12 += scale * normal.y * normal.z;
+    a22 += scale * normal.z * normal.z;
+    b0 += scale * normal.x * distance;
+    b1 += scale * normal.y * distance;
+    b2 += scale * normal.z * distance;
+    c += scale * distance * distance;
+    weight += scale;
+}
+
+void MeshSimplifier::Quadric::add(const Quadric& other) {
+    a00 += other.a00;
+    a01 += other.a01;
+    a02 += other.a02;
+    a11 += other.a11;
+    a12 += other.a12;
+    a22 += other.a22;
+    b0 += other.b0;
+    b1 += other.b1;
+    b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+}
+
+double MeshSimplifier::Quadric::evaluate(const glm::dvec3& p) const {
+    return a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+         + 2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+         + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+}
+
+MeshSimplifier::MeshSimplifier(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                               const std::vector<uint32_t>& triangleMaterials)
+    : vertices(vertices), currentIndices(indices), currentMaterials(triangleMaterials), positionId(vertices.size()) {
+    currentMaterials.resize(indices.size() / 3, 0);
+    size_t vertexCount = vertices.size();
+
+    // Vertices sharing a position (UV or material seams) map to the lowest index among
+    // them, found through an open addressing table over the position bits
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2) {
+        tableSize *= 2;
+    }
+    std::vector<uint32_t> table(tableSize, kInvalidVertex);
+    std::vector<uint32_t> wedges(vertexCount, 0);
+    otherWedge.resize(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        const glm::vec3& pos = vertices[v].pos;
+        uint32_t bits[3];
+        for (int k = 0; k < 3; k++) {
+            float value = pos[k] + 0.0f;  // -0 and +0 are the same position
+            std::memcpy(&bits[k], &value, sizeof(float));
+        }
+        uint32_t hash = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        size_t slot = (hash ^ (hash >> 15)) & (tableSize - 1);
+        while (table[slot] != kInvalidVertex && vertices[table[slot]].pos != pos) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] == kInvalidVertex) {
+            table[slot] = v;
+        }
+        uint32_t first = table[slot];
+        positionId[v] = first;
+        otherWedge[v] = first;
+        if (++wedges[first] == 2) {
+            otherWedge[first] = v;
+        }
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (wedges[positionId[v]] != 2) {
+            otherWedge[v] = uint32_t(v);
+        }
+    }
+
+    // Outgoing edges of every position (with the material of their triangle) and of every
+    // vertex, in compressed sparse row form
+    std::vector<uint32_t> positionOffsets(vertexCount + 1, 0);
+    std::vector<uint32_t> vertexOffsets(vertexCount + 1, 0);
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (int k = 0; k < 3; k++) {
+            uint32_t a = indices[t + k];
+            uint32_t b = indices[t + (k + 1) % 3];
+            if (positionId[a] != positionId[b]) {
+                positionOffsets[positionId[a] + 1]++;
+                vertexOffsets[a + 1]++;
+            }
+        }
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        positionOffsets[v + 1] += positionOffsets[v];
+        vertexOffsets[v + 1] += vertexOffsets[v];
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> positionEdges(positionOffsets[vertexCount]);  // (target, material)
+    std::vector<uint32_t> vertexEdges(vertexOffsets[vertexCount]);
+    {
+        std::vector<uint32_t> positionFill(positionOffsets.begin(), positionOffsets.end() - 1);
+        std::vector<uint32_t> vertexFill(vertexOffsets.begin(), vertexOffsets.end() - 1);
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = indices[t + k];
+                uint32_t b = indices[t + (k + 1) % 3];
+                if (positionId[a] != positionId[b]) {
+                    positionEdges[positionFill[positionId[a]]++] = {positionId[b], currentMaterials[t / 3]};
+                    vertexEdges[vertexFill[a]++] = b;
+                }
+            }
+        }
+    }
+
+    // An edge is on a border when no triangle of the same material uses it in the
+    // opposite direction. In position space that is an open border of the surface or a
+    // material boundary; in index space it is also true along UV seams.
+    auto isBorderEdge = [&](uint32_t material, uint32_t positionA, uint32_t positionB) {
+        for (uint32_t e = positionOffsets[positionB]; e < positionOffsets[positionB + 1]; e++) {
+            if (positionEdges[e].first == positionA && positionEdges[e].second == material) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto isOpenEdge = [&](uint32_t a, uint32_t b) {
+        for (uint32_t e = vertexOffsets[b]; e < vertexOffsets[b + 1]; e++) {
+            if (vertexEdges[e] == a) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Counted once per undirected edge, so a material boundary looks like an open
+    // border: one border edge in and one out
+    std::vector<uint64_t> undirectedBorders;
+    for (uint32_t a = 0; a < vertexCount; a++) {
+        for (uint32_t e = positionOffsets[a]; e < positionOffsets[a + 1]; e++) {
+            auto [b, material] = positionEdges[e];
+            if (isBorderEdge(material, a, b)) {
+                undirectedBorders.push_back(edgeKey(std::min(a, b), std::max(a, b)));
+            }
+        }
+    }
+    std::sort(undirectedBorders.begin(), undirectedBorders.end());
+    undirectedBorders.erase(std::unique(undirectedBorders.begin(), undirectedBorders.end()), undirectedBorders.end());
+    links.assign(vertexCount, {kInvalidVertex, kInvalidVertex});
+    std::vector<uint32_t> borderEdges(vertexCount, 0);
+    auto link = [&](uint32_t position, uint32_t neighbor, uint32_t& count) {
+        if (count < 2) {
+            links[position][count] = neighbor;
+        }
+        count++;
+    };
+    for (uint64_t edge : undirectedBorders) {
+        uint32_t a = uint32_t(edge >> 32);
+        uint32_t b = uint32_t(edge);
+        link(a, b, borderEdges[a]);
+        link(b, a, borderEdges[b]);
+    }
+    // Open edges of each wedge; repeated directed edges count once
+    std::vector<std::array<uint32_t, 2>> openLinks(vertexCount, {kInvalidVertex, kInvalidVertex});
+    std::vector<uint32_t> openEdges(vertexCount, 0);
+    for (uint32_t a = 0; a < vertexCount; a++) {
+        for (uint32_t e = vertexOffsets[a]; e < vertexOffsets[a + 1]; e++) {
+            uint32_t b = vertexEdges[e];
+            if (std::find(vertexEdges.begin() + vertexOffsets[a], vertexEdges.begin() + e, b) !=
+                vertexEdges.begin() + e || !isOpenEdge(a, b)) {
+                continue;
+            }
+            for (auto [vertex, neighbor] : {std::make_pair(a, b), std::make_pair(b, a)}) {
+                if (openEdges[vertex] < 2) {
+                    openLinks[vertex][openEdges[vertex]] = positionId[neighbor];
+                }
+                openEdges[vertex]++;
+            }
+        }
+    }
+
+    // A border vertex has exactly one border edge in and one out, and a seam vertex is
+    // two wedges that each have one open edge in and one out. Anything else is a
+    // corner, a seam junction or non-manifold and stays put.
+    kind.assign(vertexCount, VertexKind::Manifold);
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (positionId[v] != v) {
+            continue;
+        }
+        if (wedges[v] == 1) {
+            if (borderEdges[v] == 2) {
+                kind[v] = VertexKind::Border;
+            } else if (borderEdges[v] != 0) {
+                kind[v] = VertexKind::Locked;
+            }
+        } else if (wedges[v] == 2 && borderEdges[v] == 0 && openEdges[v] == 2 && openEdges[otherWedge[v]] == 2) {
+            kind[v] = VertexKind::Seam;
+            links[v] = openLinks[v];
+        } else {
+            kind[v] = VertexKind::Locked;
+        }
+    }
+
+    collapsedInto.resize(vertexCount);
+    std::iota(collapsedInto.begin(), collapsedInto.end(), 0);
+
+    // Area weighted triangle planes, plus planes perpendicular to each border edge
+    quadrics.assign(vertexCount, Quadric{});
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        uint32_t corner[3] = {positionId[indices[t]], positionId[indices[t + 1]], positionId[indices[t + 2]]};
+        glm::dvec3 p[3] = {glm::dvec3(vertices[corner[0]].pos), glm::dvec3(vertices[corner[1]].pos),
+                           glm::dvec3(vertices[corner[2]].pos)};
+        glm::dvec3 cross = glm::cross(p[1] - p[0], p[2] - p[0]);
+        double length = glm::length(cross);
+        if (length == 0.0) {
+            continue;
+        }
+        glm::dvec3 normal = cross / length;
+        double area = 0.5 * length;
+        double distance = -glm::dot(normal, p[0]);
+        for (int k = 0; k < 3; k++) {
+            quadrics[corner[k]].addPlane(normal, distance, area);
+        }
+
+        for (int k = 0; k < 3; k++) {
+            uint32_t a = corner[k];
+            uint32_t b = corner[(k + 1) % 3];
+            if (a == b || !isBorderEdge(currentMaterials[t / 3], a, b)) {
+                continue;
+            }
+            glm::dvec3 edge = p[(k + 1) % 3] - p[k];
+            glm::dvec3 borderNormal = glm::cross(edge, normal);
+            double borderLength = glm::length(borderNormal);
+            if (borderLength == 0.0) {
+                continue;
+            }
+            borderNormal /= borderLength;
+            double borderDistance = -glm::dot(borderNormal, p[k]);
+            double scale = glm::dot(edge, edge) * kBorderWeight;
+            quadrics[a].addPlane(borderNormal, borderDistance, scale);
+            quadrics[b].addPlane(borderNormal, borderDistance, scale);
+        }
+    }
+
+    selfError.resize(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        selfError[v] = quadrics[v].evaluate(glm::dvec3(vertices[v].pos));
+    }
+}
+
+double MeshSimplifier::collapseError(uint32_t from, uint32_t to) const {
+    const Quadric& moved = quadrics[positionId[from]];
+    uint32_t kept = positionId[to];
+    double error = moved.evaluate(glm::dvec3(vertices[kept].pos)) + selfError[kept];
+    double weight = moved.weight + quadrics[kept].weight;
+    return std::max(error, 0.0) / (weight > 0.0 ? weight : 1.0);
+}
+
+uint32_t MeshSimplifier::findPosition(uint32_t position) {
+    while (collapsedInto[position] != position) {
+        collapsedInto[position] = collapsedInto[collapsedInto[position]];
+        position = collapsedInto[position];
+    }
+    return position;
+}
+
+uint32_t MeshSimplifier::findNeighbor(uint32_t vertex, uint32_t position) const {
+    for (uint32_t corner = firstCorner[vertex]; corner != kInvalidVertex; corner = nextCorner[corner]) {
+        if (removedTriangle[corner / 3]) {
+            continue;
+        }
+        const uint32_t* triangle = &currentIndices[corner / 3 * 3];
+        for (int k = 0; k < 3; k++) {
+            if (positionId[triangle[k]] == position) {
+                return triangle[k];
+            }
+        }
+    }
+    return kInvalidVertex;
+}
+
+bool MeshSimplifier::flipsFan(uint32_t from, uint32_t to) const {
+    // Triangles that keep their area must keep their facing
+    glm::dvec3 target(vertices[to].pos);
+    uint32_t positionTo = positionId[to];
+    for (uint32_t corner = firstCorner[from]; corner != kInvalidVertex; corner = nextCorner[corner]) {
+        if (removedTriangle[corner / 3]) {
+            continue;
+        }
+        const uint32_t* triangle = &currentIndices[corner / 3 * 3];
+        glm::dvec3 p[3];
+        bool collapsesToEdge = false;
+        for (int k = 0; k < 3; k++) {
+            p[k] = glm::dvec3(vertices[triangle[k]].pos);
+            collapsesToEdge |= positionId[triangle[k]] == positionTo;
+        }
+        if (collapsesToEdge) {
+            continue;
+        }
+        glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+        p[corner % 3] = target;
+        glm::dvec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+        if (glm::dot(before, after) <= 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MeshSimplifier::findCollapse(uint32_t position, Collapse& collapse, bool checkFlips) {
+    if (kind[position] == VertexKind::Locked || collapsedInto[position] != position) {
+        return false;
+    }
+
+    // Any neighbour for a manifold vertex, the neighbours along the border or seam
+    // otherwise. A seam vertex moves both of its wedges, each onto the wedge on its own
+    // side of the seam.
+    uint32_t from = position;
+    uint32_t partner = kind[position] == VertexKind::Seam ? otherWedge[position] : kInvalidVertex;
+    candidates.clear();
+    if (kind[position] == VertexKind::Manifold) {
+        for (uint32_t corner = firstCorner[from]; corner != kInvalidVertex; corner = nextCorner[corner]) {
+            if (removedTriangle[corner / 3]) {
+                continue;
+            }
+            // The fan is closed, so every neighbour follows 'from' in one of its triangles
+            uint32_t to = currentIndices[corner / 3 * 3 + (corner + 1) % 3];
+            candidates.push_back({from, to, kInvalidVertex, collapseError(from, to)});
+        }
+    } else {
+        for (uint32_t link : links[position]) {
+            uint32_t target = link == kInvalidVertex ? position : findPosition(link);
+            uint32_t to = target == position ? kInvalidVertex : findNeighbor(from, target);
+            uint32_t partnerTo = partner == kInvalidVertex || to == kInvalidVertex ? kInvalidVertex
+                                                                                   : findNeighbor(partner, target);
+            if (to != kInvalidVertex && (partner == kInvalidVertex || partnerTo != kInvalidVertex)) {
+                candidates.push_back({from, to, partnerTo, collapseError(from, to)});
+            }
+        }
+    }
+    auto cheaper = [](const Collapse& x, const Collapse& y) {
+        return x.error < y.error || (x.error == y.error && x.to < y.to);
+    };
+    if (!checkFlips) {
+        if (candidates.empty()) {
+            return false;
+        }
+        collapse = *std::min_element(candidates.begin(), candidates.end(), cheaper);
+        return true;
+    }
+    std::sort(candidates.begin(), candidates.end(), cheaper);
+    for (const Collapse& candidate : candidates) {
+        if (!flipsFan(from, candidate.to) && (partner == kInvalidVertex || !flipsFan(partner, candidate.partnerTo))) {
+            collapse = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+float MeshSimplifier::error() const {
+    return float(std::sqrt(maxError));
+}
+
+void MeshSimplifier::simplify(size_t targetIndexCount) {
+    if (currentIndices.size() <= targetIndexCount) {
+        return;
+    }
+    size_t vertexCount = vertices.size();
+    size_t triangleCount = currentIndices.size() / 3;
+
+    // The corners of each vertex as linked lists, so a collapse hands its fan to the
+    // target without rebuilding any adjacency. Triangles that already lost their area
+    // are dropped up front.
+    firstCorner.assign(vertexCount, kInvalidVertex);
+    nextCorner.resize(currentIndices.size());
+    removedTriangle.assign(triangleCount, false);
+    size_t indexCount = currentIndices.size();
+    for (size_t t = triangleCount; t-- > 0;) {
+        const uint32_t* triangle = &currentIndices[3 * t];
+        uint32_t a = positionId[triangle[0]];
+        uint32_t b = positionId[triangle[1]];
+        uint32_t c = positionId[triangle[2]];
+        if (a == b || b == c || a == c) {
+            removedTriangle[t] = true;
+            indexCount -= 3;
+            continue;
+        }
+        for (size_t corner = 3 * t + 3; corner-- > 3 * t;) {
+            nextCorner[corner] = firstCorner[currentIndices[corner]];
+            firstCorner[currentIndices[corner]] = uint32_t(corner);
+        }
+    }
+
+    // Every position that may move sits in the queue under the error of its cheapest
+    // collapse. A collapse only changes the fans around it, so only those positions are
+    // marked, and their collapse is found again when their entry comes up. Otherwise the
+    // queued collapse still holds and only its error is refreshed, since the target may
+    // have absorbed other positions. Either way the entry goes back into the queue if it
+    // got more expensive.
+    //
+    // The queue orders by the error rounded to 3 mantissa bits, then by position, so
+    // collapses of about the same cost run in memory order and small error increases
+    // don't requeue anything.
+    auto queueKey = [](double error, uint32_t position) {
+        float rounded = float(error);
+        uint32_t bits;
+        std::memcpy(&bits, &rounded, sizeof(bits));
+        return uint64_t(bits >> 20) << 32 | position;
+    };
+    std::vector<uint64_t> queue;
+    std::vector<Collapse> best(vertexCount);
+    std::vector<bool> queued(vertexCount, false);
+    std::vector<bool> fanChanged(vertexCount, false);
+    std::vector<bool> flipsChecked(vertexCount, false);
+    for (uint32_t position = 0; position < vertexCount; position++) {
+        if (positionId[position] == position && findCollapse(position, best[position], false)) {
+            queue.push_back(queueKey(best[position].error, position));
+            queued[position] = true;
+        }
+    }
+    std::make_heap(queue.begin(), queue.end(), std::greater<>());
+    auto enqueue = [&](uint32_t position) {
+        queue.push_back(queueKey(best[position].error, position));
+        std::push_heap(queue.begin(), queue.end(), std::greater<>());
+        queued[position] = true;
+    };
+
+    std::vector<uint32_t> affected;
+    std::vector<uint32_t> affectedMark(vertexCount, UINT32_MAX);
+    uint32_t collapseCount = 0;
+    while (indexCount > targetIndexCount && !queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<>());
+        uint64_t key = queue.back();
+        queue.pop_back();
+        uint32_t positionFrom = uint32_t(key);
+        queued[positionFrom] = false;
+        if (fanChanged[positionFrom]) {
+            fanChanged[positionFrom] = false;
+            flipsChecked[positionFrom] = false;
+            if (!findCollapse(positionFrom, best[positionFrom], false)) {
+                continue;  // until a neighbour changes the fan
+            }
+        } else {
+            best[positionFrom].error = collapseError(best[positionFrom].from, best[positionFrom].to);
+        }
+        if (queueKey(best[positionFrom].error, positionFrom) > key) {
+            enqueue(positionFrom);
+            continue;
+        }
+        // Flips are only checked for the collapse about to happen
+        if (!flipsChecked[positionFrom]) {
+            flipsChecked[positionFrom] = true;
+            if (!findCollapse(positionFrom, best[positionFrom], true)) {
+                continue;
+            }
+            if (queueKey(best[positionFrom].error, positionFrom) > key) {
+                enqueue(positionFrom);
+                continue;
+            }
+        }
+        const Collapse collapse = best[positionFrom];
+        double error = collapse.error;
+        uint32_t positionTo = positionId[collapse.to];
+
+        affected.clear();
+        collapseCount++;
+        auto moveFan = [&](uint32_t vertex, uint32_t to) {
+            // Triangles that end up with two corners at the target lose their area; the
+            // rest are handed to the target
+            uint32_t head = kInvalidVertex;
+            uint32_t tail = kInvalidVertex;
+            for (uint32_t corner = firstCorner[vertex], next; corner != kInvalidVertex; corner = next) {
+                next = nextCorner[corner];
+                if (removedTriangle[corner / 3]) {
+                    continue;
+                }
+                uint32_t* triangle = &currentIndices[corner / 3 * 3];
+                bool degenerate = false;
+                for (int k = 0; k < 3; k++) {
+                    uint32_t position = positionId[triangle[k]];
+                    degenerate |= position == positionTo;
+                    if (affectedMark[position] != collapseCount) {
+                        affectedMark[position] = collapseCount;
+                        affected.push_back(position);
+                    }
+                }
+                if (degenerate) {
+                    removedTriangle[corner / 3] = true;
+                    indexCount -= 3;
+                    continue;
+                }
+                currentIndices[corner] = to;
+                nextCorner[corner] = head;
+                head = corner;
+                tail = tail == kInvalidVertex ? corner : tail;
+            }
+            if (head != kInvalidVertex) {
+                nextCorner[tail] = firstCorner[to];
+                firstCorner[to] = head;
+            }
+            firstCorner[vertex] = kInvalidVertex;
+        };
+        moveFan(collapse.from, collapse.to);
+        if (collapse.partnerTo != kInvalidVertex) {
+            moveFan(otherWedge[positionFrom], collapse.partnerTo);
+        }
+        quadrics[positionTo].add(quadrics[positionFrom]);
+        selfError[positionTo] = quadrics[positionTo].evaluate(glm::dvec3(vertices[positionTo].pos));
+        collapsedInto[positionFrom] = positionTo;
+        maxError = std::max(maxError, error);
+
+        // Positions that had nothing to collapse may have something now
+        for (uint32_t position : affected) {
+            fanChanged[position] = true;
+            if (!queued[position] && findCollapse(position, best[position], false)) {
+                fanChanged[position] = false;
+                flipsChecked[position] = false;
+                enqueue(position);
+            }
+        }
+    }
+
+    size_t write = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (!removedTriangle[t]) {
+            std::copy_n(&currentIndices[3 * t], 3, &currentIndices[3 * write]);
+            currentMaterials[write++] = currentMaterials[t];
+        }
+    }
+    currentIndices.resize(3 * write);
+    currentMaterials.resize(write);
+}
+
+void buildLodChain(MeshData& mesh, const std::vector<float>& ratios) {
+    mesh.lods.clear();
+    if (mesh.indices.empty()) {
+        mesh.ranges.clear();
+        return;
+    }
+    if (mesh.ranges.empty()) {
+        mesh.ranges.push_back(wholeMeshRange(mesh.indices.size(), mesh.vertices.size()));
+    }
+
+    // Level 0 keeps the material ranges of buildMesh
+    std::vector<uint32_t> triangleMaterials(mesh.indices.size() / 3, 0);
+    for (const DrawRange& range : mesh.ranges) {
+        std::fill_n(triangleMaterials.begin() + range.firstIndex / 3, range.indexCount / 3, range.texture);
+    }
+    mesh.lods.push_back(MeshLod{0, uint32_t(mesh.ranges.size()), uint32_t(mesh.indices.size()), 0.0f});
+
+    size_t baseTriangles = mesh.indices.size() / 3;
+    MeshSimplifier simplifier(mesh.vertices, mesh.indices, triangleMaterials);
+    for (float ratio : ratios) {
+        if (ratio >= 1.0f) {
+            continue;
+        }
+        simplifier.simplify(size_t(double(baseTriangles) * ratio) * 3);
+
+        const std::vector<uint32_t>& level = simplifier.indices();
+        const std::vector<uint32_t>& materials = simplifier.materials();
+        if (level.empty() || level.size() * 10 > size_t(mesh.lods.back().indexCount) * 9) {
+            break;
+        }
+
+        // Group the triangles by material (stable, so the order stays deterministic) and
+        // optimize each group as its own draw
+        std::vector<uint32_t> order(materials.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&materials](uint32_t a, uint32_t b) { return materials[a] < materials[b]; });
+
+        MeshLod lod{uint32_t(mesh.ranges.size()), 0, uint32_t(level.size()), simplifier.error()};
+        std::vector<uint32_t> group;
+        for (size_t begin = 0; begin < order.size();) {
+            uint32_t material = materials[order[begin]];
+            size_t end = begin;
+            group.clear();
+            for (; end < order.size() && materials[order[end]] == material; end++) {
+                const uint32_t* triangle = &level[size_t(order[end]) * 3];
+                group.insert(group.end(), triangle, triangle + 3);
+            }
+            std::vector<uint32_t> clusterStarts = optimizeVertexCache(group, mesh.vertices.size());
+            optimizeOverdraw(group, mesh.vertices, clusterStarts);
+
+            mesh.ranges.push_back(DrawRange{uint32_t(mesh.indices.size()), uint32_t(group.size()), 0,
+                                            uint32_t(mesh.vertices.size()), material});
+            mesh.indices.insert(mesh.indices.end(), group.begin(), group.end());
+            lod.rangeCount++;
+            begin = end;
+        }
+        mesh.lods.push_back(lod);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Fractions of the level 0 triangle count for the default LOD chain
+inline const std::vector<float> kDefaultLodRatios = {1.0f, 0.5f, 0.25f, 0.125f};
+
+// Quadric error edge collapse (Garland & Heckbert 1997) restricted to collapsing a
+// vertex onto one of its neighbours, so every level indexes the original vertex buffer
+// and all levels can share it. Open borders and material boundaries only collapse along
+// themselves, and UV seams only along the seam, moving the vertices on both sides
+// together, so silhouettes, materials and texture mapping stay attached. Seam
+// junctions and corners never move.
+//
+// simplify() can be called repeatedly with decreasing targets; the quadrics carry over,
+// so each level's error is measured against the original surface.
+class MeshSimplifier {
+public:
+    // triangleMaterials has one entry per triangle (all 0 when empty); triangles keep
+    // their material through simplification
+    MeshSimplifier(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                   const std::vector<uint32_t>& triangleMaterials = {});
+
+    // Collapses edges, cheapest first, until at most targetIndexCount indices are left
+    // or nothing else can collapse without flipping a triangle
+    void simplify(size_t targetIndexCount);
+
+    const std::vector<uint32_t>& indices() const { return currentIndices; }
+    const std::vector<uint32_t>& materials() const { return currentMaterials; }
+
+    // Largest deviation from the original surface so far, in mesh units (RMS distance
+    // to the planes of the triangles merged into each vertex)
+    float error() const;
+
+private:
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+        double weight = 0;  // sum of plane scales, used to normalize the error
+
+        void addPlane(const glm::dvec3& normal, double distance, double scale);
+        void add(const Quadric& other);
+        double evaluate(const glm::dvec3& point) const;
+    };
+
+    enum class VertexKind : uint8_t {
+        Manifold,  // may collapse along any edge
+        Border,    // on an open border, may only collapse along it
+        Seam,      // two vertices at one position, may only collapse along the seam
+        Locked     // corner, seam junction or non-manifold: never moves
+    };
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        uint32_t partnerTo;  // where the other wedge of a seam vertex goes
+        double error;
+    };
+
+    static constexpr uint32_t kInvalidVertex = UINT32_MAX;
+
+    double collapseError(uint32_t from, uint32_t to) const;
+    // Position id that 'position' ended up in after the collapses so far
+    uint32_t findPosition(uint32_t position);
+    // Vertex at 'position' sharing a triangle with 'vertex'
+    uint32_t findNeighbor(uint32_t vertex, uint32_t position) const;
+    // Whether moving 'from' onto 'to' flips a triangle of its fan
+    bool flipsFan(uint32_t from, uint32_t to) const;
+    // Cheapest collapse of 'position' (that flips nothing, with checkFlips), if it may
+    // move at all
+    bool findCollapse(uint32_t position, Collapse& collapse, bool checkFlips);
+
+    const std::vector<Vertex>& vertices;
+    std::vector<uint32_t> currentIndices;
+    std::vector<uint32_t> currentMaterials; // per triangle
+    std::vector<uint32_t> positionId;     // first vertex with the same position
+    std::vector<uint32_t> otherWedge;     // the second vertex of a two-vertex position
+    std::vector<VertexKind> kind;         // per position id
+    std::vector<std::array<uint32_t, 2>> links;  // per border or seam position id: its neighbours along it
+    std::vector<uint32_t> collapsedInto;  // per position id, itself until it collapses
+    std::vector<Quadric> quadrics;        // per position id
+    std::vector<double> selfError;        // per position id, its quadric at its own position
+    // Only valid inside simplify(): the corners of each vertex as linked lists
+    std::vector<uint32_t> firstCorner;
+    std::vector<uint32_t> nextCorner;
+    std::vector<bool> removedTriangle;
+    std::vector<Collapse> candidates;     // scratch for findCollapse
+    double maxError = 0.0;
+};
+
+// Appends coarser levels of mesh.indices (level 0: the material ranges of buildMesh) at
+// the given ratios, each sorted by material into one range per material with its own
+// vertex cache / overdraw order, and fills mesh.lods. Levels that could not get below
+// 90% of the previous one are dropped. Runs after optimizeMesh and before
+// splitForShortIndices.
+void buildLodChain(MeshData& mesh, const std::vector<float>& ratios = kDefaultLodRatios);
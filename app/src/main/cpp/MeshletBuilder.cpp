@@ -0,0 +1,219 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr uint32_t kNoMeshlet = UINT32_MAX;
+
+// The pipeline draws VK_FRONT_FACE_CLOCKWISE with a Y-flipped projection, so a front
+// face is one whose cross(p1 - p0, p2 - p0) points away from the eye
+constexpr float kFrontNormalSign = -1.0f;
+
+// Bounding sphere around the AABB center, and the narrowest cone around the average
+// normal that contains every triangle normal. The cutoff is the sine of the cone
+// half-angle, as expected by the test in isMeshletCulled.
+void computeBounds(Meshlet& meshlet, const MeshData& mesh, const std::vector<glm::vec3>& normals,
+                   const std::vector<uint32_t>& triangles) {
+    auto position = [&](uint32_t local) -> const glm::vec3& {
+        return mesh.vertices[meshlet.baseVertex + mesh.meshletVertices[meshlet.firstVertex + local]].pos;
+    };
+
+    glm::vec3 boundsMin = position(0);
+    glm::vec3 boundsMax = position(0);
+    for (uint32_t v = 1; v < meshlet.vertexCount; v++) {
+        boundsMin = glm::min(boundsMin, position(v));
+        boundsMax = glm::max(boundsMax, position(v));
+    }
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t v = 0; v < meshlet.vertexCount; v++) {
+        radius = std::max(radius, glm::length(position(v) - center));
+    }
+    meshlet.sphere = glm::vec4(center, radius);
+
+    glm::vec3 axis(0.0f);
+    for (uint32_t t : triangles) {
+        axis += normals[t];
+    }
+    meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    float axisLength = glm::length(axis);
+    if (axisLength == 0.0f) {
+        return;
+    }
+    axis /= axisLength;
+    float minDot = 1.0f;
+    for (uint32_t t : triangles) {
+        if (normals[t] != glm::vec3(0.0f)) {
+            minDot = std::min(minDot, glm::dot(axis, normals[t]));
+        }
+    }
+    // Normals spread over more than a hemisphere: some triangle always faces the eye
+    if (minDot <= 0.0f) {
+        return;
+    }
+    meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+}
+
+template <typename Index>
+void buildRangeMeshlets(MeshData& mesh, const std::vector<Index>& indices, uint32_t rangeIndex) {
+    const DrawRange& range = mesh.ranges[rangeIndex];
+    const Index* rangeIndices = indices.data() + range.firstIndex;
+    uint32_t triangleCount = range.indexCount / 3;
+
+    const Vertex* vertices = mesh.vertices.data() + range.vertexOffset;
+    std::vector<glm::vec3> normals(triangleCount);
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        const glm::vec3& p0 = vertices[rangeIndices[3 * t]].pos;
+        const glm::vec3& p1 = vertices[rangeIndices[3 * t + 1]].pos;
+        const glm::vec3& p2 = vertices[rangeIndices[3 * t + 2]].pos;
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        normals[t] = length > 0.0f ? normal * (kFrontNormalSign / length) : glm::vec3(0.0f);
+    }
+
+    // meshletOf/localIndex say whether a vertex is already in the current meshlet; the
+    // meshlet id stamp avoids clearing them between meshlets
+    std::vector<uint32_t> meshletOf(range.vertexCount, kNoMeshlet);
+    std::vector<uint8_t> localIndex(range.vertexCount);
+    std::vector<uint32_t> members;
+
+    // Consecutive triangles fill a meshlet up to either limit. optimizeMesh already put
+    // neighbours next to each other, so the runs are compact, and the vertex cache order
+    // stays as it is.
+    for (uint32_t first = 0; first < triangleCount;) {
+        uint32_t id = uint32_t(mesh.meshlets.size());
+        Meshlet meshlet{};
+        meshlet.firstIndex = range.firstIndex + 3 * first;
+        meshlet.baseVertex = range.vertexOffset;
+        meshlet.firstVertex = uint32_t(mesh.meshletVertices.size());
+        meshlet.firstTriangle = uint32_t(mesh.meshletTriangles.size());
+        meshlet.range = rangeIndex;
+        meshlet.texture = range.texture;
+        members.clear();
+
+        for (uint32_t t = first; t < triangleCount && meshlet.triangleCount < kMeshletMaxTriangles; t++) {
+            const Index* triangle = rangeIndices + 3 * t;
+            uint32_t added = 0;
+            for (int k = 0; k < 3; k++) {
+                bool repeated = (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+                if (meshletOf[triangle[k]] != id && !repeated) {
+                    added++;
+                }
+            }
+            if (meshlet.vertexCount + added > kMeshletMaxVertices) {
+                break;
+            }
+            uint32_t packed = 0;
+            for (int k = 0; k < 3; k++) {
+                Index v = triangle[k];
+                if (meshletOf[v] != id) {
+                    meshletOf[v] = id;
+                    localIndex[v] = uint8_t(meshlet.vertexCount++);
+                    mesh.meshletVertices.push_back(v);
+                }
+                packed |= uint32_t(localIndex[v]) << (8 * k);
+            }
+            mesh.meshletTriangles.push_back(packed);
+            members.push_back(t);
+            meshlet.triangleCount++;
+        }
+        first += meshlet.triangleCount;
+        computeBounds(meshlet, mesh, normals, members);
+        mesh.meshlets.push_back(meshlet);
+    }
+}
+
+} // namespace
+
+void buildMeshlets(MeshData& mesh) {
+    mesh.meshlets.clear();
+    mesh.meshletVertices.clear();
+    mesh.meshletTriangles.clear();
+    bool shortIndices = !mesh.shortIndices.empty();
+    size_t indexCount = shortIndices ? mesh.shortIndices.size() : mesh.indices.size();
+    if (mesh.vertices.empty() || indexCount == 0) {
+        return;
+    }
+    if (mesh.ranges.empty()) {
+        mesh.ranges.push_back(wholeMeshRange(indexCount, mesh.vertices.size()));
+    }
+
+    for (uint32_t r = 0; r < mesh.ranges.size(); r++) {
+        if (shortIndices) {
+            buildRangeMeshlets(mesh, mesh.shortIndices, r);
+        } else {
+            buildRangeMeshlets(mesh, mesh.indices, r);
+        }
+    }
+}
+
+std::vector<uint32_t> meshletRangeOffsets(const std::vector<Meshlet>& meshlets, size_t rangeCount) {
+    std::vector<uint32_t> offsets(rangeCount + 1, 0);
+    for (const Meshlet& meshlet : meshlets) {
+        offsets[meshlet.range + 1]++;
+    }
+    for (size_t r = 0; r < rangeCount; r++) {
+        offsets[r + 1] += offsets[r];
+    }
+    return offsets;
+}
+
+MeshletCullInfo makeMeshletCullInfo(const glm::mat4& viewProjection, const glm::mat4& view) {
+    MeshletCullInfo info;
+    // Gribb/Hartmann plane extraction; OpenGL depth range, which is the looser one
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+    info.frustumPlanes[0] = rows[3] + rows[0];
+    info.frustumPlanes[1] = rows[3] - rows[0];
+    info.frustumPlanes[2] = rows[3] + rows[1];
+    info.frustumPlanes[3] = rows[3] - rows[1];
+    info.frustumPlanes[4] = rows[3] + rows[2];
+    info.frustumPlanes[5] = rows[3] - rows[2];
+    for (glm::vec4& plane : info.frustumPlanes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    info.eye = glm::vec3(glm::inverse(view)[3]);
+    return info;
+}
+
+bool isMeshletCulled(const Meshlet& meshlet, const MeshletCullInfo& info) {
+    glm::vec3 center(meshlet.sphere);
+    float radius = meshlet.sphere.w;
+    for (const glm::vec4& plane : info.frustumPlanes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return true;
+        }
+    }
+
+    // Every normal is within the cone, so if the eye is behind the cone's plane for the
+    // whole sphere, every triangle is back facing
+    glm::vec3 toCenter = center - info.eye;
+    return glm::dot(toCenter, glm::vec3(meshlet.cone)) >= meshlet.cone.w * glm::length(toCenter) + radius;
+}
+
+size_t cullMeshlets(const std::vector<Meshlet>& meshlets, const std::vector<DrawRange>& ranges, uint32_t first,
+                    uint32_t count, const MeshletCullInfo& info, std::vector<DrawRange>& out) {
+    out.clear();
+    size_t triangles = 0;
+    for (uint32_t m = first; m < first + count; m++) {
+        const Meshlet& meshlet = meshlets[m];
+        if (isMeshletCulled(meshlet, info)) {
+            continue;
+        }
+        triangles += meshlet.triangleCount;
+
+        uint32_t indexCount = 3 * meshlet.triangleCount;
+        if (!out.empty() && out.back().vertexOffset == meshlet.baseVertex && out.back().texture == meshlet.texture &&
+            out.back().firstIndex + out.back().indexCount == meshlet.firstIndex) {
+            out.back().indexCount += indexCount;
+        } else {
+            out.push_back(DrawRange{meshlet.firstIndex, indexCount, meshlet.baseVertex,
+                                    ranges[meshlet.range].vertexCount, meshlet.texture});
+        }
+    }
+    return triangles;
+}
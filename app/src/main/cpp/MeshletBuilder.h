@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Cuts the triangles of every draw range into meshlets (kMeshletMaxVertices /
+// kMeshletMaxTriangles) and fills mesh.meshlets, meshletVertices and meshletTriangles.
+// Each meshlet is the longest run of the index buffer that fits, so the order of
+// optimizeMesh is kept and meshlets that survive culling next to each other draw as one
+// range. The cones follow the renderer's front face convention (clockwise on screen).
+// Runs last, after splitForShortIndices.
+void buildMeshlets(MeshData& mesh);
+
+// rangeMeshlets[r] is the first meshlet of draw range r, with one extra entry at the
+// end; meshlets are stored in range order
+std::vector<uint32_t> meshletRangeOffsets(const std::vector<Meshlet>& meshlets, size_t rangeCount);
+
+// Camera data for culling, in mesh space
+struct MeshletCullInfo {
+    glm::vec4 frustumPlanes[6];  // xyz normal pointing inside, w distance
+    glm::vec3 eye;
+};
+
+MeshletCullInfo makeMeshletCullInfo(const glm::mat4& viewProjection, const glm::mat4& view);
+
+// True when the meshlet is outside the frustum or every triangle in it faces away from the eye
+bool isMeshletCulled(const Meshlet& meshlet, const MeshletCullInfo& info);
+
+// CPU path for devices without mesh shaders: culls meshlets [first, first + count) and
+// writes the survivors as draw ranges, merging neighbours that are contiguous in the
+// index buffer and share a texture. Returns the number of triangles kept.
+size_t cullMeshlets(const std::vector<Meshlet>& meshlets, const std::vector<DrawRange>& ranges, uint32_t first,
+                    uint32_t count, const MeshletCullInfo& info, std::vector<DrawRange>& out);
@@ -0,0 +1,69 @@
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+float srgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float value) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+struct LinearTable {
+    float values[256];
+
+    LinearTable() {
+        for (int i = 0; i < 256; i++) {
+            values[i] = srgbToLinear(i / 255.0f);
+        }
+    }
+};
+
+} // namespace
+
+uint32_t mipChainLevels(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    while (std::max(width >> (levels - 1), height >> (levels - 1)) > 1) {
+        levels++;
+    }
+    return levels;
+}
+
+size_t mipChainBytes(uint32_t width, uint32_t height, uint32_t levelCount) {
+    size_t bytes = 0;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        bytes += size_t(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * 4;
+    }
+    return bytes;
+}
+
+void downsampleRgba8Srgb(const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst) {
+    static const LinearTable toLinear;
+    const uint32_t outWidth = std::max(width / 2, 1u);
+    const uint32_t outHeight = std::max(height / 2, 1u);
+    for (uint32_t y = 0; y < outHeight; y++) {
+        for (uint32_t x = 0; x < outWidth; x++) {
+            float sum[4] = {};
+            for (uint32_t dy = 0; dy < 2; dy++) {
+                for (uint32_t dx = 0; dx < 2; dx++) {
+                    const uint32_t sx = std::min(x * 2 + dx, width - 1);
+                    const uint32_t sy = std::min(y * 2 + dy, height - 1);
+                    const uint8_t* texel = &src[(size_t(sy) * width + sx) * 4];
+                    for (int c = 0; c < 3; c++) {
+                        sum[c] += toLinear.values[texel[c]];
+                    }
+                    sum[3] += texel[3] / 255.0f;
+                }
+            }
+            uint8_t* out = &dst[(size_t(y) * outWidth + x) * 4];
+            for (int c = 0; c < 4; c++) {
+                const float value = c < 3 ? linearToSrgb(sum[c] * 0.25f) : sum[c] * 0.25f;
+                out[c] = uint8_t(std::clamp(value * 255.0f + 0.5f, 0.0f, 255.0f));
+            }
+        }
+    }
+}
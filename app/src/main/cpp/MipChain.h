@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Mip chains of RGBA8 sRGB images built on the CPU: each level is a 2x2 box of the one
+// above with the last row / column clamped on odd sizes and colors averaged in linear
+// space, like the chains the renderer builds on the GPU for PNGs.
+
+// Levels of a full chain, down to 1x1
+uint32_t mipChainLevels(uint32_t width, uint32_t height);
+// Bytes of the first levelCount levels stored back to back, level 0 first
+size_t mipChainBytes(uint32_t width, uint32_t height, uint32_t levelCount);
+// Writes the max(width / 2, 1) x max(height / 2, 1) level below src into dst
+void downsampleRgba8Srgb(const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst);
@@ -0,0 +1,99 @@
+#include "ModelRegistry.h"
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+ModelRegistry::ModelRegistry(const std::vector<ModelDesc>& scene) {
+    entries.resize(scene.size());
+    for (size_t i = 0; i < scene.size(); i++) {
+        entries[i].file = scene[i].file;
+        entries[i].transform = scene[i].transform;
+    }
+}
+
+void ModelRegistry::layout() {
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Model& model) { return !model.loaded; }),
+                  entries.end());
+    if (entries.empty()) {
+        throw std::runtime_error("no model of the scene could be loaded!");
+    }
+
+    sharedIndexSize = sizeof(uint16_t);
+    for (const Model& model : entries) {
+        sharedIndexSize = std::max(sharedIndexSize, model.mesh.indexSize);
+    }
+
+    // Texture names are merged in first-use order; a model without textures gets an
+    // empty name, which uploads as white
+    std::unordered_map<std::string, uint32_t> textureIndex;
+    textureTable.clear();
+    auto addTexture = [&](const std::string& name) {
+        auto [it, inserted] = textureIndex.emplace(name, uint32_t(textureTable.size()));
+        if (inserted) {
+            textureTable.push_back(name);
+        }
+        return it->second;
+    };
+
+    size_t vertices = 0, indices = 0, meshlets = 0, meshletVertices = 0, meshletTriangles = 0;
+    for (Model& model : entries) {
+        MeshView& mesh = model.mesh;
+        if (vertices + mesh.vertexCount > size_t(std::numeric_limits<int32_t>::max()) ||
+            indices + mesh.indexCount > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("scene does not fit in the shared geometry buffers!");
+        }
+        model.firstVertex = uint32_t(vertices);
+        model.firstIndex = uint32_t(indices);
+        model.firstMeshlet = uint32_t(meshlets);
+        model.firstMeshletVertex = uint32_t(meshletVertices);
+        model.firstMeshletTriangle = uint32_t(meshletTriangles);
+
+        std::vector<uint32_t> remap;
+        for (const std::string& name : mesh.textures) {
+            remap.push_back(addTexture(name));
+        }
+        if (remap.empty()) {
+            remap.push_back(addTexture(std::string()));
+        }
+
+        for (DrawRange& range : mesh.ranges) {
+            range.firstIndex += model.firstIndex;
+            range.vertexOffset += int32_t(model.firstVertex);
+            range.texture = remap[std::min<size_t>(range.texture, remap.size() - 1)];
+        }
+        for (Meshlet& meshlet : mesh.meshlets) {
+            meshlet.firstIndex += model.firstIndex;
+            meshlet.baseVertex += int32_t(model.firstVertex);
+            meshlet.firstVertex += model.firstMeshletVertex;
+            meshlet.firstTriangle += model.firstMeshletTriangle;
+            meshlet.texture = remap[std::min<size_t>(meshlet.texture, remap.size() - 1)];
+        }
+        model.rangeMeshlets = meshletRangeOffsets(mesh.meshlets, mesh.ranges.size());
+
+        vertices += mesh.vertexCount;
+        indices += mesh.indexCount;
+        meshlets += mesh.meshlets.size();
+        meshletVertices += mesh.meshletVertexCount;
+        meshletTriangles += mesh.meshletTriangleCount;
+    }
+
+    totalVertices = vertices;
+    totalIndices = indices;
+    totalMeshlets = meshlets;
+    totalMeshletVertices = meshletVertices;
+    totalMeshletTriangles = meshletTriangles;
+}
+
+void ModelRegistry::releaseSources() {
+    for (Model& model : entries) {
+        model.source = AssetData{};
+        model.storage = MeshData{};
+        model.mesh.vertexData = nullptr;
+        model.mesh.indexData = nullptr;
+        model.mesh.meshletVertices = nullptr;
+        model.mesh.meshletTriangles = nullptr;
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "AssetSource.h"
+#include "Mesh.h"
+#include "VertexQuantizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// One model of the scene: an OBJ asset (or the .vmesh next to it) and where it sits.
+// Meshlets are culled in model space, so the transform should not shear or scale
+// non-uniformly.
+struct ModelDesc {
+    std::string file;
+    glm::mat4 transform{1.0f};
+};
+
+// A loaded model and its slice of the shared geometry buffers. After
+// ModelRegistry::layout the ranges and meshlets in mesh address the shared buffers
+// (indices, vertices, meshlet arrays, merged texture table); LODs and Meshlet::range
+// still count within the model.
+struct Model {
+    std::string file;
+    glm::mat4 transform{1.0f};
+
+    // Points into storage (built from the OBJ) or into the mapped .vmesh in source;
+    // only the counts stay valid after ModelRegistry::releaseSources
+    MeshView mesh;
+    MeshData storage;
+    AssetData source;
+    bool loaded = false;
+
+    // Offsets into the shared buffers, in elements
+    uint32_t firstVertex = 0;
+    uint32_t firstIndex = 0;
+    uint32_t firstMeshlet = 0;
+    uint32_t firstMeshletVertex = 0;
+    uint32_t firstMeshletTriangle = 0;
+
+    // rangeMeshlets[r] is the first of mesh.meshlets cut from range r (one extra entry)
+    std::vector<uint32_t> rangeMeshlets;
+    // Packed vertex decode constants of this model's vertices
+    VertexQuantization quantization;
+    // Level of mesh.lods drawn last frame
+    uint32_t currentLod = 0;
+};
+
+// The models of the scene, suballocated into one vertex buffer, one index buffer and
+// one set of meshlet buffers so a frame binds them once and only pushes per-model
+// constants between draws. Loading is up to the caller (one model per task);
+// layout() runs once every model is in.
+class ModelRegistry {
+public:
+    explicit ModelRegistry(const std::vector<ModelDesc>& scene);
+
+    std::vector<Model>& models() { return entries; }
+    const std::vector<Model>& models() const { return entries; }
+
+    // Drops models that failed to load, assigns every model its offsets, merges the
+    // texture tables and rebases ranges and meshlets onto the shared buffers. Models
+    // with 16-bit indices are widened on upload when another model needs 32 bits.
+    void layout();
+
+    // Frees the CPU copies once the geometry is on the GPU
+    void releaseSources();
+
+    const std::vector<std::string>& textures() const { return textureTable; }
+    size_t vertexCount() const { return totalVertices; }
+    size_t indexCount() const { return totalIndices; }
+    uint32_t indexSize() const { return sharedIndexSize; }
+    size_t meshletCount() const { return totalMeshlets; }
+    size_t meshletVertexCount() const { return totalMeshletVertices; }
+    size_t meshletTriangleCount() const { return totalMeshletTriangles; }
+
+private:
+    std::vector<Model> entries;
+    std::vector<std::string> textureTable;
+    size_t totalVertices = 0;
+    size_t totalIndices = 0;
+    uint32_t sharedIndexSize = sizeof(uint16_t);
+    size_t totalMeshlets = 0;
+    size_t totalMeshletVertices = 0;
+    size_t totalMeshletTriangles = 0;
+};
@@ -0,0 +1,524 @@
+#include "ObjParser.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+const char* findLineEnd(const char* p, const char* end) {
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    while (end - p >= 16) {
+        uint8x16_t eq = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p)), newline);
+        // Narrow each 0xFF/0x00 byte to a nibble so the whole compare fits in 64 bits
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask != 0) {
+            return p + (__builtin_ctzll(mask) >> 2);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '\n') {
+        ++p;
+    }
+    return p;
+}
+
+namespace {
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* skipToken(const char* p, const char* end) {
+    while (p < end && !isBlank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Returns the next whitespace separated token and advances p past it
+inline std::string_view nextToken(const char*& p, const char* end) {
+    p = skipBlanks(p, end);
+    const char* start = p;
+    p = skipToken(p, end);
+    return std::string_view(start, p - start);
+}
+
+inline bool parseFloat(const char*& p, const char* end, float& value) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+') {
+        ++p;
+    }
+#if defined(__cpp_lib_to_chars)
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    p = result.ptr;
+    return true;
+#else
+    // Floating point from_chars is missing in older libc++; the token is short, so
+    // copy it out to get a terminated string for strtof.
+    char buffer[64];
+    const char* tokenEnd = skipToken(p, end);
+    size_t length = std::min<size_t>(tokenEnd - p, sizeof(buffer) - 1);
+    std::memcpy(buffer, p, length);
+    buffer[length] = '\0';
+    char* parsedEnd = nullptr;
+    value = std::strtof(buffer, &parsedEnd);
+    if (parsedEnd == buffer) {
+        return false;
+    }
+    p += parsedEnd - buffer;
+    return true;
+#endif
+}
+
+inline bool parseInt(const char*& p, const char* end, int32_t& value) {
+    if (p < end && *p == '+') {
+        ++p;
+    }
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    p = result.ptr;
+    return true;
+}
+
+// Material id for triangles whose usemtl appeared in an earlier chunk
+constexpr int32_t kInheritedMaterial = -2;
+
+// Parse error carrying the line number relative to the start of its chunk
+struct ChunkParseError : std::runtime_error {
+    ChunkParseError(const char* what, size_t line) : std::runtime_error(what), line(line) {}
+    size_t line;
+};
+
+// Result of parsing one line-aligned slice of the file. Indices are stored as they
+// will appear in the final ObjData except for the entries listed in relativeFixups.
+struct ObjChunk {
+    ObjData data;  // materialNames and triangleMaterials are chunk-local here
+    std::vector<uint32_t> relativeFixups;  // corner * 3 + component of negative (relative) indices
+    int32_t lastMaterial = kInheritedMaterial;
+};
+
+// Turns a 1-based OBJ index into 0-based. Negative indices are relative to the elements
+// seen so far; they are resolved against the chunk-local count and patched at merge.
+inline bool resolveIndex(int32_t raw, size_t localCount, int32_t& resolved, bool& relative) {
+    if (raw > 0) {
+        resolved = raw - 1;
+        relative = false;
+        return true;
+    }
+    if (raw < 0) {
+        resolved = int32_t(int64_t(localCount) + raw);
+        relative = true;
+        return true;
+    }
+    return false;
+}
+
+void parseChunk(const char* begin, const char* end, ObjChunk& chunk) {
+    ObjData& out = chunk.data;
+    size_t size = end - begin;
+
+    // Rough reservation: a typical OBJ line is 25-40 bytes
+    out.positions.reserve(size / 40 * 3);
+    out.texCoords.reserve(size / 40 * 2);
+    out.indices.reserve(size / 40 * 3);
+
+    std::unordered_map<std::string, int32_t> materialIds;
+    int32_t currentMaterial = kInheritedMaterial;
+    std::vector<ObjIndex> corners;
+    std::vector<uint8_t> cornerRelative;
+    corners.reserve(8);
+    cornerRelative.reserve(8);
+
+    const char* p = begin;
+    size_t lineNumber = 0;
+
+    while (p < end) {
+        const char* lineEnd = findLineEnd(p, end);
+        const char* next = lineEnd < end ? lineEnd + 1 : end;
+        ++lineNumber;
+        if (lineEnd > p && lineEnd[-1] == '\r') {
+            --lineEnd;
+        }
+
+        p = skipBlanks(p, lineEnd);
+        if (p == lineEnd || *p == '#') {
+            p = next;
+            continue;
+        }
+
+        const char* keywordStart = p;
+        p = skipToken(p, lineEnd);
+        std::string_view keyword(keywordStart, p - keywordStart);
+
+        if (keyword == "v") {
+            float x, y, z;
+            if (!parseFloat(p, lineEnd, x) || !parseFloat(p, lineEnd, y) || !parseFloat(p, lineEnd, z)) {
+                throw ChunkParseError("invalid vertex position", lineNumber);
+            }
+            out.positions.push_back(x);
+            out.positions.push_back(y);
+            out.positions.push_back(z);
+        } else if (keyword == "vt") {
+            float u, v = 0.0f;
+            if (!parseFloat(p, lineEnd, u)) {
+                throw ChunkParseError("invalid texture coordinate", lineNumber);
+            }
+            parseFloat(p, lineEnd, v);
+            out.texCoords.push_back(u);
+            out.texCoords.push_back(v);
+        } else if (keyword == "vn") {
+            float x, y, z;
+            if (!parseFloat(p, lineEnd, x) || !parseFloat(p, lineEnd, y) || !parseFloat(p, lineEnd, z)) {
+                throw ChunkParseError("invalid normal", lineNumber);
+            }
+            out.normals.push_back(x);
+            out.normals.push_back(y);
+            out.normals.push_back(z);
+        } else if (keyword == "f") {
+            size_t positionCount = out.positions.size() / 3;
+            size_t texCoordCount = out.texCoords.size() / 2;
+            size_t normalCount = out.normals.size() / 3;
+            bool anyRelative = false;
+
+            corners.clear();
+            cornerRelative.clear();
+            while (true) {
+                p = skipBlanks(p, lineEnd);
+                if (p == lineEnd) {
+                    break;
+                }
+
+                // v, v/vt, v//vn or v/vt/vn
+                ObjIndex corner{-1, -1, -1};
+                int32_t raw;
+                bool relative;
+                uint8_t relativeBits = 0;  // bit 0..2 = position/texCoord/normal
+                if (!parseInt(p, lineEnd, raw) || !resolveIndex(raw, positionCount, corner.position, relative)) {
+                    throw ChunkParseError("invalid face position index", lineNumber);
+                }
+                relativeBits |= relative ? 1 : 0;
+                if (p < lineEnd && *p == '/') {
+                    ++p;
+                    if (p < lineEnd && *p != '/') {
+                        if (!parseInt(p, lineEnd, raw) || !resolveIndex(raw, texCoordCount, corner.texCoord, relative)) {
+                            throw ChunkParseError("invalid face texture coordinate index", lineNumber);
+                        }
+                        relativeBits |= relative ? 2 : 0;
+                    }
+                    if (p < lineEnd && *p == '/') {
+                        ++p;
+                        if (!parseInt(p, lineEnd, raw) || !resolveIndex(raw, normalCount, corner.normal, relative)) {
+                            throw ChunkParseError("invalid face normal index", lineNumber);
+                        }
+                        relativeBits |= relative ? 4 : 0;
+                    }
+                }
+                if (p < lineEnd && !isBlank(*p)) {
+                    throw ChunkParseError("unexpected character in face", lineNumber);
+                }
+                corners.push_back(corner);
+                cornerRelative.push_back(relativeBits);
+                anyRelative |= relativeBits != 0;
+            }
+
+            // Fan triangulation: (0, i, i + 1)
+            for (size_t i = 1; i + 1 < corners.size(); i++) {
+                size_t source[3] = {0, i, i + 1};
+                for (size_t c = 0; c < 3; c++) {
+                    if (anyRelative) {
+                        for (uint32_t component = 0; component < 3; component++) {
+                            if (cornerRelative[source[c]] & (1u << component)) {
+                                chunk.relativeFixups.push_back(uint32_t(out.indices.size() * 3 + component));
+                            }
+                        }
+                    }
+                    out.indices.push_back(corners[source[c]]);
+                }
+                out.triangleMaterials.push_back(currentMaterial);
+            }
+        } else if (keyword == "usemtl") {
+            std::string name(nextToken(p, lineEnd));
+            auto it = materialIds.find(name);
+            if (it == materialIds.end()) {
+                it = materialIds.emplace(name, int32_t(out.materialNames.size())).first;
+                out.materialNames.push_back(name);
+            }
+            currentMaterial = it->second;
+        } else if (keyword == "mtllib") {
+            std::string_view library = nextToken(p, lineEnd);
+            if (!library.empty()) {
+                out.materialLibraries.emplace_back(library);
+            }
+        }
+        // o, g, s, l, p and unknown statements are ignored
+
+        p = next;
+    }
+
+    chunk.lastMaterial = currentMaterial;
+}
+
+// Formats a chunk error with its line number in the whole file
+std::string describeError(const char* data, const char* chunkBegin, const ChunkParseError& error) {
+    size_t line = std::count(data, chunkBegin, '\n') + error.line;
+    return std::string("OBJ parse error at line ") + std::to_string(line) + ": " + error.what();
+}
+
+// Concatenates chunk results in file order. Every chunk's destination offset is a prefix
+// sum over the chunks before it, so the output is identical to a single-chunk parse.
+void mergeChunks(std::vector<ObjChunk>& chunks, ObjData& out, ThreadPool* pool) {
+    size_t chunkCount = chunks.size();
+
+    std::vector<size_t> positionBase(chunkCount + 1, 0);
+    std::vector<size_t> texCoordBase(chunkCount + 1, 0);
+    std::vector<size_t> normalBase(chunkCount + 1, 0);
+    std::vector<size_t> cornerBase(chunkCount + 1, 0);
+    for (size_t k = 0; k < chunkCount; k++) {
+        const ObjData& data = chunks[k].data;
+        positionBase[k + 1] = positionBase[k] + data.positions.size();
+        texCoordBase[k + 1] = texCoordBase[k] + data.texCoords.size();
+        normalBase[k + 1] = normalBase[k] + data.normals.size();
+        cornerBase[k + 1] = cornerBase[k] + data.indices.size();
+    }
+
+    // Global material ids keep first-seen order across the whole file. Triangles before
+    // a chunk's first usemtl inherit the material active at the end of the previous chunk.
+    out = ObjData{};
+    std::unordered_map<std::string, int32_t> materialIds;
+    std::vector<std::vector<int32_t>> materialRemap(chunkCount);
+    std::vector<int32_t> inheritedMaterial(chunkCount);
+    int32_t currentMaterial = -1;
+    for (size_t k = 0; k < chunkCount; k++) {
+        ObjChunk& chunk = chunks[k];
+        inheritedMaterial[k] = currentMaterial;
+        for (const auto& name : chunk.data.materialNames) {
+            auto it = materialIds.find(name);
+            if (it == materialIds.end()) {
+                it = materialIds.emplace(name, int32_t(out.materialNames.size())).first;
+                out.materialNames.push_back(name);
+            }
+            materialRemap[k].push_back(it->second);
+        }
+        if (chunk.lastMaterial != kInheritedMaterial) {
+            currentMaterial = materialRemap[k][chunk.lastMaterial];
+        }
+        for (auto& library : chunk.data.materialLibraries) {
+            out.materialLibraries.push_back(std::move(library));
+        }
+    }
+
+    if (chunkCount == 1) {
+        ObjData& data = chunks[0].data;
+        out.positions = std::move(data.positions);
+        out.texCoords = std::move(data.texCoords);
+        out.normals = std::move(data.normals);
+        out.indices = std::move(data.indices);
+        out.triangleMaterials = std::move(data.triangleMaterials);
+    } else {
+        out.positions.resize(positionBase[chunkCount]);
+        out.texCoords.resize(texCoordBase[chunkCount]);
+        out.normals.resize(normalBase[chunkCount]);
+        out.indices.resize(cornerBase[chunkCount]);
+        out.triangleMaterials.resize(cornerBase[chunkCount] / 3);
+    }
+
+    const int64_t positionCount = int64_t(out.positions.size() / 3);
+    const int64_t texCoordCount = int64_t(out.texCoords.size() / 2);
+    const int64_t normalCount = int64_t(out.normals.size() / 3);
+
+    auto finishChunk = [&](size_t k) {
+        ObjData& data = chunks[k].data;
+        if (chunkCount > 1) {
+            std::copy(data.positions.begin(), data.positions.end(), out.positions.begin() + positionBase[k]);
+            std::copy(data.texCoords.begin(), data.texCoords.end(), out.texCoords.begin() + texCoordBase[k]);
+            std::copy(data.normals.begin(), data.normals.end(), out.normals.begin() + normalBase[k]);
+            std::copy(data.indices.begin(), data.indices.end(), out.indices.begin() + cornerBase[k]);
+            std::copy(data.triangleMaterials.begin(), data.triangleMaterials.end(),
+                      out.triangleMaterials.begin() + cornerBase[k] / 3);
+        }
+
+        ObjIndex* corners = out.indices.data() + cornerBase[k];
+        size_t cornerCount = cornerBase[k + 1] - cornerBase[k];
+
+        // Relative indices were resolved against chunk-local counts. One that still points
+        // before the first element is an error, not the -1 "absent" sentinel.
+        const int32_t componentBase[3] = {
+            int32_t(positionBase[k] / 3), int32_t(texCoordBase[k] / 2), int32_t(normalBase[k] / 3)
+        };
+        for (uint32_t fixup : chunks[k].relativeFixups) {
+            ObjIndex& corner = corners[fixup / 3];
+            int32_t* component = fixup % 3 == 0 ? &corner.position : (fixup % 3 == 1 ? &corner.texCoord : &corner.normal);
+            *component += componentBase[fixup % 3];
+            if (*component < 0) {
+                throw std::runtime_error("OBJ parse error: triangle " + std::to_string((cornerBase[k] + fixup / 3) / 3) +
+                                         " references an undefined vertex");
+            }
+        }
+
+        int32_t* materials = out.triangleMaterials.data() + cornerBase[k] / 3;
+        for (size_t i = 0; i < cornerCount / 3; i++) {
+            materials[i] = materials[i] == kInheritedMaterial ? inheritedMaterial[k] : materialRemap[k][materials[i]];
+        }
+
+        for (size_t i = 0; i < cornerCount; i++) {
+            const ObjIndex& corner = corners[i];
+            if (corner.position < 0 || corner.position >= positionCount ||
+                corner.texCoord < -1 || corner.texCoord >= texCoordCount ||
+                corner.normal < -1 || corner.normal >= normalCount) {
+                throw std::runtime_error("OBJ parse error: triangle " + std::to_string((cornerBase[k] + i) / 3) +
+                                         " references an undefined vertex");
+            }
+        }
+    };
+
+    if (pool && chunkCount > 1) {
+        pool->parallelFor(chunkCount, finishChunk);
+    } else {
+        for (size_t k = 0; k < chunkCount; k++) {
+            finishChunk(k);
+        }
+    }
+}
+
+} // namespace
+
+void parseObj(const char* data, size_t size, ObjData& out) {
+    std::vector<ObjChunk> chunks(1);
+    try {
+        parseChunk(data, data + size, chunks[0]);
+    } catch (const ChunkParseError& error) {
+        throw std::runtime_error(describeError(data, data, error));
+    }
+    mergeChunks(chunks, out, nullptr);
+}
+
+void parseObjParallel(const char* data, size_t size, ObjData& out, ThreadPool& pool, size_t minChunkSize) {
+    const char* const end = data + size;
+
+    // Several chunks per worker so faster cores pick up more of the file
+    size_t chunkCount = std::clamp<size_t>(size / std::max<size_t>(minChunkSize, 1), 1, pool.size() * 4);
+
+    std::vector<const char*> bounds{data};
+    for (size_t i = 1; i < chunkCount; i++) {
+        const char* cut = std::max(data + size * i / chunkCount, bounds.back());
+        cut = findLineEnd(cut, end);
+        bounds.push_back(cut < end ? cut + 1 : end);
+    }
+    bounds.push_back(end);
+
+    std::vector<ObjChunk> chunks(chunkCount);
+    std::vector<std::string> errors(chunkCount);
+    pool.parallelFor(chunkCount, [&](size_t k) {
+        try {
+            parseChunk(bounds[k], bounds[k + 1], chunks[k]);
+        } catch (const ChunkParseError& error) {
+            errors[k] = describeError(data, bounds[k], error);
+        }
+    });
+
+    // Report the first error in file order, matching the serial parser
+    for (const auto& error : errors) {
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+    }
+
+    mergeChunks(chunks, out, &pool);
+}
+
+std::vector<MtlMaterial> parseMtl(const char* data, size_t size) {
+    std::vector<MtlMaterial> materials;
+
+    const char* p = data;
+    const char* const bufferEnd = data + size;
+
+    while (p < bufferEnd) {
+        const char* lineEnd = findLineEnd(p, bufferEnd);
+        const char* next = lineEnd < bufferEnd ? lineEnd + 1 : bufferEnd;
+        if (lineEnd > p && lineEnd[-1] == '\r') {
+            --lineEnd;
+        }
+
+        std::string_view keyword = nextToken(p, lineEnd);
+        if (keyword == "newmtl") {
+            materials.push_back(MtlMaterial{std::string(nextToken(p, lineEnd)), {}});
+        } else if ((keyword == "map_Kd" || keyword == "map_Ka") && !materials.empty()) {
+            // The file name is the last token; anything before it is a texture option (-s, -o, ...)
+            std::string_view textureFile;
+            for (std::string_view token = nextToken(p, lineEnd); !token.empty(); token = nextToken(p, lineEnd)) {
+                textureFile = token;
+            }
+            // map_Kd wins over map_Ka
+            MtlMaterial& material = materials.back();
+            if (!textureFile.empty() && (material.diffuseTexture.empty() || keyword == "map_Kd")) {
+                material.diffuseTexture = std::string(textureFile);
+            }
+        }
+
+        p = next;
+    }
+
+    return materials;
+}
+
+std::vector<std::string> findMaterialLibraries(const char* data, size_t size) {
+    std::vector<std::string> libraries;
+
+    const char* p = data;
+    const char* const bufferEnd = data + size;
+
+    while (p < bufferEnd) {
+        const char* lineEnd = findLineEnd(p, bufferEnd);
+        const char* next = lineEnd < bufferEnd ? lineEnd + 1 : bufferEnd;
+        if (lineEnd > p && lineEnd[-1] == '\r') {
+            --lineEnd;
+        }
+
+        // Most lines are rejected on their first non-blank byte
+        p = skipBlanks(p, lineEnd);
+        if (p < lineEnd && *p == 'm' && nextToken(p, lineEnd) == "mtllib") {
+            std::string_view library = nextToken(p, lineEnd);
+            if (!library.empty()) {
+                libraries.emplace_back(library);
+            }
+        }
+
+        p = next;
+    }
+
+    return libraries;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Single-pass OBJ/MTL parser working directly on a memory buffer (asset or mmap).
+// No copies of the input are made and numbers are parsed with std::from_chars.
+
+// One face corner, already resolved to 0-based indices (-1 when absent)
+struct ObjIndex {
+    int32_t position;
+    int32_t texCoord;
+    int32_t normal;
+
+    bool operator==(const ObjIndex& other) const {
+        return position == other.position && texCoord == other.texCoord && normal == other.normal;
+    }
+};
+
+struct ObjData {
+    std::vector<float> positions;   // xyz per vertex
+    std::vector<float> texCoords;   // uv per texture coordinate
+    std::vector<float> normals;     // xyz per normal
+    std::vector<ObjIndex> indices;  // 3 corners per triangle, n-gons are fan triangulated
+    std::vector<int32_t> triangleMaterials;  // material id per triangle, -1 before the first usemtl
+    std::vector<std::string> materialNames;  // usemtl names in first-seen order (id = position)
+    std::vector<std::string> materialLibraries;  // mtllib references
+
+    size_t triangleCount() const { return triangleMaterials.size(); }
+};
+
+struct MtlMaterial {
+    std::string name;
+    std::string diffuseTexture;  // map_Kd (or map_Ka), empty if the material has none
+};
+
+class ThreadPool;
+
+// Parses an OBJ buffer into 'out' (cleared first). Throws std::runtime_error with the
+// line number on malformed input, or when a face references an undefined vertex.
+void parseObj(const char* data, size_t size, ObjData& out);
+
+// Same result as parseObj, bit for bit. The buffer is split at line boundaries into
+// chunks of at least minChunkSize bytes that are parsed on the pool and then merged
+// with prefix-summed offsets.
+void parseObjParallel(const char* data, size_t size, ObjData& out, ThreadPool& pool,
+                      size_t minChunkSize = 1 << 20);
+
+// Parses an MTL buffer, returning the materials in file order
+std::vector<MtlMaterial> parseMtl(const char* data, size_t size);
+
+// The mtllib references of an OBJ buffer, same as ObjData::materialLibraries, without
+// parsing anything else. Lets a cache key cover the MTL files before the OBJ is parsed.
+std::vector<std::string> findMaterialLibraries(const char* data, size_t size);
+
+// Returns the position of the next '\n' in [p, end), or end. Vectorized on NEON/SSE2.
+const char* findLineEnd(const char* p, const char* end);
@@ -0,0 +1,205 @@
+#include "StagingRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+StagingRing::StagingRing(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamilyIndex,
+                         VkDeviceSize blockSize, uint32_t blockCount)
+    : device(device), queue(queue), blockBytes(blockSize) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = blockSize * blockCount;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create staging ring buffer!");
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, buffer, &requirements);
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    const VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    uint32_t memoryType = UINT32_MAX;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((requirements.memoryTypeBits & (1u << i)) &&
+            (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            memoryType = i;
+            break;
+        }
+    }
+    if (memoryType == UINT32_MAX) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        throw std::runtime_error("failed to find staging ring memory type!");
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = memoryType;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        throw std::runtime_error("failed to allocate staging ring memory!");
+    }
+    vkBindBufferMemory(device, buffer, memory, 0);
+    void* data;
+    vkMapMemory(device, memory, 0, bufferInfo.size, 0, &data);
+    mapped = static_cast<uint8_t*>(data);
+
+    // Own pool, so recording here never races the renderer's per-frame command buffers
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create staging ring command pool!");
+    }
+
+    commandBuffers.resize(blockCount);
+    VkCommandBufferAllocateInfo commandInfo{};
+    commandInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandInfo.commandPool = commandPool;
+    commandInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandInfo.commandBufferCount = blockCount;
+    if (vkAllocateCommandBuffers(device, &commandInfo, commandBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate staging ring command buffers!");
+    }
+
+    fences.resize(blockCount, VK_NULL_HANDLE);
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    for (uint32_t i = 0; i < blockCount; i++) {
+        if (vkCreateFence(device, &fenceInfo, nullptr, &fences[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create staging ring fence!");
+        }
+    }
+
+    // Handed out lowest index first
+    for (uint32_t i = blockCount; i > 0; i--) {
+        freeBlocks.push_back(i - 1);
+    }
+}
+
+StagingRing::~StagingRing() {
+    cancel();
+    for (const Copy& copy : inFlight) {
+        vkWaitForFences(device, 1, &fences[copy.block], VK_TRUE, UINT64_MAX);
+    }
+    for (VkFence fence : fences) {
+        if (fence != VK_NULL_HANDLE) vkDestroyFence(device, fence, nullptr);
+    }
+    if (commandPool != VK_NULL_HANDLE) vkDestroyCommandPool(device, commandPool, nullptr);
+    if (buffer != VK_NULL_HANDLE) vkDestroyBuffer(device, buffer, nullptr);
+    if (memory != VK_NULL_HANDLE) vkFreeMemory(device, memory, nullptr);
+}
+
+bool StagingRing::acquire(Block& block) {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this]() { return cancelled || !freeBlocks.empty(); });
+    if (cancelled) {
+        return false;
+    }
+    block.index = freeBlocks.back();
+    block.data = mapped + block.index * blockBytes;
+    freeBlocks.pop_back();
+    acquiredCount++;
+    return true;
+}
+
+void StagingRing::submit(const Block& block, VkBuffer destination, VkDeviceSize destinationOffset, VkDeviceSize size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    acquiredCount--;
+    filled.push_back(Copy{block.index, destination, destinationOffset, std::min(size, blockBytes)});
+}
+
+bool StagingRing::upload(const void* data, VkDeviceSize size, VkBuffer destination, VkDeviceSize destinationOffset) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (VkDeviceSize offset = 0; offset < size; offset += blockBytes) {
+        Block block;
+        if (!acquire(block)) {
+            return false;
+        }
+        VkDeviceSize chunk = std::min(blockBytes, size - offset);
+        memcpy(block.data, bytes + offset, (size_t)chunk);
+        submit(block, destination, destinationOffset + offset, chunk);
+    }
+    return true;
+}
+
+void StagingRing::pump() {
+    std::deque<Copy> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(filled);
+    }
+
+    // The producer does not touch a block between submit and recycle, so its command
+    // buffer can be recorded without the lock
+    for (const Copy& copy : ready) {
+        VkCommandBuffer commandBuffer = commandBuffers[copy.block];
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        VkBufferCopy region{};
+        region.srcOffset = copy.block * blockBytes;
+        region.dstOffset = copy.offset;
+        region.size = copy.size;
+        vkCmdCopyBuffer(commandBuffer, buffer, copy.destination, 1, &region);
+
+        // Later submissions may read the data from any stage once the fence says it landed
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             1, &barrier, 0, nullptr, 0, nullptr);
+        vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        if (vkQueueSubmit(queue, 1, &submitInfo, fences[copy.block]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit staging copy!");
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    inFlight.insert(inFlight.end(), ready.begin(), ready.end());
+
+    // Copies retire in submission order, which keeps landed() contiguous
+    bool recycled = false;
+    while (!inFlight.empty() && vkGetFenceStatus(device, fences[inFlight.front().block]) == VK_SUCCESS) {
+        const Copy& copy = inFlight.front();
+        VkDeviceSize& landedEnd = landedBytes[copy.destination];
+        landedEnd = std::max(landedEnd, copy.offset + copy.size);
+        vkResetFences(device, 1, &fences[copy.block]);
+        vkResetCommandBuffer(commandBuffers[copy.block], 0);
+        freeBlocks.push_back(copy.block);
+        inFlight.pop_front();
+        recycled = true;
+    }
+    if (recycled) {
+        condition.notify_all();
+    }
+}
+
+VkDeviceSize StagingRing::landed(VkBuffer destination) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = landedBytes.find(destination);
+    return it == landedBytes.end() ? 0 : it->second;
+}
+
+bool StagingRing::idle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return acquiredCount == 0 && filled.empty() && inFlight.empty();
+}
+
+void StagingRing::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelled = true;
+    condition.notify_all();
+}
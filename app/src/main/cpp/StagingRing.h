@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Persistently mapped staging buffer cut into fixed-size blocks, for streaming uploads.
+// A producer (any thread) acquires a free block, fills it and submits it with a
+// destination; the thread that owns the queue calls pump() between frames to record the
+// copies and recycle blocks whose fence has signalled. Nothing waits on the queue, so
+// filling the next block overlaps the transfer of the previous one.
+class StagingRing {
+public:
+    struct Block {
+        uint32_t index = 0;
+        void* data = nullptr;
+    };
+
+    StagingRing(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamilyIndex,
+                VkDeviceSize blockSize = 1 << 20, uint32_t blockCount = 8);
+    ~StagingRing();
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    VkDeviceSize blockSize() const { return blockBytes; }
+
+    // Producer side. acquire blocks until a block is free and returns false once the
+    // ring is cancelled; every acquired block must be submitted.
+    bool acquire(Block& block);
+    void submit(const Block& block, VkBuffer destination, VkDeviceSize destinationOffset, VkDeviceSize size);
+    // Streams size bytes to destination, one block at a time
+    bool upload(const void* data, VkDeviceSize size, VkBuffer destination, VkDeviceSize destinationOffset = 0);
+
+    // Queue side: submits filled blocks and recycles the finished ones, never blocks
+    void pump();
+
+    // Bytes of destination, counted from its start, whose copies have completed. Blocks
+    // for one buffer are expected in offset order with no gaps.
+    VkDeviceSize landed(VkBuffer destination) const;
+
+    // No block is filled, waiting or in flight
+    bool idle() const;
+
+    // Wakes blocked producers; acquire fails from now on
+    void cancel();
+
+private:
+    struct Copy {
+        uint32_t block;
+        VkBuffer destination;
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    VkDevice device;
+    VkQueue queue;
+    VkDeviceSize blockBytes;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    uint8_t* mapped = nullptr;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> commandBuffers;  // per block
+    std::vector<VkFence> fences;                  // per block
+
+    std::vector<uint32_t> freeBlocks;
+    std::deque<Copy> filled;    // submitted by the producer, not yet on the queue
+    std::deque<Copy> inFlight;  // on the queue, in submission order
+    std::unordered_map<VkBuffer, VkDeviceSize> landedBytes;
+    uint32_t acquiredCount = 0;
+    bool cancelled = false;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+};
@@ -0,0 +1,224 @@
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+TaskGraph::TaskGraph(ThreadPool& pool) : pool(pool) {}
+
+TaskGraph::~TaskGraph() {
+    // Queued worker tasks point at this graph
+    cancel();
+}
+
+TaskGraph::TaskId TaskGraph::add(const std::string& name, Affinity affinity, std::function<void()> body,
+                                 const std::vector<TaskId>& dependencies) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (started) {
+        throw std::logic_error("TaskGraph: cannot add " + name + " after start()");
+    }
+
+    TaskId id = tasks.size();
+    Task task;
+    task.name = name;
+    task.affinity = affinity;
+    task.body = std::move(body);
+    for (TaskId dependency : dependencies) {
+        if (dependency >= id) {
+            throw std::logic_error("TaskGraph: " + name + " depends on a task that was not added yet");
+        }
+        tasks[dependency].dependents.push_back(id);
+        task.remainingDependencies++;
+    }
+    tasks.push_back(std::move(task));
+    return id;
+}
+
+void TaskGraph::start() {
+    std::unique_lock<std::mutex> lock(mutex);
+    started = true;
+    startTime = std::chrono::steady_clock::now();
+    for (TaskId id = 0; id < tasks.size(); id++) {
+        if (tasks[id].remainingDependencies == 0) {
+            makeReady(id, lock);
+        }
+    }
+}
+
+void TaskGraph::makeReady(TaskId id, std::unique_lock<std::mutex>& lock) {
+    Task& task = tasks[id];
+    // After a failure or cancel nothing new starts; skipping cascades to dependents
+    if (cancelled || failure) {
+        complete(id, false, lock);
+        return;
+    }
+
+    task.state = State::Queued;
+    if (task.affinity == Affinity::Worker) {
+        workersInFlight++;
+        pool.submit([this, id]() { execute(id); });
+    } else {
+        mainQueue.push_back(id);
+        condition.notify_all();
+    }
+}
+
+void TaskGraph::execute(TaskId id) {
+    std::unique_lock<std::mutex> lock(mutex);
+    Task& task = tasks[id];
+    bool worker = task.affinity == Affinity::Worker;
+
+    bool success = false;
+    if (!cancelled && !failure) {
+        task.state = State::Running;
+        task.startMs = elapsedMs();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            task.body();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        task.durationMs = elapsedMs() - task.startMs;
+        if (error && !failure) {
+            failure = error;
+        }
+        success = !error;
+    }
+
+    complete(id, success, lock);
+    if (worker) {
+        workersInFlight--;
+        condition.notify_all();
+    }
+}
+
+void TaskGraph::complete(TaskId id, bool success, std::unique_lock<std::mutex>& lock) {
+    Task& task = tasks[id];
+    task.state = success ? State::Done : State::Skipped;
+    task.body = nullptr;
+    finishedCount++;
+
+    for (TaskId dependent : task.dependents) {
+        if (--tasks[dependent].remainingDependencies == 0) {
+            makeReady(dependent, lock);
+        }
+    }
+    condition.notify_all();
+}
+
+bool TaskGraph::runOneMainTask(std::unique_lock<std::mutex>& lock) {
+    if (mainQueue.empty()) {
+        return false;
+    }
+    TaskId id = mainQueue.front();
+    mainQueue.erase(mainQueue.begin());
+
+    lock.unlock();
+    execute(id);
+    lock.lock();
+    return true;
+}
+
+void TaskGraph::rethrowFailure() {
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = failure;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGraph::runMainTasks() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (runOneMainTask(lock)) {
+        }
+    }
+    rethrowFailure();
+}
+
+void TaskGraph::runUntil(TaskId task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (tasks[task].state != State::Done && tasks[task].state != State::Skipped) {
+            if (!runOneMainTask(lock)) {
+                condition.wait(lock);
+            }
+        }
+    }
+    rethrowFailure();
+}
+
+void TaskGraph::wait() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (finishedCount < tasks.size()) {
+            if (!runOneMainTask(lock)) {
+                condition.wait(lock);
+            }
+        }
+    }
+    rethrowFailure();
+}
+
+bool TaskGraph::isDone(TaskId task) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks[task].state == State::Done;
+}
+
+bool TaskGraph::finished() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finishedCount == tasks.size();
+}
+
+void TaskGraph::cancel() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!started) {
+        return;
+    }
+    cancelled = true;
+
+    std::vector<TaskId> queued;
+    queued.swap(mainQueue);
+    for (TaskId id : queued) {
+        complete(id, false, lock);
+    }
+
+    condition.wait(lock, [this]() { return workersInFlight == 0; });
+}
+
+std::string TaskGraph::timingReport() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<const Task*> ran;
+    double endMs = 0.0;
+    for (const Task& task : tasks) {
+        if (task.state == State::Done) {
+            ran.push_back(&task);
+            endMs = std::max(endMs, task.startMs + task.durationMs);
+        }
+    }
+    std::sort(ran.begin(), ran.end(), [](const Task* a, const Task* b) { return a->startMs < b->startMs; });
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    for (const Task* task : ran) {
+        report << "  " << std::left << std::setw(18) << task->name << std::right
+               << " +" << std::setw(7) << task->startMs << " ms " << std::setw(7) << task->durationMs << " ms  "
+               << (task->affinity == Affinity::Worker ? "worker" : "main") << "\n";
+    }
+    report << "  total " << endMs << " ms, " << ran.size() << "/" << tasks.size() << " tasks";
+    return report.str();
+}
+
+double TaskGraph::elapsedMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Dependency graph of one-shot tasks. Worker tasks go to the ThreadPool as soon as
+// their dependencies finish; main tasks (anything touching the Vulkan queue or
+// command pool) are only run by the thread calling runMainTasks / runUntil / wait.
+// Every task is timed for the startup breakdown.
+class TaskGraph {
+public:
+    using TaskId = size_t;
+
+    enum class Affinity {
+        Worker,
+        Main
+    };
+
+    explicit TaskGraph(ThreadPool& pool);
+    ~TaskGraph();
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    // Dependencies must have been added before; tasks cannot be added after start()
+    TaskId add(const std::string& name, Affinity affinity, std::function<void()> body,
+               const std::vector<TaskId>& dependencies = {});
+
+    // Submits the worker tasks that have no dependencies
+    void start();
+
+    // Runs the main tasks that are ready right now, without blocking. Rethrows the
+    // first exception of any task.
+    void runMainTasks();
+
+    // Runs main tasks and blocks until the given task is done
+    void runUntil(TaskId task);
+
+    // Runs main tasks and blocks until every task is done
+    void wait();
+
+    bool isDone(TaskId task) const;
+    bool finished() const;
+
+    // Stops tasks that have not started yet and waits for the running worker tasks
+    void cancel();
+
+    // One line per task: start offset, duration and thread, in start order
+    std::string timingReport() const;
+
+private:
+    enum class State {
+        Pending,
+        Queued,
+        Running,
+        Done,
+        Skipped
+    };
+
+    struct Task {
+        std::string name;
+        Affinity affinity;
+        std::function<void()> body;
+        std::vector<TaskId> dependents;
+        size_t remainingDependencies = 0;
+        State state = State::Pending;
+        double startMs = 0.0;
+        double durationMs = 0.0;
+    };
+
+    void execute(TaskId id);
+    void makeReady(TaskId id, std::unique_lock<std::mutex>& lock);
+    void complete(TaskId id, bool success, std::unique_lock<std::mutex>& lock);
+    bool runOneMainTask(std::unique_lock<std::mutex>& lock);
+    void rethrowFailure();
+    double elapsedMs() const;
+
+    ThreadPool& pool;
+    std::vector<Task> tasks;
+    std::vector<TaskId> mainQueue;
+    size_t finishedCount = 0;
+    size_t workersInFlight = 0;
+    bool started = false;
+    bool cancelled = false;
+    std::exception_ptr failure;
+    std::chrono::steady_clock::time_point startTime;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+};
@@ -0,0 +1,237 @@
+#include "TexturePacker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+uint32_t roundUp(uint32_t value, uint32_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+uint32_t fullMipChain(uint32_t width, uint32_t height) {
+    return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+// Tile of an atlas texture: the texture and its gutter, rounded up to whole blocks of
+// the coarsest kept level (gutter texels wide)
+uint32_t tileExtent(uint32_t extent, uint32_t gutter) {
+    return roundUp(extent + 2 * gutter, gutter);
+}
+
+struct Shelf {
+    uint32_t layer;
+    uint32_t y;
+    uint32_t height;
+    uint32_t used;
+};
+
+// Shelf packing of the tiles in order; returns the pages needed for a pageWidth wide
+// layout whose pages are at most maxHeight tall, and the height of the tallest
+uint32_t packShelves(const std::vector<size_t>& order, const std::vector<TexturePackInput>& textures,
+                     uint32_t gutter, uint32_t pageWidth, uint32_t maxHeight, std::vector<TexturePlacement>& placements,
+                     uint32_t& usedHeight) {
+    std::vector<Shelf> shelves;
+    uint32_t pages = 1;
+    uint32_t pageTop = 0;  // where the next shelf of the current page starts
+    usedHeight = 0;
+    for (size_t index : order) {
+        const uint32_t width = tileExtent(textures[index].width, gutter);
+        const uint32_t height = tileExtent(textures[index].height, gutter);
+        // Tiles arrive tallest first, so any open shelf of the current page is tall enough
+        Shelf* shelf = nullptr;
+        for (Shelf& candidate : shelves) {
+            if (candidate.layer == pages - 1 && candidate.used + width <= pageWidth) {
+                shelf = &candidate;
+                break;
+            }
+        }
+        if (!shelf) {
+            if (pageTop + height > maxHeight) {
+                pages++;
+                pageTop = 0;
+            }
+            shelves.push_back({pages - 1, pageTop, height, 0});
+            pageTop += height;
+            usedHeight = std::max(usedHeight, pageTop);
+            shelf = &shelves.back();
+        }
+        placements[index] = {shelf->layer, shelf->used + gutter, shelf->y + gutter};
+        shelf->used += width;
+    }
+    return pages;
+}
+
+TexturePack packArray(const std::vector<TexturePackInput>& textures, uint32_t maxLayers) {
+    TexturePack pack;
+    for (const TexturePackInput& texture : textures) {
+        if (!texture.present) {
+            continue;
+        }
+        if (pack.layers == 0) {
+            pack.width = texture.width;
+            pack.height = texture.height;
+            pack.format = texture.format;
+            pack.mipLevels = texture.levels > 0 ? texture.levels : fullMipChain(texture.width, texture.height);
+        } else if (texture.width != pack.width || texture.height != pack.height || texture.format != pack.format ||
+                   (texture.levels > 0 ? texture.levels : fullMipChain(texture.width, texture.height)) !=
+                           pack.mipLevels) {
+            return {};
+        }
+        pack.layers++;
+    }
+    if (pack.layers == 0 || pack.layers > maxLayers) {
+        return {};
+    }
+
+    pack.mode = TexturePackMode::Array;
+    pack.placements.resize(textures.size());
+    pack.rects.resize(textures.size());
+    uint32_t layer = 0;
+    for (size_t i = 0; i < textures.size(); i++) {
+        if (textures[i].present) {
+            pack.placements[i].layer = layer;
+            pack.rects[i].layer = static_cast<float>(layer++);
+        }
+    }
+    return pack;
+}
+
+TexturePack packAtlas(const std::vector<TexturePackInput>& textures, uint32_t rgba8Format, uint32_t maxExtent,
+                      uint32_t maxLayers, uint32_t atlasMipLevels) {
+    TexturePack pack;
+    pack.format = rgba8Format;
+    pack.mipLevels = std::max(atlasMipLevels, 1u);
+    pack.gutter = 1u << (pack.mipLevels - 1);
+
+    std::vector<size_t> order;
+    uint32_t widest = pack.gutter;
+    for (size_t i = 0; i < textures.size(); i++) {
+        const TexturePackInput& texture = textures[i];
+        if (!texture.present) {
+            continue;
+        }
+        if (texture.format != rgba8Format || texture.levels > 0) {
+            return {};
+        }
+        const uint32_t width = tileExtent(texture.width, pack.gutter);
+        const uint32_t height = tileExtent(texture.height, pack.gutter);
+        if (width > maxExtent || height > maxExtent) {
+            return {};
+        }
+        widest = std::max(widest, width);
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return textures[a].height > textures[b].height;
+    });
+
+    // Page width, in whole blocks, with the fewest texels over all pages; pages are at
+    // most maxExtent tall and as tall as their tallest use
+    const uint32_t maxWidth = maxExtent / pack.gutter * pack.gutter;
+    std::vector<TexturePlacement> placements(textures.size());
+    uint64_t bestTexels = UINT64_MAX;
+    uint32_t pages = 0;
+    for (uint32_t width = widest; width <= maxWidth; width += pack.gutter) {
+        std::vector<TexturePlacement> candidate(textures.size());
+        uint32_t usedHeight = 0;
+        const uint32_t candidatePages = packShelves(order, textures, pack.gutter, width, maxWidth, candidate,
+                                                    usedHeight);
+        const uint64_t texels = uint64_t(width) * usedHeight * candidatePages;
+        if (texels < bestTexels) {
+            bestTexels = texels;
+            pack.width = width;
+            pack.height = std::max(usedHeight, pack.gutter);
+            pages = candidatePages;
+            placements = std::move(candidate);
+        }
+        // Wider pages only add empty texels once everything sits on a single shelf
+        if (candidatePages == 1 && usedHeight == tileExtent(textures[order.front()].height, pack.gutter)) {
+            break;
+        }
+    }
+    if (pages > maxLayers) {
+        return {};
+    }
+
+    pack.mode = TexturePackMode::Atlas;
+    pack.layers = pages;
+    // No level below a single block, which would mix tiles again
+    pack.mipLevels = std::min(pack.mipLevels, fullMipChain(pack.width, pack.height));
+    pack.placements = std::move(placements);
+    pack.rects.resize(textures.size());
+    for (size_t i : order) {
+        const TexturePlacement& placement = pack.placements[i];
+        TextureRect& rect = pack.rects[i];
+        rect.scale[0] = static_cast<float>(textures[i].width) / pack.width;
+        rect.scale[1] = static_cast<float>(textures[i].height) / pack.height;
+        rect.bias[0] = static_cast<float>(placement.x) / pack.width;
+        rect.bias[1] = static_cast<float>(placement.y) / pack.height;
+        rect.layer = static_cast<float>(placement.layer);
+    }
+    return pack;
+}
+
+} // namespace
+
+double TexturePack::usage(const std::vector<TexturePackInput>& textures) const {
+    uint64_t used = 0;
+    for (const TexturePackInput& texture : textures) {
+        if (texture.present) {
+            used += uint64_t(texture.width) * texture.height;
+        }
+    }
+    const uint64_t total = uint64_t(width) * height * layers;
+    return total > 0 ? static_cast<double>(used) / static_cast<double>(total) : 0.0;
+}
+
+TexturePack planTexturePack(const std::vector<TexturePackInput>& textures, uint32_t rgba8Format, uint32_t maxExtent,
+                            uint32_t maxLayers, uint32_t atlasMipLevels) {
+    bool anyPresent = false;
+    for (const TexturePackInput& texture : textures) {
+        anyPresent = anyPresent || texture.present;
+    }
+    if (!anyPresent) {
+        // Nothing to sample: a single white layer keeps the descriptor valid
+        TexturePack pack;
+        pack.mode = TexturePackMode::Array;
+        pack.width = 1;
+        pack.height = 1;
+        pack.layers = 1;
+        pack.format = rgba8Format;
+        pack.placements.resize(textures.size());
+        pack.rects.resize(textures.size());
+        return pack;
+    }
+
+    TexturePack pack = packArray(textures, maxLayers);
+    if (pack.mode == TexturePackMode::None) {
+        pack = packAtlas(textures, rgba8Format, maxExtent, maxLayers, atlasMipLevels);
+    }
+    return pack;
+}
+
+void copyIntoAtlas(const TexturePack& pack, const TexturePlacement& placement, const uint8_t* pixels,
+                   uint32_t width, uint32_t height, uint8_t* page) {
+    // The whole tile is written, including the rounding past the gutter, so every block
+    // of the coarser levels only averages texels of this texture
+    const int64_t gutter = pack.gutter;
+    const int64_t tileWidth = tileExtent(width, pack.gutter);
+    const int64_t tileHeight = tileExtent(height, pack.gutter);
+    const size_t rowBytes = size_t(width) * 4;
+    for (int64_t y = -gutter; y < tileHeight - gutter; y++) {
+        const uint8_t* source = pixels + size_t(((y % height) + height) % height) * rowBytes;
+        uint8_t* row = page + (size_t(placement.y + y) * pack.width + (placement.x - gutter)) * 4;
+        for (int64_t x = -gutter; x < tileWidth - gutter; x++) {
+            if (x == 0) {
+                std::memcpy(row, source, rowBytes);
+                row += rowBytes;
+                x += width - 1;
+                continue;
+            }
+            std::memcpy(row, source + size_t(((x % width) + width) % width) * 4, 4);
+            row += 4;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packs the textures of a scene into the layers of one 2D array image, so a frame binds
+// one image view and one sampler however many materials there are. Textures of the same
+// size and format each take a whole layer; mixed sizes are placed into atlas pages with
+// a gutter around every tile. The fragment shader finds a texture through its
+// TextureRect: fract(uv) * scale + bias in the given layer.
+
+enum class TexturePackMode {
+    None,   // the textures cannot share an image (compressed formats of different sizes)
+    Array,  // one texture per layer, each filling it
+    Atlas,  // RGBA8 tiles on shared pages
+};
+
+struct TexturePackInput {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;     // VkFormat value; atlases only take RGBA8
+    uint32_t levels = 0;     // pre-encoded mip levels, 0 when the chain is built on upload
+    bool present = false;    // missing textures get no layer and draw white
+};
+
+// std430 entry of the texture table the packed fragment shader reads (binding 2)
+struct TextureRect {
+    float scale[2] = {1.0f, 1.0f};
+    float bias[2] = {0.0f, 0.0f};
+    float layer = -1.0f;     // negative for a missing texture
+    float padding[3] = {};
+};
+static_assert(sizeof(TextureRect) == 32, "TextureRect must match the shader's struct");
+
+// Where level 0 of a texture lands in the image, in texels
+struct TexturePlacement {
+    uint32_t layer = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+};
+
+struct TexturePack {
+    TexturePackMode mode = TexturePackMode::None;
+    uint32_t width = 0;      // of every layer
+    uint32_t height = 0;
+    uint32_t layers = 0;
+    uint32_t format = 0;
+    uint32_t mipLevels = 1;  // most levels the layout keeps apart; see atlasMipLevels
+    uint32_t gutter = 0;     // texels of wrapped border around each atlas tile
+    std::vector<TexturePlacement> placements;  // one per input, unused for missing ones
+    std::vector<TextureRect> rects;            // one per input
+
+    // Share of the texels that belong to a texture, for the log
+    double usage(const std::vector<TexturePackInput>& textures) const;
+};
+
+// Array mode when every present texture has the same size, format and level count,
+// otherwise an atlas of RGBA8 textures. Atlas tiles sit on multiples of
+// 2^(atlasMipLevels - 1) texels with a gutter that wide, so the first atlasMipLevels
+// levels of a box-filtered chain never mix two textures, and pages are at most
+// maxExtent square. Returns mode None when neither fits within maxLayers.
+TexturePack planTexturePack(const std::vector<TexturePackInput>& textures, uint32_t rgba8Format,
+                            uint32_t maxExtent, uint32_t maxLayers, uint32_t atlasMipLevels);
+
+// Writes an RGBA8 texture into its atlas tile of page (pack.width texels per row), the
+// gutter filled with the texels a repeating sampler would read past each edge
+void copyIntoAtlas(const TexturePack& pack, const TexturePlacement& placement, const uint8_t* pixels,
+                   uint32_t width, uint32_t height, uint8_t* page);
@@ -0,0 +1,102 @@
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <numeric>
+
+TextureResidency::TextureResidency(uint32_t textureCount, uint64_t budget)
+        : textures(textureCount), budgetBytes(budget) {}
+
+uint64_t TextureResidency::bytesFrom(const Texture& texture, uint32_t level) const {
+    if (level >= texture.levelBytes.size()) {
+        return 0;  // Evicted
+    }
+    return std::accumulate(texture.levelBytes.begin() + level, texture.levelBytes.end(), uint64_t(0));
+}
+
+void TextureResidency::setResident(uint32_t texture, const std::vector<uint64_t>& levelBytes, uint32_t firstLevel) {
+    Texture& entry = textures[texture];
+    resident -= bytesFrom(entry, entry.firstLevel);
+    total -= bytesFrom(entry, 0);
+    entry.levelBytes = levelBytes;
+    entry.firstLevel = firstLevel;
+    entry.loading = false;
+    resident += bytesFrom(entry, entry.firstLevel);
+    total += bytesFrom(entry, 0);
+}
+
+void TextureResidency::markUsed(uint32_t texture, uint64_t frame) {
+    Texture& entry = textures[texture];
+    entry.lastUsed = std::max(entry.lastUsed, frame);
+    // Textures still waiting for their first upload have no sizes yet
+    if (entry.firstLevel != 0 && !entry.levelBytes.empty() && !entry.queued && !entry.loading) {
+        entry.queued = true;
+        wanted.push_back(texture);
+    }
+}
+
+std::vector<uint32_t> TextureResidency::takeReloads() {
+    std::vector<uint32_t> reloads;
+    reloads.swap(wanted);
+    for (uint32_t texture : reloads) {
+        textures[texture].queued = false;
+        textures[texture].loading = true;
+    }
+    reloadCount += reloads.size();
+    return reloads;
+}
+
+std::vector<TextureResidency::Trim> TextureResidency::planTrims(uint64_t idleSince, uint64_t minLevelBytes,
+                                                                size_t maxTrims) {
+    std::vector<Trim> trims;
+    if (resident <= budgetBytes) {
+        return trims;
+    }
+
+    std::vector<uint32_t> idle;
+    for (uint32_t texture = 0; texture < textures.size(); texture++) {
+        const Texture& entry = textures[texture];
+        if (entry.firstLevel != kEvicted && entry.lastUsed < idleSince && !entry.loading) {
+            idle.push_back(texture);
+        }
+    }
+    std::stable_sort(idle.begin(), idle.end(),
+                     [&](uint32_t a, uint32_t b) { return textures[a].lastUsed < textures[b].lastUsed; });
+
+    // Top levels first: the texture stays drawable, only blurrier
+    for (uint32_t texture : idle) {
+        if (resident <= budgetBytes || trims.size() >= maxTrims) {
+            return trims;
+        }
+        Texture& entry = textures[texture];
+        uint32_t level = entry.firstLevel;
+        while (resident > budgetBytes && level + 1 < entry.levelBytes.size() &&
+               entry.levelBytes[level] > minLevelBytes) {
+            resident -= entry.levelBytes[level];
+            level++;
+        }
+        if (level != entry.firstLevel) {
+            entry.firstLevel = level;
+            trims.push_back({texture, level});
+        }
+    }
+
+    // Then whole textures; a trim planned above turns into the eviction
+    for (uint32_t texture : idle) {
+        if (resident <= budgetBytes) {
+            break;
+        }
+        Texture& entry = textures[texture];
+        auto planned = std::find_if(trims.begin(), trims.end(), [&](const Trim& trim) { return trim.texture == texture; });
+        if (planned == trims.end() && trims.size() >= maxTrims) {
+            continue;
+        }
+        resident -= bytesFrom(entry, entry.firstLevel);
+        entry.firstLevel = kEvicted;
+        if (planned != trims.end()) {
+            planned->firstLevel = kEvicted;
+        } else {
+            trims.push_back({texture, kEvicted});
+        }
+    }
+    return trims;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Keeps the images of the per-texture path under a memory budget. Every texture knows
+// the bytes of each level of its full chain, which of them its image holds, and the
+// frame a draw last sampled it. Over budget, textures no draw has touched for a while
+// give up their top levels first, least recently used first, and are evicted outright
+// only when that is not enough; drawing a texture that is not whole queues it to be
+// loaded again. Main thread only; the renderer does the image work the plans describe.
+class TextureResidency {
+public:
+    // firstLevel of a texture without an image
+    static constexpr uint32_t kEvicted = UINT32_MAX;
+
+    struct Trim {
+        uint32_t texture;
+        uint32_t firstLevel;  // of the full chain, or kEvicted
+    };
+
+    TextureResidency(uint32_t textureCount, uint64_t budget);
+
+    uint64_t budget() const { return budgetBytes; }
+    void setBudget(uint64_t bytes) { budgetBytes = bytes; }
+
+    // texture's image now holds levels firstLevel.. of a chain with levelBytes per level
+    void setResident(uint32_t texture, const std::vector<uint64_t>& levelBytes, uint32_t firstLevel = 0);
+    // Levels of texture's full chain
+    uint32_t levelCount(uint32_t texture) const { return static_cast<uint32_t>(textures[texture].levelBytes.size()); }
+
+    // A draw of frame sampled texture; a texture that is not whole and not loading is
+    // queued for takeReloads()
+    void markUsed(uint32_t texture, uint64_t frame);
+    // Queued textures, now marked loading until their next setResident()
+    std::vector<uint32_t> takeReloads();
+
+    // At most maxTrims steps that bring the resident bytes under budget, taken from
+    // textures last used before idleSince. A trimmed texture keeps its levels of at
+    // most minLevelBytes; one whose largest remaining level is already that small is
+    // evicted. The plans are already counted; the renderer must carry them out.
+    std::vector<Trim> planTrims(uint64_t idleSince, uint64_t minLevelBytes, size_t maxTrims);
+
+    uint64_t residentBytes() const { return resident; }
+    // Bytes of the full chains that are not resident
+    uint64_t evictedBytes() const { return total - resident; }
+    uint64_t reloads() const { return reloadCount; }
+
+private:
+    struct Texture {
+        std::vector<uint64_t> levelBytes;
+        uint32_t firstLevel = kEvicted;
+        uint64_t lastUsed = 0;
+        bool queued = false;
+        bool loading = false;
+    };
+
+    uint64_t bytesFrom(const Texture& texture, uint32_t level) const;
+
+    std::vector<Texture> textures;
+    std::vector<uint32_t> wanted;
+    uint64_t budgetBytes;
+    uint64_t resident = 0;
+    uint64_t total = 0;
+    uint64_t reloadCount = 0;
+};
@@ -0,0 +1,102 @@
+#include "TextureStagingRing.h"
+
+#include <stdexcept>
+
+TextureStagingRing::TextureStagingRing(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize size)
+    : device(device), capacity(size) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &stagingBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture staging buffer!");
+    }
+
+    // Decoders read back what they wrote (PNG filters use the row above), so cached
+    // memory is preferred; write-combined memory would make that slow
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, stagingBuffer, &requirements);
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    const VkMemoryPropertyFlags required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    uint32_t memoryType = UINT32_MAX;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        const VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+        if (!(requirements.memoryTypeBits & (1u << i)) || (flags & required) != required) {
+            continue;
+        }
+        if (memoryType == UINT32_MAX || (flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT)) {
+            memoryType = i;
+        }
+        if (flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) {
+            break;
+        }
+    }
+    if (memoryType == UINT32_MAX) {
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        throw std::runtime_error("failed to find texture staging memory type!");
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = memoryType;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        throw std::runtime_error("failed to allocate texture staging memory!");
+    }
+    vkBindBufferMemory(device, stagingBuffer, memory, 0);
+    void* data;
+    vkMapMemory(device, memory, 0, size, 0, &data);
+    mapped = static_cast<uint8_t*>(data);
+}
+
+TextureStagingRing::~TextureStagingRing() {
+    if (stagingBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, stagingBuffer, nullptr);
+    if (memory != VK_NULL_HANDLE) vkFreeMemory(device, memory, nullptr);
+}
+
+uint8_t* TextureStagingRing::allocate(VkDeviceSize size) {
+    size = (size + kAlignment - 1) & ~(kAlignment - 1);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (size == 0 || size > capacity) {
+        return nullptr;
+    }
+
+    VkDeviceSize offset = 0;
+    if (!ranges.empty()) {
+        const VkDeviceSize head = ranges.front().offset;
+        const VkDeviceSize tail = ranges.back().offset + ranges.back().size;
+        if (tail > head) {
+            // Free space after the newest range, then before the oldest
+            if (tail + size <= capacity) {
+                offset = tail;
+            } else if (size <= head) {
+                offset = 0;
+            } else {
+                return nullptr;
+            }
+        } else if (tail + size <= head) {
+            offset = tail;  // Wrapped: only the gap up to the oldest range is free
+        } else {
+            return nullptr;
+        }
+    }
+    ranges.push_back({offset, size, false});
+    return mapped + offset;
+}
+
+void TextureStagingRing::release(const void* data) {
+    const VkDeviceSize offset = offsetOf(data);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Range& range : ranges) {
+        if (range.offset == offset && !range.released) {
+            range.released = true;
+            break;
+        }
+    }
+    while (!ranges.empty() && ranges.front().released) {
+        ranges.pop_front();
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+// Persistently mapped staging buffer that texture decoders write into directly, so an
+// upload copies from where the pixels were decoded. Workers take ranges of any size;
+// each goes back once the copy out of it has completed. Ranges are handed out in ring
+// order and space is reclaimed from the oldest, so a range released early waits for
+// the ones before it. allocate() never blocks: with no room the caller decodes into its
+// own memory instead.
+class TextureStagingRing {
+public:
+    // Range offsets suit buffer-to-image copies of any format and texel size
+    static constexpr VkDeviceSize kAlignment = 256;
+
+    TextureStagingRing(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize size);
+    ~TextureStagingRing();
+
+    TextureStagingRing(const TextureStagingRing&) = delete;
+    TextureStagingRing& operator=(const TextureStagingRing&) = delete;
+
+    VkBuffer buffer() const { return stagingBuffer; }
+    VkDeviceSize size() const { return capacity; }
+
+    // size bytes of mapped memory, or nullptr when the ring has no room for them now.
+    // Safe from any thread, like release().
+    uint8_t* allocate(VkDeviceSize size);
+    void release(const void* data);
+
+    bool contains(const void* data) const {
+        return data >= mapped && data < mapped + capacity;
+    }
+    VkDeviceSize offsetOf(const void* data) const { return static_cast<const uint8_t*>(data) - mapped; }
+
+private:
+    struct Range {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+        bool released;
+    };
+
+    VkDevice device;
+    VkDeviceSize capacity;
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    uint8_t* mapped = nullptr;
+
+    std::deque<Range> ranges;  // live, oldest first
+    std::mutex mutex;
+};
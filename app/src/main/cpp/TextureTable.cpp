@@ -0,0 +1,32 @@
+#include "TextureTable.h"
+
+TextureTable::TextureTable(uint32_t capacity) : slotCapacity(capacity) {}
+
+uint32_t TextureTable::allocate() {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else if (next < slotCapacity) {
+        slot = next++;
+    } else {
+        return kInvalidSlot;
+    }
+    used++;
+    return slot;
+}
+
+void TextureTable::release(uint32_t slot, uint64_t submittedFrames) {
+    if (slot >= next) {
+        return;
+    }
+    used--;
+    pending.push_back({slot, submittedFrames});
+}
+
+void TextureTable::retire(uint64_t finishedFrames) {
+    while (!pending.empty() && pending.front().frames <= finishedFrames) {
+        freeSlots.push_back(pending.front().slot);
+        pending.pop_front();
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Slots of the bindless texture descriptor array. A texture takes a slot when it is
+// registered and gives it back when released; the slot is only handed out again once
+// every frame that might still sample the old descriptor has finished, so rewriting it
+// never races the GPU. Freed slots are reused before the table grows, which keeps the
+// used range dense. Main thread only.
+class TextureTable {
+public:
+    static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+
+    explicit TextureTable(uint32_t capacity);
+
+    uint32_t capacity() const { return slotCapacity; }
+    // Slots handed out and not yet released
+    uint32_t size() const { return used; }
+    // Slots below this have been handed out at least once
+    uint32_t highWater() const { return next; }
+
+    // kInvalidSlot when every slot is in use or still waiting for its frame
+    uint32_t allocate();
+    // Any of the first submittedFrames frames may still sample the slot; it becomes free
+    // once they have all finished
+    void release(uint32_t slot, uint64_t submittedFrames);
+    // Frames 0 .. finishedFrames - 1 have completed on the GPU
+    void retire(uint64_t finishedFrames);
+
+private:
+    struct Pending {
+        uint32_t slot;
+        uint64_t frames;
+    };
+
+    uint32_t slotCapacity;
+    uint32_t next = 0;
+    uint32_t used = 0;
+    std::vector<uint32_t> freeSlots;  // most recently freed last
+    std::deque<Pending> pending;      // in release order, so frames never decrease
+};
@@ -0,0 +1,81 @@
+#include "VertexQuantizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+int16_t encodeSnorm16(float value) {
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+uint16_t encodeUnorm16(float value) {
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+// Reciprocal that maps a zero range to zero instead of infinity
+float safeInverse(float value) {
+    return value > 0.0f ? 1.0f / value : 0.0f;
+}
+
+} // namespace
+
+VertexQuantization computeVertexQuantization(const Vertex* vertices, size_t vertexCount) {
+    VertexQuantization quantization;
+    if (vertexCount == 0) {
+        return quantization;
+    }
+
+    glm::vec3 posMin(FLT_MAX), posMax(-FLT_MAX);
+    glm::vec2 uvMin(FLT_MAX), uvMax(-FLT_MAX);
+    for (size_t i = 0; i < vertexCount; i++) {
+        posMin = glm::min(posMin, vertices[i].pos);
+        posMax = glm::max(posMax, vertices[i].pos);
+        uvMin = glm::min(uvMin, vertices[i].texCoord);
+        uvMax = glm::max(uvMax, vertices[i].texCoord);
+    }
+
+    quantization.positionScale = glm::vec4((posMax - posMin) * 0.5f, 0.0f);
+    quantization.positionBias = glm::vec4((posMax + posMin) * 0.5f, 1.0f);
+    quantization.texCoordScaleBias = glm::vec4(uvMax - uvMin, uvMin);
+    return quantization;
+}
+
+void quantizeVertices(const Vertex* vertices, size_t vertexCount, const VertexQuantization& quantization,
+                      PackedVertex* out) {
+    glm::vec3 positionInverse(safeInverse(quantization.positionScale.x), safeInverse(quantization.positionScale.y),
+                              safeInverse(quantization.positionScale.z));
+    glm::vec3 positionBias(quantization.positionBias);
+    glm::vec2 texCoordInverse(safeInverse(quantization.texCoordScaleBias.x), safeInverse(quantization.texCoordScaleBias.y));
+    glm::vec2 texCoordBias(quantization.texCoordScaleBias.z, quantization.texCoordScaleBias.w);
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        const Vertex& vertex = vertices[i];
+        glm::vec3 position = (vertex.pos - positionBias) * positionInverse;
+        glm::vec2 texCoord = (vertex.texCoord - texCoordBias) * texCoordInverse;
+
+        PackedVertex packed;
+        packed.pos[0] = encodeSnorm16(position.x);
+        packed.pos[1] = encodeSnorm16(position.y);
+        packed.pos[2] = encodeSnorm16(position.z);
+        packed.pos[3] = 0;
+        packed.texCoord[0] = encodeUnorm16(texCoord.x);
+        packed.texCoord[1] = encodeUnorm16(texCoord.y);
+        out[i] = packed;
+    }
+}
+
+Vertex dequantizeVertex(const PackedVertex& packed, const VertexQuantization& quantization) {
+    // Same decode as the snorm/unorm vertex formats: snorm clamps -32768 to -1
+    glm::vec3 position(std::max(packed.pos[0] / 32767.0f, -1.0f), std::max(packed.pos[1] / 32767.0f, -1.0f),
+                       std::max(packed.pos[2] / 32767.0f, -1.0f));
+    glm::vec2 texCoord(packed.texCoord[0] / 65535.0f, packed.texCoord[1] / 65535.0f);
+
+    Vertex vertex;
+    vertex.pos = position * glm::vec3(quantization.positionScale) + glm::vec3(quantization.positionBias);
+    vertex.color = glm::vec3(1.0f);
+    vertex.texCoord = texCoord * glm::vec2(quantization.texCoordScaleBias) +
+                      glm::vec2(quantization.texCoordScaleBias.z, quantization.texCoordScaleBias.w);
+    return vertex;
+}
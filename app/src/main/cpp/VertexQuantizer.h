@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+
+// Dequantization constants of a packed mesh, pushed as vertex shader push constants:
+//   position = packed.pos * positionScale + positionBias  (packed.pos read as snorm)
+//   texCoord = packed.texCoord * texCoordScaleBias.xy + texCoordScaleBias.zw  (unorm)
+struct VertexQuantization {
+    glm::vec4 positionScale{1.0f};
+    glm::vec4 positionBias{0.0f};
+    glm::vec4 texCoordScaleBias{1.0f, 1.0f, 0.0f, 0.0f};
+};
+
+// Position range is the bounds center +- half extent per axis, UV range the UV bounds,
+// so each axis keeps the full 16 bits no matter where the model sits
+VertexQuantization computeVertexQuantization(const Vertex* vertices, size_t vertexCount);
+
+// Writes vertexCount packed vertices to out, which may be mapped staging memory
+void quantizeVertices(const Vertex* vertices, size_t vertexCount, const VertexQuantization& quantization,
+                      PackedVertex* out);
+
+// CPU version of the shader decode, for tools and validation
+Vertex dequantizeVertex(const PackedVertex& packed, const VertexQuantization& quantization);
@@ -0,0 +1,236 @@
+#include "VertexWelder.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+void forEachBlock(ThreadPool* pool, size_t blockCount, const std::function<void(size_t)>& body) {
+    if (pool && blockCount > 1) {
+        pool->parallelFor(blockCount, body);
+    } else {
+        for (size_t i = 0; i < blockCount; i++) {
+            body(i);
+        }
+    }
+}
+
+size_t nextPowerOfTwo(size_t value) {
+    size_t result = 16;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+void weldHash(const Vertex* corners, size_t cornerCount,
+              std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices) {
+    // Slots keep the upper hash bits as a tag so most mismatches skip the Vertex compare
+    struct Slot {
+        uint32_t tag;
+        uint32_t index;
+    };
+
+    // Triangle meshes typically have 1/6 to 1/2 as many unique vertices as corners;
+    // start at half the corner count and grow if the load goes above 3/4
+    size_t capacity = nextPowerOfTwo(cornerCount / 2);
+    std::vector<Slot> table(capacity, Slot{0, kEmptySlot});
+    size_t mask = capacity - 1;
+
+    auto insertSlot = [&](uint64_t hash, uint32_t index) {
+        size_t position = hash & mask;
+        while (table[position].index != kEmptySlot) {
+            position = (position + 1) & mask;
+        }
+        table[position] = Slot{uint32_t(hash >> 32), index};
+    };
+
+    outVertices.clear();
+    outVertices.reserve(cornerCount / 4);
+    outIndices.resize(cornerCount);
+
+    for (size_t i = 0; i < cornerCount; i++) {
+        const Vertex& vertex = corners[i];
+        uint64_t hash = hashVertex(vertex);
+        uint32_t tag = uint32_t(hash >> 32);
+
+        size_t position = hash & mask;
+        while (true) {
+            const Slot& slot = table[position];
+            if (slot.index == kEmptySlot) {
+                uint32_t index = uint32_t(outVertices.size());
+                table[position] = Slot{tag, index};
+                outVertices.push_back(vertex);
+                outIndices[i] = index;
+                break;
+            }
+            if (slot.tag == tag && outVertices[slot.index] == vertex) {
+                outIndices[i] = slot.index;
+                break;
+            }
+            position = (position + 1) & mask;
+        }
+
+        if (outVertices.size() * 4 > capacity * 3) {
+            capacity *= 2;
+            mask = capacity - 1;
+            table.assign(capacity, Slot{0, kEmptySlot});
+            for (uint32_t v = 0; v < outVertices.size(); v++) {
+                insertSlot(hashVertex(outVertices[v]), v);
+            }
+        }
+    }
+}
+
+// Stable LSD radix sort of (key, value) pairs, 8 bits per pass. Each pass builds
+// per-block histograms in parallel, prefix-sums them, and scatters every block in
+// parallel to its own offsets, which keeps equal keys in input order.
+void radixSortPairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, ThreadPool* pool) {
+    size_t count = keys.size();
+    size_t blockCount = pool ? std::clamp<size_t>(count / (64 * 1024), 1, pool->size() * 4) : 1;
+    size_t blockSize = (count + blockCount - 1) / blockCount;
+
+    std::vector<uint64_t> keysTemp(count);
+    std::vector<uint32_t> valuesTemp(count);
+    std::vector<std::array<size_t, 256>> histograms(blockCount);
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        forEachBlock(pool, blockCount, [&](size_t block) {
+            auto& histogram = histograms[block];
+            histogram.fill(0);
+            size_t end = std::min(count, (block + 1) * blockSize);
+            for (size_t i = block * blockSize; i < end; i++) {
+                histogram[(keys[i] >> shift) & 0xFF]++;
+            }
+        });
+
+        // Skip passes where every key has the same digit
+        bool trivial = false;
+        for (int digit = 0; digit < 256 && !trivial; digit++) {
+            size_t total = 0;
+            for (size_t block = 0; block < blockCount; block++) {
+                total += histograms[block][digit];
+            }
+            trivial = total == count;
+            if (total != 0 && !trivial) {
+                break;
+            }
+        }
+        if (trivial) {
+            continue;
+        }
+
+        // Turn counts into output offsets: digit-major, then block order
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            for (size_t block = 0; block < blockCount; block++) {
+                size_t blockDigitCount = histograms[block][digit];
+                histograms[block][digit] = offset;
+                offset += blockDigitCount;
+            }
+        }
+
+        forEachBlock(pool, blockCount, [&](size_t block) {
+            auto& offsets = histograms[block];
+            size_t end = std::min(count, (block + 1) * blockSize);
+            for (size_t i = block * blockSize; i < end; i++) {
+                size_t destination = offsets[(keys[i] >> shift) & 0xFF]++;
+                keysTemp[destination] = keys[i];
+                valuesTemp[destination] = values[i];
+            }
+        });
+
+        keys.swap(keysTemp);
+        values.swap(valuesTemp);
+    }
+}
+
+void weldSort(const Vertex* corners, size_t cornerCount,
+              std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices, ThreadPool* pool) {
+    size_t blockCount = pool ? std::clamp<size_t>(cornerCount / (64 * 1024), 1, pool->size() * 4) : 1;
+    size_t blockSize = (cornerCount + blockCount - 1) / blockCount;
+
+    std::vector<uint64_t> keys(cornerCount);
+    std::vector<uint32_t> order(cornerCount);
+    forEachBlock(pool, blockCount, [&](size_t block) {
+        size_t end = std::min(cornerCount, (block + 1) * blockSize);
+        for (size_t i = block * blockSize; i < end; i++) {
+            keys[i] = hashVertex(corners[i]);
+            order[i] = uint32_t(i);
+        }
+    });
+
+    radixSortPairs(keys, order, pool);
+
+    // Within a run of equal hashes corners are in input order, so the first corner of
+    // each set of equal vertices is its lowest index. Point every corner at it.
+    std::vector<uint32_t> representative(cornerCount);
+    forEachBlock(pool, blockCount, [&](size_t block) {
+        // Move both block edges forward to the start of a hash run
+        auto runStart = [&](size_t position) {
+            while (position > 0 && position < cornerCount && keys[position] == keys[position - 1]) {
+                position++;
+            }
+            return std::min(position, cornerCount);
+        };
+        size_t begin = runStart(block * blockSize);
+        size_t end = runStart(std::min(cornerCount, (block + 1) * blockSize));
+
+        size_t run = begin;
+        while (run < end) {
+            size_t runEnd = run + 1;
+            while (runEnd < cornerCount && keys[runEnd] == keys[run]) {
+                runEnd++;
+            }
+            for (size_t j = run; j < runEnd; j++) {
+                uint32_t corner = order[j];
+                uint32_t first = corner;
+                // Only compare against earlier leaders; hash collisions make this loop
+                // longer than one step, exact duplicates stop at the first leader
+                for (size_t k = run; k < j; k++) {
+                    uint32_t candidate = order[k];
+                    if (representative[candidate] == candidate && corners[candidate] == corners[corner]) {
+                        first = candidate;
+                        break;
+                    }
+                }
+                representative[corner] = first;
+            }
+            run = runEnd;
+        }
+    });
+
+    // Number the unique vertices in order of first occurrence
+    outVertices.clear();
+    outIndices.resize(cornerCount);
+    for (size_t i = 0; i < cornerCount; i++) {
+        uint32_t first = representative[i];
+        if (first == i) {
+            outIndices[i] = uint32_t(outVertices.size());
+            outVertices.push_back(corners[i]);
+        } else {
+            outIndices[i] = outIndices[first];
+        }
+    }
+}
+
+} // namespace
+
+void weldVertices(const Vertex* corners, size_t cornerCount,
+                  std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices,
+                  WeldMode mode, ThreadPool* pool) {
+    if (cornerCount >= kEmptySlot) {
+        throw std::runtime_error("weldVertices: too many corners for 32-bit indices");
+    }
+
+    if (mode == WeldMode::Sort) {
+        weldSort(corners, cornerCount, outVertices, outIndices, pool);
+    } else {
+        weldHash(corners, cornerCount, outVertices, outIndices);
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+enum class WeldMode {
+    Auto,  // Hash: meshBenchmark has Sort slower at every size and thread count measured
+    Hash,  // Open-addressing table sized from the corner count, single threaded
+    Sort   // Parallel radix sort of corner hashes followed by a unique pass
+};
+
+// Merges identical corners (Vertex::operator==) into a vertex buffer plus one index per
+// corner. Vertices are emitted in order of first occurrence, so every mode produces
+// exactly the same buffers as the previous std::unordered_map based loop.
+void weldVertices(const Vertex* corners, size_t cornerCount,
+                  std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices,
+                  WeldMode mode = WeldMode::Auto, ThreadPool* pool = nullptr);
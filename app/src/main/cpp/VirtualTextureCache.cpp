@@ -0,0 +1,160 @@
+#include "VirtualTextureCache.h"
+
+#include "VirtualTextureFile.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t kNoPage = UINT32_MAX;
+
+} // namespace
+
+VirtualTextureCache::VirtualTextureCache(uint32_t slotsPerSide) : slotsPerSide(std::min(slotsPerSide, 256u)) {
+    slots.resize(slotCount());
+    // Handed out from the back, so slot 0 goes first
+    for (uint32_t slot = slotCount(); slot > 0; slot--) {
+        freeSlots.push_back(slot - 1);
+    }
+}
+
+uint32_t VirtualTextureCache::addTexture(uint32_t width, uint32_t height, std::vector<uint32_t>& levelFirstPage) {
+    Texture texture{pageCount(), width, height, virtualTextureLevels(width, height), {}};
+    for (uint32_t level = 0; level < texture.levelCount; level++) {
+        uint32_t pagesX, pagesY;
+        virtualTexturePages(width, height, level, pagesX, pagesY);
+        texture.levelFirstPage.push_back(pageCount() - texture.firstPage);
+        for (uint32_t y = 0; y < pagesY; y++) {
+            for (uint32_t x = 0; x < pagesX; x++) {
+                PageState state;
+                state.key = {static_cast<uint32_t>(textures.size()), level, x, y};
+                pages.push_back(state);
+            }
+        }
+    }
+    levelFirstPage = texture.levelFirstPage;
+    textures.push_back(std::move(texture));
+    table.resize(pages.size(), 0);
+    return textures.back().firstPage;
+}
+
+uint32_t VirtualTextureCache::tailPage(uint32_t texture) const {
+    const Texture& entry = textures[texture];
+    return entry.firstPage + entry.levelFirstPage[entry.levelCount - 1];
+}
+
+uint32_t VirtualTextureCache::parent(uint32_t page) const {
+    const Page& key = pages[page].key;
+    const Texture& texture = textures[key.texture];
+    if (key.level + 1 >= texture.levelCount) {
+        return kNoPage;
+    }
+    uint32_t pagesX, pagesY;
+    virtualTexturePages(texture.width, texture.height, key.level + 1, pagesX, pagesY);
+    return texture.firstPage + texture.levelFirstPage[key.level + 1] + (key.y / 2) * pagesX + key.x / 2;
+}
+
+void VirtualTextureCache::request(uint32_t page, uint64_t frame) {
+    for (uint32_t current = page; current != kNoPage; current = parent(current)) {
+        PageState& state = pages[current];
+        state.lastUsed = std::max(state.lastUsed, frame);
+        if (state.slot == kNoSlot && !state.loading && !state.queued) {
+            state.queued = true;
+            wanted.push_back(current);
+        }
+    }
+}
+
+std::vector<uint32_t> VirtualTextureCache::takeLoads(size_t max) {
+    // Coarse pages first: they cover the most screen and are the fallback of the finer ones
+    std::stable_sort(wanted.begin(), wanted.end(), [&](uint32_t a, uint32_t b) {
+        return pages[a].key.level > pages[b].key.level;
+    });
+    std::vector<uint32_t> loads;
+    for (uint32_t page : wanted) {
+        pages[page].queued = false;
+        if (loads.size() < max) {
+            pages[page].loading = true;
+            loads.push_back(page);
+        }
+    }
+    wanted.clear();
+    return loads;
+}
+
+uint32_t VirtualTextureCache::insert(uint32_t page, uint64_t frame, bool pinned) {
+    PageState& state = pages[page];
+    state.loading = false;
+    if (state.slot != kNoSlot) {
+        return kNoSlot;
+    }
+
+    uint32_t slot = kNoSlot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        // Least recently used page, if it was last asked for before frame
+        uint64_t oldest = frame;
+        for (uint32_t candidate = 0; candidate < slots.size(); candidate++) {
+            if (slots[candidate].pinned) {
+                continue;
+            }
+            const uint64_t lastUsed = pages[slots[candidate].page].lastUsed;
+            if (lastUsed < oldest) {
+                oldest = lastUsed;
+                slot = candidate;
+            }
+        }
+        if (slot == kNoSlot) {
+            return kNoSlot;
+        }
+        PageState& evicted = pages[slots[slot].page];
+        evicted.slot = kNoSlot;
+        textures[evicted.key.texture].dirty = true;
+        resident--;
+        evictions++;
+    }
+
+    slots[slot] = {page, pinned};
+    state.slot = slot;
+    textures[state.key.texture].dirty = true;
+    resident++;
+    loads++;
+    return slot;
+}
+
+void VirtualTextureCache::cancelLoad(uint32_t page) {
+    pages[page].loading = false;
+}
+
+bool VirtualTextureCache::updatePageTable() {
+    bool changed = false;
+    for (Texture& texture : textures) {
+        if (!texture.dirty) {
+            continue;
+        }
+        // Coarse to fine, so every parent entry is final before its children copy it
+        for (uint32_t level = texture.levelCount; level-- > 0;) {
+            uint32_t pagesX, pagesY;
+            virtualTexturePages(texture.width, texture.height, level, pagesX, pagesY);
+            const uint32_t first = texture.firstPage + texture.levelFirstPage[level];
+            for (uint32_t index = first; index < first + pagesX * pagesY; index++) {
+                const PageState& state = pages[index];
+                if (state.slot != kNoSlot) {
+                    table[index] = (state.slot % slotsPerSide) | (state.slot / slotsPerSide) << 8 | level << 16 |
+                                   kEntryValid;
+                } else {
+                    const uint32_t up = parent(index);
+                    table[index] = up != kNoPage ? table[up] : 0;
+                }
+            }
+        }
+        texture.dirty = false;
+        changed = true;
+    }
+    if (changed) {
+        tableVersion++;
+    }
+    return changed;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Book-keeping of the virtual texturing path: which tiles (pages) of which textures sit in
+// the slots of the physical cache image, which are wanted next, and the page table the
+// fragment shader reads. Every page has one table entry; a page that is not resident
+// points at the closest resident ancestor, so sampling falls back to a coarser level until
+// the tile arrives. Main thread only; the renderer decodes tiles on workers and hands
+// them in through insert().
+//
+// Page table entry: slot x in bits 0-7, slot y in bits 8-15, level of the resident page
+// in bits 16-20, bit 31 set when any ancestor is resident.
+class VirtualTextureCache {
+public:
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+    static constexpr uint32_t kEntryValid = 1u << 31;
+
+    struct Page {
+        uint32_t texture;
+        uint32_t level;
+        uint32_t x;
+        uint32_t y;
+    };
+
+    // slotsPerSide^2 tiles in the cache image, at most 256 per side
+    explicit VirtualTextureCache(uint32_t slotsPerSide);
+
+    // Adds a texture with the pages of its .vtex levels, down to the one page of the mip
+    // tail; returns the index of its first page. levelFirstPage gets each level's first
+    // page relative to that.
+    uint32_t addTexture(uint32_t width, uint32_t height, std::vector<uint32_t>& levelFirstPage);
+
+    uint32_t pageCount() const { return static_cast<uint32_t>(pages.size()); }
+    uint32_t slotCount() const { return slotsPerSide * slotsPerSide; }
+    const Page& page(uint32_t index) const { return pages[index].key; }
+    // The one page of each texture's last level
+    uint32_t tailPage(uint32_t texture) const;
+
+    // The shader sampled page during frame: it and its ancestors count as used, and the
+    // ones that are neither resident nor loading are queued
+    void request(uint32_t page, uint64_t frame);
+    // Up to max queued pages, coarsest first, now marked loading. Whatever is left in the
+    // queue is dropped; the next feedback asks for it again if it is still visible.
+    std::vector<uint32_t> takeLoads(size_t max);
+    // The tile of a loading page has been decoded; returns the slot to copy it into, or
+    // kNoSlot when every slot holds a pinned page or one requested during frame or later
+    // (the load is then dropped). Pinned pages are never evicted.
+    uint32_t insert(uint32_t page, uint64_t frame, bool pinned = false);
+    // The tile of a loading page could not be read
+    void cancelLoad(uint32_t page);
+
+    // Rewrites the entries of textures whose residency changed; false if none did
+    bool updatePageTable();
+    const std::vector<uint32_t>& pageTable() const { return table; }
+    // Bumped by every updatePageTable() that changed the table
+    uint64_t version() const { return tableVersion; }
+
+    uint32_t residentPages() const { return resident; }
+    uint64_t loadedPages() const { return loads; }
+    uint64_t evictedPages() const { return evictions; }
+
+private:
+    struct PageState {
+        Page key;
+        uint32_t slot = kNoSlot;
+        uint64_t lastUsed = 0;
+        bool queued = false;
+        bool loading = false;
+    };
+
+    struct Slot {
+        uint32_t page = UINT32_MAX;
+        bool pinned = false;
+    };
+
+    struct Texture {
+        uint32_t firstPage;
+        uint32_t width;
+        uint32_t height;
+        uint32_t levelCount;
+        std::vector<uint32_t> levelFirstPage;
+        bool dirty = true;
+    };
+
+    uint32_t parent(uint32_t page) const;
+
+    uint32_t slotsPerSide;
+    std::vector<PageState> pages;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<Texture> textures;
+    std::vector<uint32_t> wanted;
+    std::vector<uint32_t> table;
+    uint64_t tableVersion = 0;
+    uint32_t resident = 0;
+    uint64_t loads = 0;
+    uint64_t evictions = 0;
+};
@@ -0,0 +1,188 @@
+#include "VirtualTextureFile.h"
+
+#include "MipChain.h"
+#include "Zstd.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr uint32_t kTileStride = kVirtualTextureTileSize + 2 * kVirtualTextureBorder;
+
+struct Level {
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> pixels;
+};
+
+Level downsample(const Level& level) {
+    Level result{std::max(level.width / 2, 1u), std::max(level.height / 2, 1u), {}};
+    result.pixels.resize(size_t(result.width) * result.height * 4);
+    downsampleRgba8Srgb(level.pixels.data(), level.width, level.height, result.pixels.data());
+    return result;
+}
+
+// Tile (x, y) of a level with its border; texels past the level's edges wrap
+void copyTile(const Level& level, uint32_t tileX, uint32_t tileY, uint8_t* dst) {
+    const int64_t left = int64_t(tileX) * kVirtualTextureTileSize - kVirtualTextureBorder;
+    const int64_t top = int64_t(tileY) * kVirtualTextureTileSize - kVirtualTextureBorder;
+    const int64_t width = level.width;
+    const int64_t height = level.height;
+    for (uint32_t y = 0; y < kTileStride; y++) {
+        const int64_t sy = (((top + y) % height) + height) % height;
+        const uint8_t* row = &level.pixels[size_t(sy) * level.width * 4];
+        for (uint32_t x = 0; x < kTileStride; x++) {
+            const int64_t sx = (((left + x) % width) + width) % width;
+            std::memcpy(dst, row + sx * 4, 4);
+            dst += 4;
+        }
+    }
+}
+
+bool rangeInBounds(uint64_t offset, uint64_t length, uint64_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+} // namespace
+
+uint32_t virtualTextureLevels(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    while (std::max(width >> (levels - 1), height >> (levels - 1)) > kVirtualTextureTileSize) {
+        levels++;
+    }
+    return levels;
+}
+
+void virtualTexturePages(uint32_t width, uint32_t height, uint32_t level, uint32_t& pagesX, uint32_t& pagesY) {
+    pagesX = (std::max(width >> level, 1u) + kVirtualTextureTileSize - 1) / kVirtualTextureTileSize;
+    pagesY = (std::max(height >> level, 1u) + kVirtualTextureTileSize - 1) / kVirtualTextureTileSize;
+}
+
+std::vector<uint8_t> serializeVirtualTexture(uint32_t width, uint32_t height, const uint8_t* pixels,
+                                             ZstdCompressor compress) {
+    const uint32_t levelCount = virtualTextureLevels(width, height);
+    if (width == 0 || height == 0 || levelCount > kVirtualTextureMaxLevels) {
+        throw std::runtime_error("vtex: unsupported size " + std::to_string(width) + "x" + std::to_string(height));
+    }
+
+    uint32_t tileCount = 0;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        uint32_t pagesX, pagesY;
+        virtualTexturePages(width, height, level, pagesX, pagesY);
+        tileCount += pagesX * pagesY;
+    }
+
+    VirtualTextureHeader header{};
+    header.magic = kVirtualTextureMagic;
+    header.version = kVirtualTextureVersion;
+    header.width = width;
+    header.height = height;
+    header.format = kVirtualTextureFormatRgba8Srgb;
+    header.tileSize = kVirtualTextureTileSize;
+    header.border = kVirtualTextureBorder;
+    header.levelCount = levelCount;
+    header.flags = compress ? kVirtualTextureZstd : 0;
+    header.tileCount = tileCount;
+
+    std::vector<VirtualTextureTile> tiles;
+    tiles.reserve(tileCount);
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> tile(virtualTextureTileBytes());
+    Level level{width, height, std::vector<uint8_t>(pixels, pixels + size_t(width) * height * 4)};
+    const uint64_t dataOffset = sizeof(header) + uint64_t(tileCount) * sizeof(VirtualTextureTile);
+    for (uint32_t index = 0; index < levelCount; index++) {
+        if (index > 0) {
+            level = downsample(level);
+        }
+        uint32_t pagesX, pagesY;
+        virtualTexturePages(width, height, index, pagesX, pagesY);
+        for (uint32_t y = 0; y < pagesY; y++) {
+            for (uint32_t x = 0; x < pagesX; x++) {
+                copyTile(level, x, y, tile.data());
+                std::vector<uint8_t> stored = compress ? compress(tile.data(), tile.size()) : tile;
+                tiles.push_back({dataOffset + data.size(), uint32_t(stored.size()), 0});
+                data.insert(data.end(), stored.begin(), stored.end());
+            }
+        }
+    }
+
+    header.fileSize = dataOffset + data.size();
+    std::vector<uint8_t> file(header.fileSize);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), tiles.data(), tiles.size() * sizeof(VirtualTextureTile));
+    std::memcpy(file.data() + dataOffset, data.data(), data.size());
+    return file;
+}
+
+VirtualTexture readVirtualTextureFile(const AssetData& file) {
+    if (file.size < sizeof(VirtualTextureHeader)) {
+        throw std::runtime_error("vtex: file too small");
+    }
+    VirtualTextureHeader header;
+    std::memcpy(&header, file.data, sizeof(header));
+    if (header.magic != kVirtualTextureMagic || header.version != kVirtualTextureVersion) {
+        throw std::runtime_error("vtex: bad magic or version");
+    }
+    if (header.format != kVirtualTextureFormatRgba8Srgb || header.tileSize != kVirtualTextureTileSize ||
+        header.border != kVirtualTextureBorder || (header.flags & ~kVirtualTextureZstd) != 0) {
+        throw std::runtime_error("vtex: unsupported format or tile layout");
+    }
+    if (header.width == 0 || header.height == 0 || header.fileSize != file.size ||
+        header.levelCount != virtualTextureLevels(header.width, header.height) ||
+        header.levelCount > kVirtualTextureMaxLevels) {
+        throw std::runtime_error("vtex: bad size or level count");
+    }
+
+    VirtualTexture texture;
+    uint32_t tileCount = 0;
+    for (uint32_t level = 0; level < header.levelCount; level++) {
+        uint32_t pagesX, pagesY;
+        virtualTexturePages(header.width, header.height, level, pagesX, pagesY);
+        texture.levelFirstTile.push_back(tileCount);
+        tileCount += pagesX * pagesY;
+    }
+    if (header.tileCount != tileCount ||
+        !rangeInBounds(sizeof(header), uint64_t(tileCount) * sizeof(VirtualTextureTile), file.size)) {
+        throw std::runtime_error("vtex: tile index out of bounds");
+    }
+    const bool compressed = (header.flags & kVirtualTextureZstd) != 0;
+    for (uint32_t i = 0; i < tileCount; i++) {
+        VirtualTextureTile tile;
+        std::memcpy(&tile, file.bytes() + sizeof(header) + i * sizeof(VirtualTextureTile), sizeof(tile));
+        if (!rangeInBounds(tile.offset, tile.size, file.size) ||
+            (!compressed && tile.size != virtualTextureTileBytes())) {
+            throw std::runtime_error("vtex: tile " + std::to_string(i) + " out of bounds");
+        }
+    }
+
+    texture.width = header.width;
+    texture.height = header.height;
+    texture.levelCount = header.levelCount;
+    texture.file = file;
+    texture.compressed = compressed;
+    return texture;
+}
+
+void VirtualTexture::readTile(uint32_t level, uint32_t x, uint32_t y, uint8_t* dst) const {
+    uint32_t pagesX, pagesY;
+    virtualTexturePages(width, height, level, pagesX, pagesY);
+    if (level >= levelCount || x >= pagesX || y >= pagesY) {
+        throw std::runtime_error("vtex: no tile " + std::to_string(x) + "," + std::to_string(y) + " in level " +
+                                 std::to_string(level));
+    }
+    VirtualTextureTile tile;
+    std::memcpy(&tile, file.bytes() + sizeof(VirtualTextureHeader) +
+                               (levelFirstTile[level] + y * pagesX + x) * sizeof(VirtualTextureTile),
+                sizeof(tile));
+    if (!compressed) {
+        std::memcpy(dst, file.bytes() + tile.offset, virtualTextureTileBytes());
+        return;
+    }
+    if (zstdDecompress(file.bytes() + tile.offset, tile.size, dst, virtualTextureTileBytes()) !=
+        virtualTextureTileBytes()) {
+        throw std::runtime_error("vtex: tile decompressed to the wrong size");
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "AssetSource.h"
+#include "Zstd.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// .vtex: a texture cut into square tiles for virtual texturing, so a renderer can load
+// the few tiles it samples without ever holding a whole 8K-16K image.
+//
+// Layout (little endian):
+//   VirtualTextureHeader
+//   VirtualTextureTile[tileCount]  level 0 first, tiles row-major within a level
+//   tile data                      each tile (tileSize + 2 * border)^2 RGBA8 texels, on
+//                                  its own or zstd compressed (kVirtualTextureZstd)
+//
+// The chain stops at the first level that fits in one tile (the mip tail). Every tile
+// carries a border of the texels around it, wrapped at the level's edges as a repeating
+// sampler would read them, so bilinear filtering never reaches into another tile of the
+// cache.
+
+constexpr uint32_t kVirtualTextureMagic = 0x58545656;  // "VVTX"
+constexpr uint32_t kVirtualTextureVersion = 1;
+constexpr uint32_t kVirtualTextureTileSize = 128;
+constexpr uint32_t kVirtualTextureBorder = 4;
+constexpr uint32_t kVirtualTextureMaxLevels = 16;  // 128 << 15 texels wide at most
+constexpr uint32_t kVirtualTextureFormatRgba8Srgb = 43;  // VK_FORMAT_R8G8B8A8_SRGB
+
+// VirtualTextureHeader::flags
+constexpr uint32_t kVirtualTextureZstd = 1;
+
+struct VirtualTextureHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t tileSize;
+    uint32_t border;
+    uint32_t levelCount;
+    uint32_t flags;
+    uint32_t tileCount;
+    uint64_t fileSize;
+};
+static_assert(sizeof(VirtualTextureHeader) == 48, "VirtualTextureHeader layout changed");
+
+struct VirtualTextureTile {
+    uint64_t offset;
+    uint32_t size;  // stored bytes
+    uint32_t padding;
+};
+static_assert(sizeof(VirtualTextureTile) == 16, "VirtualTextureTile layout changed");
+
+// Levels down to the mip tail, and the tiles of one level
+uint32_t virtualTextureLevels(uint32_t width, uint32_t height);
+void virtualTexturePages(uint32_t width, uint32_t height, uint32_t level, uint32_t& pagesX, uint32_t& pagesY);
+
+// Bytes of one decoded tile, border included
+constexpr size_t virtualTextureTileBytes() {
+    return size_t(kVirtualTextureTileSize + 2 * kVirtualTextureBorder) *
+           (kVirtualTextureTileSize + 2 * kVirtualTextureBorder) * 4;
+}
+
+class VirtualTexture {
+public:
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t levelCount = 0;
+
+    explicit operator bool() const { return levelCount > 0; }
+
+    // Writes tile (x, y) of level into dst (virtualTextureTileBytes()). Safe to call from
+    // several threads at once. Throws std::runtime_error if the tile data is corrupt.
+    void readTile(uint32_t level, uint32_t x, uint32_t y, uint8_t* dst) const;
+
+private:
+    friend VirtualTexture readVirtualTextureFile(const AssetData& file);
+
+    AssetData file;
+    bool compressed = false;
+    std::vector<uint32_t> levelFirstTile;
+};
+
+// Cuts an RGBA8 sRGB image into tiles, building the chain down to the mip tail with a
+// 2x2 box filter in linear space. Tiles are zstd compressed when given a compressor,
+// which only the offline tool has; it is too slow to pay at load time anyway.
+std::vector<uint8_t> serializeVirtualTexture(uint32_t width, uint32_t height, const uint8_t* pixels,
+                                             ZstdCompressor compress);
+
+// Checks the header and the tile bounds; tiles are only decoded by readTile. Throws
+// std::runtime_error if the file is truncated, corrupt or from another version.
+VirtualTexture readVirtualTextureFile(const AssetData& file);
@@ -1,39 +1,110 @@
 #include "VulkanRenderer.h"
 #include "AndroidOut.h"
 #include "CameraController.h"
+#include "ObjParser.h"
+#include "MeshBuilder.h"
+#include "AndroidAssetSource.h"
+#include "Ktx2File.h"
+#include "MeshFile.h"
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MipChain.h"
+#include "BasisTranscoder.h"
 
 #include <android/asset_manager.h>
 #include <android/native_window.h>
 #include <vulkan/vulkan_android.h>
 #include <cmath>
 
+// stb_image allocates through these, so decodeTexture can point the decoded image at
+// staging memory (see DecodeTarget)
+static void* stbMalloc(size_t size);
+static void* stbRealloc(void* pointer, size_t size);
+static void stbFree(void* pointer);
+#define STBI_MALLOC(size) stbMalloc(size)
+#define STBI_REALLOC(pointer, size) stbRealloc(pointer, size)
+#define STBI_FREE(pointer) stbFree(pointer)
 #define STB_IMAGE_IMPLEMENTATION
 #include "lib/stb-master/stb_image.h"
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "lib/tiny_obj_loader/tiny_obj_loader.h"
-
 #include <stdexcept>
 #include <vector>
 #include <set>
+#include <map>
 #include <algorithm>
 #include <fstream>
 #include <cstring>
 #include <chrono>
 #include <unordered_map>
-#include <sstream>
 
-// Vertex implementation
-VkVertexInputBindingDescription Vertex::getBindingDescription() {
+// Set on a worker for one decode: the first allocation of exactly size bytes, which
+// for PNGs is the RGBA8 result, is served from data instead of the heap. Anything else
+// stb allocates, or a result of another size, stays on the heap.
+struct DecodeTarget {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    bool taken = false;
+};
+static thread_local DecodeTarget decodeTarget;
+
+static void* stbMalloc(size_t size) {
+    if (decodeTarget.data != nullptr && !decodeTarget.taken && size == decodeTarget.size) {
+        decodeTarget.taken = true;
+        return decodeTarget.data;
+    }
+    return malloc(size);
+}
+
+static void* stbRealloc(void* pointer, size_t size) {
+    if (pointer == nullptr || pointer != decodeTarget.data) {
+        return realloc(pointer, size);
+    }
+    // The target cannot grow; whatever holds it moves to the heap
+    void* moved = malloc(size);
+    if (moved != nullptr) {
+        memcpy(moved, pointer, std::min(size, decodeTarget.size));
+        decodeTarget.taken = false;
+    }
+    return moved;
+}
+
+static void stbFree(void* pointer) {
+    if (pointer != nullptr && pointer == decodeTarget.data) {
+        decodeTarget.taken = false;
+        return;
+    }
+    free(pointer);
+}
+
+// Vertex input layout
+VkVertexInputBindingDescription getVertexBindingDescription(VertexFormat format) {
     VkVertexInputBindingDescription bindingDescription{};
     bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex);
+    bindingDescription.stride = format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
     bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
     return bindingDescription;
 }
 
-std::array<VkVertexInputAttributeDescription, 4> Vertex::getAttributeDescriptions() {
-    std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions(VertexFormat format) {
+    if (format == VertexFormat::Packed) {
+        // Locations match the float layout; color (location 1) is not an input of the packed shader
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_SNORM;
+        attributeDescriptions[0].offset = offsetof(PackedVertex, pos);
+
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 2;
+        attributeDescriptions[1].format = VK_FORMAT_R16G16_UNORM;
+        attributeDescriptions[1].offset = offsetof(PackedVertex, texCoord);
+
+        return attributeDescriptions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(3);
 
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
@@ -50,14 +121,97 @@ std::array<VkVertexInputAttributeDescription, 4> Vertex::getAttributeDescription
     attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
     attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
 
-    attributeDescriptions[3].binding = 0;
-    attributeDescriptions[3].location = 3;
-    attributeDescriptions[3].format = VK_FORMAT_R32_SINT;
-    attributeDescriptions[3].offset = offsetof(Vertex, texIndex);
-
     return attributeDescriptions;
 }
 
+// True if the SPIR-V module declares an entry point with the given name (OpEntryPoint)
+static bool spirvHasEntryPoint(const AssetData& code, const char* name) {
+    const size_t wordCount = code.size / 4;
+    auto word = [&](size_t i) {
+        uint32_t value;
+        memcpy(&value, code.chars() + i * 4, sizeof(value));
+        return value;
+    };
+    if (wordCount < 5 || word(0) != 0x07230203) {
+        return false;
+    }
+    size_t nameLength = strlen(name);
+    for (size_t i = 5; i < wordCount;) {
+        uint32_t instruction = word(i);
+        uint32_t length = instruction >> 16;
+        if (length == 0 || i + length > wordCount) {
+            break;
+        }
+        // OpEntryPoint: execution model, function id, then the null-terminated name
+        if ((instruction & 0xFFFF) == 15 && length > 3) {
+            const char* entryName = code.chars() + (i + 3) * 4;
+            size_t maxLength = (length - 3) * 4;
+            if (strnlen(entryName, maxLength) == nameLength && memcmp(entryName, name, nameLength) == 0) {
+                return true;
+            }
+        }
+        i += length;
+    }
+    return false;
+}
+
+static bool extensionAvailable(const std::vector<VkExtensionProperties>& availableExtensions, const char* name) {
+    return std::any_of(availableExtensions.begin(), availableExtensions.end(),
+                       [&](const VkExtensionProperties& available) {
+                           return strcmp(name, available.extensionName) == 0;
+                       });
+}
+
+// Models of the scene and where they sit. Missing files are skipped with a warning.
+static std::vector<ModelDesc> sceneModels() {
+    return {
+            {"logo.obj", glm::mat4(1.0f)},
+            // The viking room is about 1.5 units across
+            {"viking_room.obj", glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -120.0f)),
+                                           glm::vec3(60.0f))},
+    };
+}
+
+// Cached decoded texture: this header, then width * height RGBA8 texels
+struct TextureCacheHeader {
+    uint32_t magic;
+    uint32_t width;
+    uint32_t height;
+    uint32_t padding;
+};
+static constexpr uint32_t TEXTURE_CACHE_MAGIC = 0x58455456;  // "VTEX"
+
+// Pre-encoded variants tools/ktx2conv writes next to a PNG as <name>.<suffix>.ktx2, best
+// first: ASTC 4x4 and BC7 keep the most detail at 1 byte per texel, ASTC 6x6 and ETC2
+// take half that
+struct TextureVariant {
+    const char* suffix;
+    VkFormat format;       // one the device has to sample for the variant to be tried
+    VkFormat alphaFormat;  // what Basis files with alpha are transcoded to alongside format
+};
+static const TextureVariant textureVariantTable[] = {
+        {"astc4x4", VK_FORMAT_ASTC_4x4_SRGB_BLOCK, VK_FORMAT_ASTC_4x4_SRGB_BLOCK},
+        {"bc7", VK_FORMAT_BC7_SRGB_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK},
+        {"astc6x6", VK_FORMAT_ASTC_6x6_SRGB_BLOCK, VK_FORMAT_ASTC_6x6_SRGB_BLOCK},
+        {"etc2", VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK},
+};
+
+static_assert(kKtx2FormatRgba8Srgb == VK_FORMAT_R8G8B8A8_SRGB, "KTX2 format constants out of sync");
+static_assert(kKtx2FormatBc7Srgb == VK_FORMAT_BC7_SRGB_BLOCK, "KTX2 format constants out of sync");
+static_assert(kKtx2FormatEtc2Rgb8Srgb == VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, "KTX2 format constants out of sync");
+static_assert(kKtx2FormatEtc2Rgba8Srgb == VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, "KTX2 format constants out of sync");
+static_assert(kKtx2FormatAstc4x4Srgb == VK_FORMAT_ASTC_4x4_SRGB_BLOCK, "KTX2 format constants out of sync");
+static_assert(kKtx2FormatAstc6x6Srgb == VK_FORMAT_ASTC_6x6_SRGB_BLOCK, "KTX2 format constants out of sync");
+
+#ifdef VK_EXT_mesh_shader
+// Device extensions of the meshlet path; GL_EXT_mesh_shader compiles to SPIR-V 1.4
+static const char* const meshShaderExtensions[] = {
+        VK_EXT_MESH_SHADER_EXTENSION_NAME,
+        VK_KHR_SPIRV_1_4_EXTENSION_NAME,
+        VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME,
+};
+#endif
+
 // Debug callback
 VKAPI_ATTR VkBool32 VKAPI_CALL VulkanRenderer::debugCallback(
         VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -69,15 +223,35 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VulkanRenderer::debugCallback(
 }
 
 VulkanRenderer::VulkanRenderer(android_app* app) : app_(app) {
+    assets = std::make_unique<AndroidAssetSource>(app->activity->assetManager);
+    // internalDataPath is <app data>/files; getCacheDir() is its sibling, which the
+    // system may clear under storage pressure
+    std::string dataPath = app->activity->internalDataPath;
+    assetCache = std::make_unique<AssetCache>(dataPath.substr(0, dataPath.rfind('/')) + "/cache/derived");
     lastFrameTime = std::chrono::high_resolution_clock::now();
     initVulkan();
 }
 
 VulkanRenderer::~VulkanRenderer() {
+    // Loader tasks write into this object; stop them before tearing anything down. A
+    // streaming task may be waiting for a ring block that only render() would free.
+    if (stagingRing) {
+        stagingRing->cancel();
+    }
+    startup.reset();
+    // Tile reads of the virtual textures may still be queued
+    threadPool.reset();
+    decodedTextures.clear();
+    registry.reset();
+
     if (device != VK_NULL_HANDLE) {
         vkDeviceWaitIdle(device);
 
         cleanupSwapChain();
+        stagingRing.reset();
+        textureStreams.clear();
+        retiredStaging.clear();
+        textureStaging.reset();
 
         for (size_t i = 0; i < textureSamplers.size(); i++) {
             if (textureSamplers[i] != VK_NULL_HANDLE) vkDestroySampler(device, textureSamplers[i], nullptr);
@@ -91,6 +265,23 @@ VulkanRenderer::~VulkanRenderer() {
         for (size_t i = 0; i < textureImageMemories.size(); i++) {
             if (textureImageMemories[i] != VK_NULL_HANDLE) vkFreeMemory(device, textureImageMemories[i], nullptr);
         }
+        for (const RetiredTexture& retired : retiredTextures) {
+            vkDestroyImageView(device, retired.view, nullptr);
+            vkDestroyImage(device, retired.image, nullptr);
+            vkFreeMemory(device, retired.memory, nullptr);
+        }
+        if (textureRectBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, textureRectBuffer, nullptr);
+        if (textureRectBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, textureRectBufferMemory, nullptr);
+        if (virtualTextureInfoBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, virtualTextureInfoBuffer, nullptr);
+        if (virtualTextureInfoBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, virtualTextureInfoBufferMemory, nullptr);
+        for (const VirtualFrame& frame : virtualFrames) {
+            vkDestroyBuffer(device, frame.pageTable, nullptr);
+            vkFreeMemory(device, frame.pageTableMemory, nullptr);
+            vkDestroyBuffer(device, frame.feedback, nullptr);
+            vkFreeMemory(device, frame.feedbackMemory, nullptr);
+            vkDestroyBuffer(device, frame.tileStaging, nullptr);
+            vkFreeMemory(device, frame.tileStagingMemory, nullptr);
+        }
 
         if (depthImageView != VK_NULL_HANDLE) vkDestroyImageView(device, depthImageView, nullptr);
         if (depthImage != VK_NULL_HANDLE) vkDestroyImage(device, depthImage, nullptr);
@@ -104,6 +295,21 @@ VulkanRenderer::~VulkanRenderer() {
         if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
         if (descriptorSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 
+        if (mipmapPipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, mipmapPipeline, nullptr);
+        if (mipmapPipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, mipmapPipelineLayout, nullptr);
+        if (mipmapSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, mipmapSetLayout, nullptr);
+
+        if (meshletDescriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, meshletDescriptorPool, nullptr);
+        if (meshletSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, meshletSetLayout, nullptr);
+        if (meshletBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, meshletBuffer, nullptr);
+        if (meshletBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, meshletBufferMemory, nullptr);
+        if (meshletVertexBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, meshletVertexBuffer, nullptr);
+        if (meshletVertexBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, meshletVertexBufferMemory, nullptr);
+        if (meshletTriangleBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, meshletTriangleBuffer, nullptr);
+        if (meshletTriangleBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, meshletTriangleBufferMemory, nullptr);
+        if (modelTransformBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, modelTransformBuffer, nullptr);
+        if (modelTransformBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, modelTransformBufferMemory, nullptr);
+
         if (indexBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, indexBuffer, nullptr);
         if (indexBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, indexBufferMemory, nullptr);
         if (vertexBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, vertexBuffer, nullptr);
@@ -119,6 +325,8 @@ VulkanRenderer::~VulkanRenderer() {
 
         if (graphicsPipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, graphicsPipeline, nullptr);
         if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        if (meshletPipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, meshletPipeline, nullptr);
+        if (meshletPipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, meshletPipelineLayout, nullptr);
 
         if (device != VK_NULL_HANDLE) vkDestroyDevice(device, nullptr);
     }
@@ -137,6 +345,20 @@ VulkanRenderer::~VulkanRenderer() {
 void VulkanRenderer::render() {
     if (app_->window == nullptr) return;
 
+    if (stagingRing) {
+        stagingRing->pump();
+        updateMeshResidency();
+    }
+    if (startup) {
+        if (textureUploadsOpen) {
+            uploadDecodedTextures();
+        }
+        startup->runMainTasks();
+        if (startup->finished()) {
+            startup.reset();
+        }
+    }
+
     drawFrame();
 }
 
@@ -183,33 +405,99 @@ void VulkanRenderer::handleTouchInput(float x1, float y1, float x2, float y2,
 
 void VulkanRenderer::initVulkan() {
     initCamera();
-    
-    createInstance();
-    setupDebugMessenger();
-    createSurface();
-    pickPhysicalDevice();
-    createLogicalDevice();
-
-
-
-    createSwapChain();
-    updateCameraOrientation();
-    createImageViews();
-    createRenderPass();
-    createDescriptorSetLayout();
-    createGraphicsPipeline();
-    createCommandPool();
-    createDepthResources();
-    createFramebuffers();
-    loadModel();  // Load model and parse MTL file
-    createTextures();  // Load all textures, create views and samplers
-    createVertexBuffer();
-    createIndexBuffer();
-    createUniformBuffers();
-    createDescriptorPool();
-    createDescriptorSets();
-    createCommandBuffers();
-    createSyncObjects();
+    threadPool = std::make_unique<ThreadPool>();
+    startup = std::make_unique<TaskGraph>(*threadPool);
+    using Affinity = TaskGraph::Affinity;
+
+    // File IO, OBJ parsing and PNG decode only touch the CPU, so they run on the
+    // workers while this thread creates the swapchain and pipeline. Texture decode
+    // waits for the device to know which .ktx2 variants it can sample.
+    auto model = startup->add("loadModels", Affinity::Worker, [this]() { loadModels(); });
+    auto device = startup->add("device", Affinity::Main, [this]() {
+        createInstance();
+        setupDebugMessenger();
+        createSurface();
+        pickPhysicalDevice();
+        createLogicalDevice();
+        selectTextureVariants();
+        textureBinding = selectTextureBinding();
+        if (textureBinding == TextureBinding::PerTexture || textureBinding == TextureBinding::Bindless) {
+            textureStaging = std::make_unique<TextureStagingRing>(physicalDevice, this->device,
+                                                                  TEXTURE_STAGING_SIZE);
+        }
+        if (textureBinding == TextureBinding::Bindless) {
+            textureTable = std::make_unique<TextureTable>(bindlessCapacity);
+            aout << "Texture binding: bindless table of " << bindlessCapacity << " slots" << std::endl;
+        } else if (textureBinding == TextureBinding::Virtual) {
+            aout << "Texture binding: virtual, a cache of " << VIRTUAL_CACHE_TILES * VIRTUAL_CACHE_TILES << " tiles"
+                 << std::endl;
+        } else {
+            aout << "Texture binding: "
+                 << (textureBinding == TextureBinding::Packed ? "one packed array image" : "one image per texture")
+                 << std::endl;
+        }
+    });
+    auto decode = startup->add("decodeTextures", Affinity::Worker, [this]() { decodeTextures(); }, {model, device});
+
+    auto swapchain = startup->add("swapchain", Affinity::Main, [this]() {
+        createSwapChain();
+        updateCameraOrientation();
+        createImageViews();
+        createRenderPass();
+        createCommandPool();
+        createDepthResources();
+        createFramebuffers();
+        createUniformBuffers();
+        createCommandBuffers();
+        createSyncObjects();
+    }, {device});
+    auto pipeline = startup->add("pipeline", Affinity::Main, [this]() {
+        createDescriptorSetLayout();
+        createGraphicsPipeline();
+    }, {swapchain});
+
+    // Buffers need the loaded sizes and the device; the pipeline decides the vertex
+    // format. The data then streams in from a worker while frames keep presenting.
+    auto meshBuffers = startup->add("meshBuffers", Affinity::Main, [this]() {
+        createStagingRing();
+        createVertexBuffer();
+        createIndexBuffer();
+        createMeshletBuffers();
+        createMeshletDescriptorSet();
+        streamStart = std::chrono::steady_clock::now();
+    }, {model, pipeline});
+    auto meshStream = startup->add("streamMesh", Affinity::Worker, [this]() { streamMesh(); }, {meshBuffers});
+    auto meshUpload = startup->add("releaseMesh", Affinity::Main, [this]() {
+        registry->releaseSources();  // Every block is in the ring or on the GPU
+        meshStreamed = true;
+    }, {meshStream});
+    // Each texture is uploaded between frames as soon as its decode finishes; the
+    // last ones, the views and the samplers follow once all are decoded
+    auto textureTargets = startup->add("prepareTextureUploads", Affinity::Main, [this]() {
+        prepareTextureUploads();
+    }, {model, swapchain});
+    auto textureUpload = startup->add("uploadTextures", Affinity::Main, [this]() {
+        createTextures();
+    }, {decode, textureTargets});
+    auto descriptors = startup->add("descriptors", Affinity::Main, [this]() {
+        createDescriptorPool();
+        createDescriptorSets();
+    }, {textureUpload, pipeline});
+    startup->add("ready", Affinity::Main, [this]() {
+        assetsReady = true;
+    }, {meshBuffers, descriptors});
+    startup->add("report", Affinity::Main, [this]() {
+        aout << "Startup finished:\n" << startup->timingReport() << std::endl;
+        AssetCache::Stats cache = assetCache->stats();
+        aout << "Asset cache: " << cache.hits << " hits, " << cache.misses << " misses, " << cache.stores
+             << " stores, " << cache.evictions << " evictions, " << cache.bytes / (1024 * 1024) << " MB" << std::endl;
+    }, {meshUpload, descriptors});
+
+    startup->start();
+
+    // Block only until frames can be presented; render() runs the remaining main
+    // thread tasks between frames
+    startup->runUntil(pipeline);
 }
 
 void VulkanRenderer::createInstance() {
@@ -245,7 +533,9 @@ void VulkanRenderer::createInstance() {
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = requiredVersion;
+    // 1.1 when available: the meshlet path needs it for SPIR-V 1.4 and the features2 query
+    instanceApiVersion = apiVersion >= VK_API_VERSION_1_1 ? VK_API_VERSION_1_1 : requiredVersion;
+    appInfo.apiVersion = instanceApiVersion;
 
     // Query and print available instance extensions
     uint32_t availableExtensionCount = 0;
@@ -396,16 +686,82 @@ void VulkanRenderer::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // Block-compressed formats are only sampled when their feature is enabled
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+    deviceFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    // Virtual texturing reports the pages it samples from the fragment shader
+    fragmentStoresSupported = supportedFeatures.fragmentStoresAndAtomics == VK_TRUE;
+    deviceFeatures.fragmentStoresAndAtomics = supportedFeatures.fragmentStoresAndAtomics;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+
+    // Mesh shaders are optional; without them meshlets are culled on the CPU. The
+    // feature structs of the optional extensions are chained in front of each other.
+    std::vector<const char*> enabledExtensions = deviceExtensions;
+    void* featureChain = nullptr;
+    meshShadersSupported = checkMeshShaderSupport(availableExtensions);
+#ifdef VK_EXT_mesh_shader
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+    meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+    meshShaderFeatures.taskShader = VK_TRUE;
+    meshShaderFeatures.meshShader = VK_TRUE;
+    if (meshShadersSupported) {
+        enabledExtensions.insert(enabledExtensions.end(), std::begin(meshShaderExtensions), std::end(meshShaderExtensions));
+        meshShaderFeatures.pNext = featureChain;
+        featureChain = &meshShaderFeatures;
+    }
+#endif
+    aout << "Mesh shaders: " << (meshShadersSupported ? "supported" : "not supported") << std::endl;
+
+    // Descriptor indexing is optional too; without it the textures are packed or bound
+    // MAX_PHASE_1_TEXTURES at a time
+    bindlessCapacity = checkBindlessSupport(availableExtensions);
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+    indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+    indexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+    indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    if (bindlessCapacity > 0) {
+        // Core in 1.1, but drivers that still list maintenance3 expect it enabled
+        if (extensionAvailable(availableExtensions, VK_KHR_MAINTENANCE3_EXTENSION_NAME)) {
+            enabledExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+        }
+        enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        indexingFeatures.pNext = featureChain;
+        featureChain = &indexingFeatures;
+    }
+    aout << "Descriptor indexing: "
+         << (bindlessCapacity > 0 ? "supported, " + std::to_string(bindlessCapacity) + " texture slots"
+                                  : std::string("not supported")) << std::endl;
+
+    // The texture budget follows the driver's estimate of the device-local heaps when
+    // it can report one
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    getMemoryProperties2 = nullptr;
+    if (instanceApiVersion >= VK_API_VERSION_1_1 && deviceProperties.apiVersion >= VK_API_VERSION_1_1 &&
+        extensionAvailable(availableExtensions, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        getMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2)vkGetInstanceProcAddr(
+                instance, "vkGetPhysicalDeviceMemoryProperties2");
+        if (getMemoryProperties2 != nullptr) {
+            enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+    }
+    aout << "Memory budget: " << (getMemoryProperties2 != nullptr ? "supported" : "not supported") << std::endl;
+    createInfo.pNext = featureChain;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if (enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -420,6 +776,92 @@ void VulkanRenderer::createLogicalDevice() {
 
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+
+#ifdef VK_EXT_mesh_shader
+    if (meshShadersSupported) {
+        cmdDrawMeshTasks = (PFN_vkCmdDrawMeshTasksEXT)vkGetDeviceProcAddr(device, "vkCmdDrawMeshTasksEXT");
+        meshShadersSupported = cmdDrawMeshTasks != nullptr;
+    }
+#endif
+}
+
+bool VulkanRenderer::checkMeshShaderSupport(const std::vector<VkExtensionProperties>& availableExtensions) {
+#ifdef VK_EXT_mesh_shader
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    if (instanceApiVersion < VK_API_VERSION_1_1 || properties.apiVersion < VK_API_VERSION_1_1) {
+        return false;
+    }
+    for (const char* extension : meshShaderExtensions) {
+        if (!extensionAvailable(availableExtensions, extension)) {
+            return false;
+        }
+    }
+
+    auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2");
+    if (getFeatures2 == nullptr) {
+        return false;
+    }
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+    meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &meshShaderFeatures;
+    getFeatures2(physicalDevice, &features);
+    return meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+#else
+    (void)availableExtensions;
+    return false;
+#endif
+}
+
+uint32_t VulkanRenderer::checkBindlessSupport(const std::vector<VkExtensionProperties>& availableExtensions) {
+    // Returns the slots the bindless table can have, 0 when the device cannot update a
+    // partially bound, variable-sized sampler array after binding it
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    if (instanceApiVersion < VK_API_VERSION_1_1 || properties.apiVersion < VK_API_VERSION_1_1 ||
+        !extensionAvailable(availableExtensions, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+        return 0;
+    }
+
+    auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2");
+    auto getProperties2 =
+            (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2");
+    if (getFeatures2 == nullptr || getProperties2 == nullptr) {
+        return 0;
+    }
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &indexingFeatures;
+    getFeatures2(physicalDevice, &features);
+    if (!indexingFeatures.runtimeDescriptorArray || !indexingFeatures.descriptorBindingPartiallyBound ||
+        !indexingFeatures.descriptorBindingVariableDescriptorCount ||
+        !indexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+        !indexingFeatures.descriptorBindingUpdateUnusedWhilePending) {
+        return 0;
+    }
+
+    // Update-after-bind descriptors have their own limits; the pool holds a table per
+    // frame in flight plus its uniform buffers
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &indexingProperties;
+    getProperties2(physicalDevice, &properties2);
+    uint32_t capacity = std::min({MAX_BINDLESS_TEXTURES,
+                                  indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                                  indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                  indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                                  indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                  indexingProperties.maxPerStageUpdateAfterBindResources});
+    const uint32_t perFrame = indexingProperties.maxUpdateAfterBindDescriptorsInAllPools / MAX_FRAMES_IN_FLIGHT;
+    capacity = std::min(capacity, perFrame > 0 ? perFrame - 1 : 0);
+    // The placeholder alone does not make a table worth having
+    return capacity >= 2 ? capacity : 0;
 }
 
 void VulkanRenderer::createSwapChain() {
@@ -543,32 +985,159 @@ void VulkanRenderer::createDescriptorSetLayout() {
     uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     uboLayoutBinding.pImmutableSamplers = nullptr;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+#ifdef VK_EXT_mesh_shader
+    if (meshShadersSupported) {
+        uboLayoutBinding.stageFlags |= VK_SHADER_STAGE_MESH_BIT_EXT;
+    }
+#endif
 
+    // Packed textures are one array image plus the table of where each texture sits in
+    // it; bindless ones a table of bindlessCapacity slots, of which each set allocates all.
+    // Virtual ones are the tile cache, the texture table, the page table and the feedback.
     VkDescriptorSetLayoutBinding samplerLayoutBinding{};
     samplerLayoutBinding.binding = 1;
     samplerLayoutBinding.descriptorCount = MAX_PHASE_1_TEXTURES;
+    if (textureBinding == TextureBinding::Packed || textureBinding == TextureBinding::Virtual) {
+        samplerLayoutBinding.descriptorCount = 1;
+    } else if (textureBinding == TextureBinding::Bindless) {
+        samplerLayoutBinding.descriptorCount = bindlessCapacity;
+    }
     samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     samplerLayoutBinding.pImmutableSamplers = nullptr;
     samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
+    VkDescriptorSetLayoutBinding rectLayoutBinding{};
+    rectLayoutBinding.binding = 2;
+    rectLayoutBinding.descriptorCount = 1;
+    rectLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    rectLayoutBinding.pImmutableSamplers = nullptr;
+    rectLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {uboLayoutBinding, samplerLayoutBinding};
+    if (textureBinding == TextureBinding::Packed || textureBinding == TextureBinding::Virtual) {
+        bindings.push_back(rectLayoutBinding);
+    }
+    if (textureBinding == TextureBinding::Virtual) {
+        for (uint32_t binding : {3u, 4u}) {
+            rectLayoutBinding.binding = binding;
+            bindings.push_back(rectLayoutBinding);
+        }
+    }
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
     layoutInfo.pBindings = bindings.data();
 
+    // Bindless: slots are written while frames that do not sample them are in flight,
+    // and the ones never written are not an error. The texture table is the last binding,
+    // as a variable count requires.
+    std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags = {
+            0,
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT,
+    };
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+    if (textureBinding == TextureBinding::Bindless) {
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        layoutInfo.pNext = &bindingFlagsInfo;
+    }
+
     if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor set layout!");
     }
+
+#ifdef VK_EXT_mesh_shader
+    // Set 1 of the meshlet pipeline: meshlets, vertices, meshlet vertices, meshlet
+    // triangles, model transforms
+    if (meshShadersSupported) {
+        std::array<VkDescriptorSetLayoutBinding, 5> meshletBindings{};
+        for (uint32_t i = 0; i < meshletBindings.size(); i++) {
+            meshletBindings[i].binding = i;
+            meshletBindings[i].descriptorCount = 1;
+            meshletBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            meshletBindings[i].stageFlags = VK_SHADER_STAGE_MESH_BIT_EXT;
+        }
+        meshletBindings[0].stageFlags |= VK_SHADER_STAGE_TASK_BIT_EXT;
+
+        VkDescriptorSetLayoutCreateInfo meshletLayoutInfo{};
+        meshletLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        meshletLayoutInfo.bindingCount = static_cast<uint32_t>(meshletBindings.size());
+        meshletLayoutInfo.pBindings = meshletBindings.data();
+        if (vkCreateDescriptorSetLayout(device, &meshletLayoutInfo, nullptr, &meshletSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create meshlet descriptor set layout!");
+        }
+    }
+#endif
+}
+
+bool VulkanRenderer::supportsPackedVertices() {
+    for (VkFormat format : {VK_FORMAT_R16G16B16A16_SNORM, VK_FORMAT_R16G16_UNORM}) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+        if (!(properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VulkanRenderer::supportsFragmentVariant(const char* entryPoint, const char* glslFile) {
+    // Decided before the descriptor set layout; like the packed vertices, a variant is
+    // only used when the SPIR-V in the assets has it
+    if (useCombinedSPIRV) {
+        return spirvHasEntryPoint(readFile("shader.spv"), entryPoint);
+    }
+    return static_cast<bool>(assets->open(glslFile));
+}
+
+VulkanRenderer::TextureBinding VulkanRenderer::selectTextureBinding() {
+    if (virtualTexturing && fragmentStoresSupported &&
+        supportsFragmentVariant("fragmentMainVirtual", "shader_virtual.frag.spv")) {
+        return TextureBinding::Virtual;
+    }
+    if (bindlessTextures && bindlessCapacity > 0 &&
+        supportsFragmentVariant("fragmentMainBindless", "shader_bindless.frag.spv")) {
+        return TextureBinding::Bindless;
+    }
+    if (packTextures && supportsFragmentVariant("fragmentMainAtlas", "shader_atlas.frag.spv")) {
+        return TextureBinding::Packed;
+    }
+    return TextureBinding::PerTexture;
 }
 
 void VulkanRenderer::createGraphicsPipeline() {
     VkShaderModule vertShaderModule;
     VkShaderModule fragShaderModule;
 
+    // The meshlet path needs its SPIR-V (meshlet.task / meshlet.mesh) and reads float
+    // vertices from a storage buffer, so it rules out the packed format
+    AssetData taskShaderCode;
+    AssetData meshShaderCode;
+    if (meshShadersSupported) {
+        taskShaderCode = assets->open("meshlet.task.spv");
+        meshShaderCode = assets->open("meshlet.mesh.spv");
+    }
+    bool meshlets = taskShaderCode && meshShaderCode;
+
+    // The packed variant needs its shader entry point; SPIR-V built without it keeps
+    // the float vertices
+    bool packed = !meshlets && supportsPackedVertices();
+    const char* vertexEntry = "main";
+    const char* fragmentEntry = "main";
+
     if (useCombinedSPIRV) {
         // Load single SPIR-V file with both vertex and fragment shaders (Slang)
         auto combinedShaderCode = readFile("shader.spv");
+        packed = packed && spirvHasEntryPoint(combinedShaderCode, "vertexMainPacked");
+        fragmentEntry = textureBinding == TextureBinding::Virtual  ? "fragmentMainVirtual"
+                      : textureBinding == TextureBinding::Bindless ? "fragmentMainBindless"
+                      : textureBinding == TextureBinding::Packed   ? "fragmentMainAtlas"
+                                                                   : "fragmentMain";
+        vertexEntry = packed ? "vertexMainPacked" : "vertexMain";
 
         // Create shader modules for each stage from the same SPIR-V code
         // The entry points are specified in the pipeline stage info
@@ -576,32 +1145,41 @@ void VulkanRenderer::createGraphicsPipeline() {
         fragShaderModule = createShaderModule(combinedShaderCode);
     } else {
         // Load separate SPIR-V files (GLSL)
-        auto vertShaderCode = readFile("shader.vert.spv");
-        auto fragShaderCode = readFile("shader.frag.spv");
+        AssetData packedShader = packed ? assets->open("shader_packed.vert.spv") : AssetData{};
+        packed = static_cast<bool>(packedShader);
+
+        auto vertShaderCode = packed ? packedShader : readFile("shader.vert.spv");
+        auto fragShaderCode = readFile(textureBinding == TextureBinding::Virtual    ? "shader_virtual.frag.spv"
+                                       : textureBinding == TextureBinding::Bindless ? "shader_bindless.frag.spv"
+                                       : textureBinding == TextureBinding::Packed   ? "shader_atlas.frag.spv"
+                                                                                    : "shader.frag.spv");
 
         vertShaderModule = createShaderModule(vertShaderCode);
         fragShaderModule = createShaderModule(fragShaderCode);
     }
 
+    vertexFormat = packed ? VertexFormat::Packed : VertexFormat::Float;
+    aout << "Vertex format: " << (packed ? "packed (12 bytes)" : "float (32 bytes)") << std::endl;
+
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
     vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = useCombinedSPIRV ? "vertexMain" : "main";
+    vertShaderStageInfo.pName = vertexEntry;
 
     VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
     fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = useCombinedSPIRV ? "fragmentMain" : "main";
+    fragShaderStageInfo.pName = fragmentEntry;
 
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    auto bindingDescription = getVertexBindingDescription(vertexFormat);
+    auto attributeDescriptions = getVertexAttributeDescriptions(vertexFormat);
 
     vertexInputInfo.vertexBindingDescriptionCount = 1;
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -670,6 +1248,14 @@ void VulkanRenderer::createGraphicsPipeline() {
     pipelineLayoutInfo.setLayoutCount = 1;
     pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
 
+    // Texture of the draw range and dequantization constants of the packed vertex shader
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(DrawPushConstants);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
     }
@@ -695,10 +1281,73 @@ void VulkanRenderer::createGraphicsPipeline() {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
 
+    if (meshlets) {
+        createMeshletPipeline(taskShaderCode, meshShaderCode, fragShaderStageInfo, pipelineInfo);
+    }
+    aout << "Meshlet path: " << (useMeshShaders ? "task/mesh shaders" : "CPU culling") << std::endl;
+
     vkDestroyShaderModule(device, fragShaderModule, nullptr);
     vkDestroyShaderModule(device, vertShaderModule, nullptr);
 }
 
+void VulkanRenderer::createMeshletPipeline(const AssetData& taskCode, const AssetData& meshCode,
+                                           const VkPipelineShaderStageCreateInfo& fragmentStage,
+                                           VkGraphicsPipelineCreateInfo pipelineInfo) {
+#ifdef VK_EXT_mesh_shader
+    VkShaderModule taskShaderModule = createShaderModule(taskCode);
+    VkShaderModule meshShaderModule = createShaderModule(meshCode);
+
+    VkPipelineShaderStageCreateInfo shaderStages[3] = {};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_TASK_BIT_EXT;
+    shaderStages[0].module = taskShaderModule;
+    shaderStages[0].pName = "main";
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_MESH_BIT_EXT;
+    shaderStages[1].module = meshShaderModule;
+    shaderStages[1].pName = "main";
+    shaderStages[2] = fragmentStage;
+
+    std::array<VkDescriptorSetLayout, 2> setLayouts = {descriptorSetLayout, meshletSetLayout};
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(MeshletPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &meshletPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet pipeline layout!");
+    }
+
+    // Same fixed function state as the vertex pipeline, minus vertex input and assembly
+    pipelineInfo.stageCount = 3;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = nullptr;
+    pipelineInfo.pInputAssemblyState = nullptr;
+    pipelineInfo.layout = meshletPipelineLayout;
+
+    // A driver that rejects the pipeline leaves the CPU culling path in charge
+    useMeshShaders = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &meshletPipeline) == VK_SUCCESS;
+    if (!useMeshShaders) {
+        meshletPipeline = VK_NULL_HANDLE;
+        aout << "Warning: failed to create the meshlet pipeline" << std::endl;
+    }
+
+    vkDestroyShaderModule(device, meshShaderModule, nullptr);
+    vkDestroyShaderModule(device, taskShaderModule, nullptr);
+#else
+    (void)taskCode;
+    (void)meshCode;
+    (void)fragmentStage;
+    (void)pipelineInfo;
+#endif
+}
+
 void VulkanRenderer::createCommandPool() {
     QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
 
@@ -811,483 +1460,2113 @@ void VulkanRenderer::createFramebuffers() {
     }
 }
 
-void VulkanRenderer::loadSingleTexture(const std::string& filename, int textureIndex) {
-    auto assetManager = app_->activity->assetManager;
+DecodedTexture VulkanRenderer::decodeTexture(const std::string& filename, bool allowEncoded) {
+    DecodedTexture texture;
+    texture.filename = filename;
+    if (filename.empty()) {
+        return texture;  // Untextured model, uploads as white
+    }
+
+    // A pre-encoded variant the device samples is uploaded instead of the PNG, and
+    // failing that a Basis file transcoded to one
+    if (allowEncoded && (decodeKtx2Texture(filename, texture) || decodeBasisTexture(filename, texture))) {
+        return texture;
+    }
 
-    AAsset* asset = AAssetManager_open(assetManager, filename.c_str(), AASSET_MODE_STREAMING);
+    // PNGs are stored uncompressed in the APK, so stb decodes straight from the mapping
+    AssetData asset = assets->open(filename);
     if (!asset) {
         aout << "Warning: Could not open texture file: " << filename << std::endl;
-        return;
+        return texture;
     }
 
-    size_t assetLength = AAsset_getLength(asset);
-    std::vector<unsigned char> assetData(assetLength);
-    AAsset_read(asset, assetData.data(), assetLength);
-    AAsset_close(asset);
+    // Progressive bindless uploads take the whole chain, built here on the worker
+    const bool buildChain = textureBinding == TextureBinding::Bindless && progressiveTextures;
 
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load_from_memory(assetData.data(), assetLength, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+    // A texture decoded by an earlier launch is mapped instead of decoded again
+    const std::string cacheKey =
+            AssetCache::makeKey("texture", TEXTURE_CACHE_VERSION, hashBytes(asset.data, asset.size));
+    if (AssetData cached = assetCache->load(cacheKey)) {
+        TextureCacheHeader header{};
+        if (cached.size >= sizeof(header)) {
+            std::memcpy(&header, cached.data, sizeof(header));
+        }
+        if (header.magic == TEXTURE_CACHE_MAGIC &&
+            cached.size == sizeof(header) + size_t(header.width) * header.height * 4) {
+            texture.width = int(header.width);
+            texture.height = int(header.height);
+            texture.pixels = AssetData{cached.bytes() + sizeof(header), cached.size - sizeof(header), cached.owner};
+            // Copied here rather than at upload, off the main thread
+            if (buildChain) {
+                buildMipChain(texture, {});
+            } else if (AssetData staging = allocateTextureStaging(texture.pixels.size)) {
+                memcpy(const_cast<void*>(staging.data), texture.pixels.data, texture.pixels.size);
+                texture.pixels = staging;
+            }
+            return texture;
+        }
+        aout << "Warning: Ignoring corrupt cache entry for " << filename << std::endl;
+    }
 
+    // The decoder writes its RGBA8 result straight into the staging ring when there is
+    // room, so the upload has nothing to allocate or copy
+    int texChannels;
+    AssetData staging;
+    if (stbi_info_from_memory(asset.bytes(), static_cast<int>(asset.size), &texture.width, &texture.height,
+                              &texChannels)) {
+        const uint32_t width = static_cast<uint32_t>(texture.width);
+        const uint32_t height = static_cast<uint32_t>(texture.height);
+        staging = allocateTextureStaging(buildChain ? mipChainBytes(width, height, mipChainLevels(width, height))
+                                                    : size_t(width) * height * 4);
+    }
+    decodeTarget = {static_cast<uint8_t*>(const_cast<void*>(staging.data)), size_t(texture.width) * texture.height * 4,
+                    false};
+    stbi_uc* pixels = stbi_load_from_memory(asset.bytes(), static_cast<int>(asset.size), &texture.width,
+                                            &texture.height, &texChannels, STBI_rgb_alpha);
+    decodeTarget = {};
     if (!pixels) {
         aout << "Warning: Failed to load texture: " << filename << std::endl;
-        return;
+        return texture;
     }
-
-    aout << "Loading texture [" << textureIndex << "]: " << filename
-         << " (" << texWidth << "x" << texHeight << ")" << std::endl;
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 stagingBuffer, stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(device, stagingBufferMemory);
-
-    stbi_image_free(pixels);
-
-    VkImage image;
-    VkDeviceMemory imageMemory;
-
-    createImage(texWidth, texHeight, 1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB,
-                VK_IMAGE_TILING_OPTIMAL,
-                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
-
-    transitionImageLayout(image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
-    copyBufferToImage(stagingBuffer, image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
-
-    transitionImageLayout(image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
-
-    textureImages.push_back(image);
-    textureImageMemories.push_back(imageMemory);
-}
-
-void VulkanRenderer::createTextures() {
-    aout << "Creating textures for " << materialToTextureFile.size() << " materials" << std::endl;
-
-    // Build a map from texture filename to array index
-    std::map<std::string, int> textureFileToIndex;
-    
-    // Get all unique texture filenames from materials (sorted for consistent ordering)
-    std::set<std::string> textureFilenames;
-    for (const auto& pair : materialToTextureFile) {
-        textureFilenames.insert(pair.second);
-        aout << "Material " << pair.first << " -> " << pair.second << std::endl;
+    const size_t size = size_t(texture.width) * texture.height * 4;
+    if (staging && pixels == staging.data) {
+        texture.pixels = AssetData{staging.data, size, staging.owner};
+    } else {
+        texture.pixels = AssetData{pixels, size, std::shared_ptr<const void>(pixels, stbi_image_free)};
     }
 
-    // For Phase 1, ensure we don't exceed MAX_PHASE_1_TEXTURES
-    if (textureFilenames.size() > MAX_PHASE_1_TEXTURES) {
-        throw std::runtime_error("Too many textures for Phase 1! Use Phase 2 (Bindless) for 100+ textures.");
+    TextureCacheHeader header{TEXTURE_CACHE_MAGIC, uint32_t(texture.width), uint32_t(texture.height), 0};
+    assetCache->store(cacheKey, &header, sizeof(header), pixels, size);
+    if (buildChain) {
+        buildMipChain(texture, staging);
     }
+    return texture;
+}
 
-    aout << "Total unique textures to load: " << textureFilenames.size() << std::endl;
-
-    // Load all textures and build filename->index mapping
-    int index = 0;
-    for (const auto& filename : textureFilenames) {
-        loadSingleTexture(filename, index);
-        textureFileToIndex[filename] = index;
-        index++;
+void VulkanRenderer::buildMipChain(DecodedTexture& texture, AssetData storage) {
+    // The levels follow level 0 in one allocation: storage when the decode already made
+    // room for them, else a new ring range, else the heap
+    const uint32_t width = static_cast<uint32_t>(texture.width);
+    const uint32_t height = static_cast<uint32_t>(texture.height);
+    const uint32_t levelCount = mipChainLevels(width, height);
+    const size_t bytes = mipChainBytes(width, height, levelCount);
+    if (!storage) {
+        storage = allocateTextureStaging(bytes);
     }
-
-    numTextures = index;
-    aout << "Loaded " << numTextures << " texture images" << std::endl;
-
-    // Build old index to new index mapping before updating materialToTextureIndex
-    std::unordered_map<int, int> oldToNewIndexMap;
-    for (const auto& pair : materialToTextureIndex) {
-        const std::string& materialName = pair.first;
-        int oldIndex = pair.second;
-        if (materialToTextureFile.count(materialName)) {
-            const std::string& textureFile = materialToTextureFile[materialName];
-            int newIndex = textureFileToIndex[textureFile];
-            oldToNewIndexMap[oldIndex] = newIndex;
-        }
-    }
-
-    // Update materialToTextureIndex to use the correct array indices
-    for (auto& pair : materialToTextureIndex) {
-        const std::string& materialName = pair.first;
-        if (materialToTextureFile.count(materialName)) {
-            const std::string& textureFile = materialToTextureFile[materialName];
-            pair.second = textureFileToIndex[textureFile];
-            aout << "Updated material " << materialName << " -> texture index " << pair.second 
-                 << " (file: " << textureFile << ")" << std::endl;
-        }
-    }
-
-    // Update all vertex texture indices that were created with old indices
-    aout << "Remapping vertex texture indices..." << std::endl;
-    for (auto& vertex : vertices) {
-        if (oldToNewIndexMap.count(vertex.texIndex)) {
-            int oldIdx = vertex.texIndex;
-            vertex.texIndex = oldToNewIndexMap[oldIdx];
-            if (oldIdx != vertex.texIndex) {
-                static int remapCount = 0;
-                if (remapCount < 5) {  // Log first few remappings
-                    aout << "  Vertex texIndex remapped: " << oldIdx << " -> " << vertex.texIndex << std::endl;
-                    remapCount++;
-                }
-            }
-        }
+    if (!storage) {
+        auto heap = std::make_shared<std::vector<uint8_t>>(bytes);
+        storage = AssetData{heap->data(), bytes, heap};
     }
-    aout << "Vertex texture index remapping complete" << std::endl;
-
-    // Create image views
-    for (size_t i = 0; i < textureImages.size(); i++) {
-        textureImageViews.push_back(createImageView(textureImages[i], VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, 1));
+    uint8_t* chain = static_cast<uint8_t*>(const_cast<void*>(storage.data));
+    if (texture.pixels.data != chain) {
+        memcpy(chain, texture.pixels.data, texture.pixels.size);
     }
-    aout << "Created " << textureImageViews.size() << " texture image views" << std::endl;
-
-    // Create samplers (one per texture for Phase 1)
-    VkPhysicalDeviceProperties properties{};
-    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
-    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
-    samplerInfo.mipLodBias = 0.0f;
 
-    for (size_t i = 0; i < numTextures; i++) {
-        VkSampler sampler;
-        if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create texture sampler!");
+    size_t offset = 0;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        const uint32_t levelWidth = std::max(width >> level, 1u);
+        const uint32_t levelHeight = std::max(height >> level, 1u);
+        const size_t size = size_t(levelWidth) * levelHeight * 4;
+        if (level > 0) {
+            const AssetData& above = texture.levels.back();
+            downsampleRgba8Srgb(above.bytes(), std::max(width >> (level - 1), 1u), std::max(height >> (level - 1), 1u),
+                                chain + offset);
         }
-        textureSamplers.push_back(sampler);
+        texture.levels.push_back(AssetData{chain + offset, size, storage.owner});
+        offset += size;
     }
-    aout << "Created " << textureSamplers.size() << " texture samplers" << std::endl;
+    texture.pixels = {};
 }
 
-void VulkanRenderer::parseMTLFile(const std::string& mtlFilename) {
-    auto assetManager = app_->activity->assetManager;
-
-    AAsset* asset = AAssetManager_open(assetManager, mtlFilename.c_str(), AASSET_MODE_STREAMING);
-    if (!asset) {
-        aout << "Warning: Could not open MTL file: " << mtlFilename << std::endl;
-        return;
+AssetData VulkanRenderer::allocateTextureStaging(size_t size) {
+    if (!textureStaging) {
+        return {};
     }
-
-    size_t assetLength = AAsset_getLength(asset);
-    std::string mtlData(assetLength, '\0');
-    AAsset_read(asset, mtlData.data(), assetLength);
-    AAsset_close(asset);
-
-    std::istringstream stream(mtlData);
-    std::string line;
-    std::string currentMaterial;
-
-    aout << "Parsing MTL file: " << mtlFilename << std::endl;
-
-    while (std::getline(stream, line)) {
-        std::istringstream lineStream(line);
-        std::string token;
-        lineStream >> token;
-
-        if (token == "newmtl") {
-            lineStream >> currentMaterial;
-            aout << "Found material: " << currentMaterial << std::endl;
-        } else if (token == "map_Kd" || token == "map_Ka") {
-            std::string textureFile;
-            lineStream >> textureFile;
-
-            // Material might not have explicit texture in MTL, infer from naming
-            if (textureFile.empty()) {
-                // Try to infer texture name from material name
-                // Material: "lambert5SG.001" -> "lambert5SG_baseColor.png"
-                std::string inferredTexture = currentMaterial;
-
-                // Remove .001 suffix if present
-                size_t dotPos = currentMaterial.find('.');
-                if (dotPos != std::string::npos) {
-                    inferredTexture = currentMaterial.substr(0, dotPos);
-                }
-
-                inferredTexture += "_baseColor.png";
-                materialToTextureFile[currentMaterial] = inferredTexture;
-                aout << "No explicit texture for " << currentMaterial << ", inferred: " << inferredTexture << std::endl;
-            } else {
-                materialToTextureFile[currentMaterial] = textureFile;
-                aout << "Material " << currentMaterial << " -> texture: " << textureFile << std::endl;
-            }
-        }
+    uint8_t* data = textureStaging->allocate(size);
+    if (data == nullptr) {
+        return {};
     }
+    TextureStagingRing* ring = textureStaging.get();
+    return AssetData{data, size, std::shared_ptr<const void>(data, [ring](const void* range) { ring->release(range); })};
+}
 
-    // Also check if materials without explicit textures should try inferred names
-    // First scan all materials in the MTL
-    stream.clear();
-    stream.seekg(0);
-    std::set<std::string> allMaterials;
-    while (std::getline(stream, line)) {
-        std::istringstream lineStream(line);
-        std::string token;
-        lineStream >> token;
-        if (token == "newmtl") {
-            lineStream >> currentMaterial;
-            allMaterials.insert(currentMaterial);
+bool VulkanRenderer::decodeKtx2Texture(const std::string& filename, DecodedTexture& texture) {
+    const size_t dot = filename.find_last_of('.');
+    const std::string stem = filename.substr(0, dot);
+    for (const std::string& variant : textureVariants) {
+        const std::string path = stem + "." + variant + ".ktx2";
+        AssetData asset = assets->open(path);
+        if (asset && readKtx2Texture(asset, path, texture)) {
+            return true;
         }
     }
+    return false;
+}
 
-    // For materials without texture reference, try inferred names
-    for (const auto& material : allMaterials) {
-        if (materialToTextureFile.find(material) == materialToTextureFile.end()) {
-            std::string inferredTexture = material;
-            size_t dotPos = material.find('.');
-            if (dotPos != std::string::npos) {
-                inferredTexture = material.substr(0, dotPos);
-            }
-            inferredTexture += "_baseColor.png";
-            materialToTextureFile[material] = inferredTexture;
-            aout << "Inferred texture for " << material << ": " << inferredTexture << std::endl;
+bool VulkanRenderer::readKtx2Texture(const AssetData& asset, const std::string& path, DecodedTexture& texture) {
+    try {
+        Ktx2Texture ktx = readKtx2File(asset);
+        const VkFormat format = static_cast<VkFormat>(ktx.vkFormat);
+        if (!isSampledFormatSupported(format)) {
+            aout << "Warning: Skipping " << path << ", format " << ktx.vkFormat << " is not supported" << std::endl;
+            return false;
         }
+        texture.width = static_cast<int>(ktx.width);
+        texture.height = static_cast<int>(ktx.height);
+        texture.format = format;
+        texture.levels = std::move(ktx.levels);
+        return true;
+    } catch (const std::exception& e) {
+        aout << "Warning: Skipping " << path << ": " << e.what() << std::endl;
     }
+    return false;
 }
 
-void VulkanRenderer::loadModel() {
-    auto assetManager = app_->activity->assetManager;
-
-    AAsset* asset = AAssetManager_open(assetManager, "logo.obj", AASSET_MODE_STREAMING);
+bool VulkanRenderer::decodeBasisTexture(const std::string& filename, DecodedTexture& texture) {
+    const std::string path = filename.substr(0, filename.find_last_of('.')) + ".basis.ktx2";
+    AssetData asset = assets->open(path);
     if (!asset) {
-        throw std::runtime_error("failed to open model asset!");
-    }
-
-    size_t assetLength = AAsset_getLength(asset);
-    std::vector<char> assetData(assetLength);
-    AAsset_read(asset, assetData.data(), assetLength);
-    AAsset_close(asset);
-
-    // Find MTL file reference and parse OBJ manually to get material assignments
-    std::string mtlFilename;
-    std::istringstream objStream(std::string(assetData.begin(), assetData.end()));
-    std::string line;
-
-    // First pass: Find MTL file
-    std::istringstream objStream2(std::string(assetData.begin(), assetData.end()));
-    while (std::getline(objStream2, line)) {
-        std::istringstream lineStream(line);
-        std::string token;
-        lineStream >> token;
-        if (token == "mtllib") {
-            lineStream >> mtlFilename;
-            break;
+        return false;
+    }
+    // A file transcoded by an earlier launch is mapped from the asset cache like a variant.
+    // The target format is part of the key: a cache restored on another GPU misses.
+    const std::string key = AssetCache::makeKey(
+            "basis", TRANSCODE_CACHE_VERSION,
+            hashBytes(&transcodeFormat, sizeof(transcodeFormat), hashBytes(asset.data, asset.size)));
+    if (AssetData cached = assetCache->load(key)) {
+        if (readKtx2Texture(cached, path + " (transcoded)", texture)) {
+            return true;
         }
     }
 
-    // Parse MTL file to get material-to-texture mapping
-    if (!mtlFilename.empty()) {
-        parseMTLFile(mtlFilename);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> file;
+    try {
+        file = transcodeBasisKtx2(asset, transcodeFormat, transcodeAlphaFormat);
+    } catch (const std::exception& e) {
+        aout << "Warning: Skipping " << path << ": " << e.what() << std::endl;
+        return false;
     }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    aout << "Transcoded " << path << " in " << ms << " ms (" << asset.size / 1024 << " KB -> " << file.size() / 1024
+         << " KB)" << std::endl;
 
-    // Use tinyobj_loader for geometry, then apply materials from usemtl statements
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string err;
-
-    objStream.clear();
-    objStream.seekg(0);
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, &objStream, nullptr)) {
-        throw std::runtime_error(err);
+    AssetData stored;
+    if (assetCache->store(key, file.data(), file.size(), nullptr, 0)) {
+        stored = assetCache->load(key);
     }
+    if (!stored) {
+        // The cache is full or not writable; the levels stay on the heap
+        auto owned = std::make_shared<std::vector<uint8_t>>(std::move(file));
+        stored = AssetData{owned->data(), owned->size(), owned};
+    }
+    return readKtx2Texture(stored, path + " (transcoded)", texture);
+}
 
-    // Parse OBJ file again to find usemtl statements and their positions
-    struct FaceWithMaterial {
-        int v1, v2, v3;
-        int vt1, vt2, vt3;
-        int matId;
-    };
-    std::vector<FaceWithMaterial> faces;
+bool VulkanRenderer::isSampledFormatSupported(VkFormat format) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (properties.optimalTilingFeatures & required) == required;
+}
 
-    std::istringstream objStream3(std::string(assetData.begin(), assetData.end()));
-    std::string currentMaterialName = "";
-    int currentMatId = 0;
+void VulkanRenderer::uploadTexture(const DecodedTexture& texture, int textureIndex, uint32_t firstLevel) {
+    if (!texture.levels.empty()) {
+        uploadEncodedTexture(texture, textureIndex, firstLevel);
+        return;
+    }
 
-    aout << "Parsing OBJ for material assignments..." << std::endl;
+    // Missing textures become a single white texel so every range's texture stays valid
+    static const unsigned char placeholderPixel[4] = {255, 255, 255, 255};
+    const unsigned char* pixels = texture.pixels ? texture.pixels.bytes() : placeholderPixel;
+    int texWidth = texture.pixels ? texture.width : 1;
+    int texHeight = texture.pixels ? texture.height : 1;
+    VkDeviceSize imageSize = texWidth * texHeight * 4;
 
-    while (std::getline(objStream3, line)) {
-        if (line.empty() || line[0] == '#') continue;
+    // Pixels decoded into the staging ring are copied from where they are; the range
+    // goes back when the caller drops the texture, after this upload has completed
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+    VkDeviceSize stagingOffset = 0;
+    if (textureStaging && textureStaging->contains(pixels)) {
+        stagingBuffer = textureStaging->buffer();
+        stagingOffset = textureStaging->offsetOf(pixels);
+    } else {
+        createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     stagingBuffer, stagingBufferMemory);
 
-        std::istringstream lineStream(line);
-        std::string token;
-        lineStream >> token;
+        void* data;
+        vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
+        memcpy(data, pixels, static_cast<size_t>(imageSize));
+        vkUnmapMemory(device, stagingBufferMemory);
+    }
 
-        if (token == "usemtl") {
-            lineStream >> currentMaterialName;
-            // Find texture index for this material
-            if (materialToTextureIndex.find(currentMaterialName) == materialToTextureIndex.end()) {
-                int newIndex = materialToTextureIndex.size();
-                materialToTextureIndex[currentMaterialName] = newIndex;
-                aout << "New material from usemtl: " << currentMaterialName << " -> texture index: " << newIndex << std::endl;
-            }
-            currentMatId = materialToTextureIndex[currentMaterialName];
-        } else if (token == "f") {
-            // Parse face: f v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3
-            FaceWithMaterial face;
-            face.matId = currentMatId;
-
-            std::string part;
-            int component = 0;
-
-            while (lineStream >> part && component < 3) {
-                // Parse v/vt/vn
-                std::istringstream partStream(part);
-                std::string indexStr;
-                int v = -1, vt = -1, vn = -1;
-
-                if (std::getline(partStream, indexStr, '/') && !indexStr.empty()) {
-                    v = std::stoi(indexStr);
-                }
-                if (std::getline(partStream, indexStr, '/') && !indexStr.empty()) {
-                    vt = std::stoi(indexStr);
-                }
-                if (std::getline(partStream, indexStr, '/') && !indexStr.empty()) {
-                    vn = std::stoi(indexStr);
-                }
+    // Full chain down to 1x1 when it can be built on the GPU
+    const bool computeMips = !linearBlitSupported && mipmapPipeline != VK_NULL_HANDLE;
+    uint32_t mipLevels = 1;
+    if (linearBlitSupported || computeMips) {
+        mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+    }
 
-                if (component == 0) { face.v1 = v; face.vt1 = vt; }
-                else if (component == 1) { face.v2 = v; face.vt2 = vt; }
-                else if (component == 2) { face.v3 = v; face.vt3 = vt; }
+    aout << "Loading texture [" << textureIndex << "]: " << texture.filename
+         << " (" << texWidth << "x" << texHeight << ", " << mipLevels << " mip levels)" << std::endl;
 
-                component++;
-            }
+    VkImage image;
+    VkDeviceMemory imageMemory;
 
-            // OBJ indices are 1-based, convert to 0-based
-            face.v1--; face.v2--; face.v3--;
-            face.vt1--; face.vt2--; face.vt3--;
+    // Blits read the level above; trims copy the kept levels into a smaller image
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (linearBlitSupported || textureResidency) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    createImage(texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB,
+                VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
 
-            // Only add face if we got valid indices
-            if (face.v1 >= 0 && face.v2 >= 0 && face.v3 >= 0) {
-                faces.push_back(face);
-            }
+    transitionImageLayout(image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+    if (mipLevels > 1 && computeMips) {
+        generateMipmapsCompute(stagingBuffer, image, texWidth, texHeight, mipLevels, 0, stagingOffset);
+    } else {
+        copyBufferToImage(stagingBuffer, image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight),
+                          stagingOffset);
+        if (mipLevels > 1) {
+            generateMipmaps(image, texWidth, texHeight, mipLevels);
+        } else {
+            transitionImageLayout(image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
         }
     }
 
-    aout << "Parsed " << faces.size() << " faces with material assignments" << std::endl;
-    aout << "Total materials found: " << materialToTextureIndex.size() << std::endl;
+    if (stagingBufferMemory != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        vkFreeMemory(device, stagingBufferMemory, nullptr);
+    }
 
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+    textureImages[textureIndex] = image;
+    textureImageMemories[textureIndex] = imageMemory;
+    textureMipLevels[textureIndex] = mipLevels;
+    textureFormats[textureIndex] = VK_FORMAT_R8G8B8A8_SRGB;
+    textureExtents[textureIndex] = {static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)};
+}
+
+void VulkanRenderer::uploadEncodedTexture(const DecodedTexture& texture, int textureIndex, uint32_t firstLevel) {
+    // Levels from firstLevel on are copied now; the finer ones of a progressive upload
+    // stay in TRANSFER_DST for recordTextureStreams. Levels already in the staging ring
+    // are copied from there, the others share one staging buffer; 16-byte offsets are
+    // multiples of every block size.
+    const uint32_t mipLevels = static_cast<uint32_t>(texture.levels.size());
+    std::vector<VkDeviceSize> offsets(mipLevels, 0);
+    std::vector<bool> inRing(mipLevels, false);
+    VkDeviceSize stagingSize = 0;
+    VkDeviceSize uploadSize = 0;
+    for (uint32_t level = firstLevel; level < mipLevels; level++) {
+        const AssetData& data = texture.levels[level];
+        uploadSize += data.size;
+        if (textureStaging && textureStaging->contains(data.data)) {
+            offsets[level] = textureStaging->offsetOf(data.data);
+            inRing[level] = true;
+        } else {
+            offsets[level] = stagingSize;
+            stagingSize += (data.size + 15) & ~VkDeviceSize(15);
+        }
+    }
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+    if (stagingSize > 0) {
+        createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     stagingBuffer, stagingBufferMemory);
+
+        void* data;
+        vkMapMemory(device, stagingBufferMemory, 0, stagingSize, 0, &data);
+        for (uint32_t level = firstLevel; level < mipLevels; level++) {
+            if (!inRing[level]) {
+                memcpy(static_cast<char*>(data) + offsets[level], texture.levels[level].data,
+                       texture.levels[level].size);
+            }
+        }
+        vkUnmapMemory(device, stagingBufferMemory);
+    }
+
+    const uint32_t width = static_cast<uint32_t>(texture.width);
+    const uint32_t height = static_cast<uint32_t>(texture.height);
+    aout << "Loading texture [" << textureIndex << "]: " << texture.filename << " (" << width << "x" << height
+         << ", " << mipLevels << " prebuilt mip levels, format " << texture.format << ", " << uploadSize / 1024
+         << " KB";
+    if (firstLevel > 0) {
+        aout << " now, " << firstLevel << " levels to stream";
+    }
+    aout << ")" << std::endl;
+
+    VkImage image;
+    VkDeviceMemory imageMemory;
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (textureResidency) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    createImage(width, height, mipLevels, VK_SAMPLE_COUNT_1_BIT, texture.format, VK_IMAGE_TILING_OPTIMAL, usage,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+
+    transitionImageLayout(image, texture.format, VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+
+    // Levels are copied as they are, no blits: the chain was built offline or on a worker
+    std::vector<VkBufferImageCopy> stagingRegions;
+    std::vector<VkBufferImageCopy> ringRegions;
+    for (uint32_t level = firstLevel; level < mipLevels; level++) {
+        VkBufferImageCopy region{};
+        region.bufferOffset = offsets[level];
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {std::max(width >> level, 1u), std::max(height >> level, 1u), 1};
+        (inRing[level] ? ringRegions : stagingRegions).push_back(region);
+    }
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    if (!stagingRegions.empty()) {
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(stagingRegions.size()), stagingRegions.data());
+    }
+    if (!ringRegions.empty()) {
+        vkCmdCopyBufferToImage(commandBuffer, textureStaging->buffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(ringRegions.size()), ringRegions.data());
+    }
+    endSingleTimeCommands(commandBuffer);
+
+    transitionImageLayout(image, texture.format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels - firstLevel, 1, firstLevel);
+
+    if (stagingBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        vkFreeMemory(device, stagingBufferMemory, nullptr);
+    }
+
+    textureImages[textureIndex] = image;
+    textureImageMemories[textureIndex] = imageMemory;
+    textureMipLevels[textureIndex] = mipLevels;
+    textureFormats[textureIndex] = texture.format;
+    textureExtents[textureIndex] = {width, height};
+}
+
+void VulkanRenderer::generateMipmaps(VkImage image, int32_t width, int32_t height, uint32_t mipLevels,
+                                     uint32_t layerCount) {
+    // Each level is blitted from the one above, all layers at once; blits of sRGB images
+    // filter in linear space
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = layerCount;
+    barrier.subresourceRange.levelCount = 1;
+
+    int32_t mipWidth = width;
+    int32_t mipHeight = height;
+
+    for (uint32_t i = 1; i < mipLevels; i++) {
+        barrier.subresourceRange.baseMipLevel = i - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = i - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = layerCount;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = i;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = layerCount;
+        vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+
+        if (mipWidth > 1) mipWidth /= 2;
+        if (mipHeight > 1) mipHeight /= 2;
+    }
+
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    endSingleTimeCommands(commandBuffer);
+}
+
+void VulkanRenderer::createMipmapPipeline() {
+    AssetData code = assets->open("mipmap.comp.spv");
+    if (!code) {
+        aout << "Warning: texture format cannot be blitted and mipmap.comp.spv is missing, textures get no mipmaps"
+             << std::endl;
+        return;
+    }
+
+    // Source and destination level of the RGBA8 scratch image
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &mipmapSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mipmap descriptor set layout!");
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &mipmapSetLayout;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &mipmapPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mipmap pipeline layout!");
+    }
+
+    VkShaderModule shaderModule = createShaderModule(code);
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = mipmapPipelineLayout;
+    VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &mipmapPipeline);
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mipmap pipeline!");
+    }
+}
+
+void VulkanRenderer::generateMipmapsCompute(VkBuffer pixels, VkImage image, int32_t width, int32_t height,
+                                            uint32_t mipLevels, uint32_t layer, VkDeviceSize pixelsOffset) {
+    // The chain is built in an RGBA8 UNORM scratch image, which every device can use as
+    // a storage image (sRGB formats usually cannot), then copied into the given layer of
+    // the texture. The shader does the sRGB decode / encode itself.
+    VkImage scratch;
+    VkDeviceMemory scratchMemory;
+    createImage(width, height, mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, scratch, scratchMemory);
+
+    std::vector<VkImageView> levelViews(mipLevels);
+    for (uint32_t level = 0; level < mipLevels; level++) {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = scratch;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+        if (vkCreateImageView(device, &viewInfo, nullptr, &levelViews[level]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create mipmap level view!");
+        }
+    }
 
-    for (const auto& face : faces) {
-        for (int i = 0; i < 3; i++) {
-            int vi = (i == 0) ? face.v1 : (i == 1 ? face.v2 : face.v3);
-            int vti = (i == 0) ? face.vt1 : (i == 1 ? face.vt2 : face.vt3);
+    // One set per generated level: level - 1 in, level out
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSize.descriptorCount = 2 * (mipLevels - 1);
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = mipLevels - 1;
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mipmap descriptor pool!");
+    }
+    std::vector<VkDescriptorSetLayout> layouts(mipLevels - 1, mipmapSetLayout);
+    std::vector<VkDescriptorSet> sets(mipLevels - 1);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = mipLevels - 1;
+    allocInfo.pSetLayouts = layouts.data();
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate mipmap descriptor sets!");
+    }
+    for (uint32_t level = 1; level < mipLevels; level++) {
+        std::array<VkDescriptorImageInfo, 2> imageInfos{};
+        imageInfos[0].imageView = levelViews[level - 1];
+        imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        imageInfos[1].imageView = levelViews[level];
+        imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        for (uint32_t i = 0; i < writes.size(); i++) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = sets[level - 1];
+            writes[i].dstBinding = i;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writes[i].descriptorCount = 1;
+            writes[i].pImageInfo = &imageInfos[i];
+        }
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = scratch;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = pixelsOffset;
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+    vkCmdCopyBufferToImage(commandBuffer, pixels, scratch, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mipmapPipeline);
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.subresourceRange.levelCount = 1;
+    std::vector<VkImageCopy> copies(mipLevels);
+    for (uint32_t level = 0; level < mipLevels; level++) {
+        uint32_t levelWidth = std::max(1u, static_cast<uint32_t>(width) >> level);
+        uint32_t levelHeight = std::max(1u, static_cast<uint32_t>(height) >> level);
+        copies[level].srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        copies[level].dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, layer, 1};
+        copies[level].extent = {levelWidth, levelHeight, 1};
+
+        if (level > 0) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mipmapPipelineLayout, 0, 1,
+                                    &sets[level - 1], 0, nullptr);
+            vkCmdDispatch(commandBuffer, (levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+        }
+
+        // This level is read by the next dispatch and by the copy into the texture
+        barrier.subresourceRange.baseMipLevel = level;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcAccessMask = level == 0 ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+                             level == 0 ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    // R8G8B8A8_UNORM and _SRGB are size-compatible, so the bytes copy over unchanged
+    vkCmdCopyImage(commandBuffer, scratch, VK_IMAGE_LAYOUT_GENERAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   static_cast<uint32_t>(copies.size()), copies.data());
+
+    barrier.image = image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, layer, 1};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    endSingleTimeCommands(commandBuffer);
+
+    vkDestroyDescriptorPool(device, pool, nullptr);
+    for (VkImageView view : levelViews) {
+        vkDestroyImageView(device, view, nullptr);
+    }
+    vkDestroyImage(device, scratch, nullptr);
+    vkFreeMemory(device, scratchMemory, nullptr);
+}
+
+void VulkanRenderer::selectTextureVariants() {
+    textureVariants.clear();
+    aout << "Texture formats:";
+    for (const TextureVariant& variant : textureVariantTable) {
+        if (isSampledFormatSupported(variant.format)) {
+            textureVariants.push_back(variant.suffix);
+            aout << " " << variant.suffix;
+        }
+    }
+    aout << " png" << std::endl;
+
+    // Basis files are transcoded to the best variant the transcoder writes whose alpha
+    // format is sampled too, else to RGBA8
+    transcodeFormat = VK_FORMAT_R8G8B8A8_SRGB;
+    transcodeAlphaFormat = VK_FORMAT_R8G8B8A8_SRGB;
+    const char* target = "rgba8";
+    for (const TextureVariant& variant : textureVariantTable) {
+        if (basisTranscodesTo(variant.format) && basisTranscodesTo(variant.alphaFormat) &&
+            isSampledFormatSupported(variant.format) && isSampledFormatSupported(variant.alphaFormat)) {
+            transcodeFormat = variant.format;
+            transcodeAlphaFormat = variant.alphaFormat;
+            target = variant.suffix;
+            break;
+        }
+    }
+    aout << "Basis textures are transcoded to " << target << std::endl;
+}
+
+void VulkanRenderer::decodeTextures() {
+    // The registry merged the models' texture tables and DrawRange::texture points into it
+    const std::vector<std::string>& names = registry->textures();
+    if (textureBinding == TextureBinding::PerTexture && names.size() > MAX_PHASE_1_TEXTURES) {
+        throw std::runtime_error("Too many textures for Phase 1! Use Phase 2 (Bindless) for 100+ textures.");
+    }
+
+    aout << "Total unique textures to load: " << names.size() << std::endl;
+
+    // Results are queued in completion order; the index keeps each texture in its slot.
+    // Virtual textures are only opened here; their tiles are read as frames ask for them.
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<double> decodeMs(names.size());
+    if (textureBinding == TextureBinding::Virtual) {
+        virtualTextures.resize(names.size());
+    }
+    threadPool->parallelFor(names.size(), [&](size_t i) {
+        const auto textureStart = std::chrono::steady_clock::now();
+        if (textureBinding == TextureBinding::Virtual) {
+            virtualTextures[i] = loadVirtualTexture(names[i]);
+            decodeMs[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - textureStart).count();
+            return;
+        }
+        DecodedTexture texture = decodeTexture(names[i]);
+        decodeMs[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - textureStart).count();
+        std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+        decodedTextures.emplace_back(static_cast<int>(i), std::move(texture));
+    });
+    const double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Efficiency: decode time over the time the usable threads were available for it
+    double busyMs = 0.0;
+    for (size_t i = 0; i < names.size(); i++) {
+        aout << "  Texture [" << i << "] " << (names[i].empty() ? "(none)" : names[i]) << ": " << decodeMs[i]
+             << " ms" << std::endl;
+        busyMs += decodeMs[i];
+    }
+    const size_t lanes = std::max<size_t>(1, std::min(threadPool->size(), names.size()));
+    aout << "Decoded " << names.size() << " textures in " << wallMs << " ms on " << lanes << " threads ("
+         << busyMs << " ms of decode, " << (wallMs > 0.0 ? 100.0 * busyMs / (wallMs * lanes) : 100.0)
+         << "% parallel efficiency)" << std::endl;
+
+    if (textureBinding == TextureBinding::Packed) {
+        packDecodedTextures();
+    }
+}
+
+void VulkanRenderer::packDecodedTextures() {
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    const uint32_t maxExtent = properties.limits.maxImageDimension2D;
+    const uint32_t maxLayers = properties.limits.maxImageArrayLayers;
+
+    std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+    std::sort(decodedTextures.begin(), decodedTextures.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    auto describe = [&]() {
+        std::vector<TexturePackInput> inputs(decodedTextures.size());
+        for (size_t i = 0; i < decodedTextures.size(); i++) {
+            const DecodedTexture& texture = decodedTextures[i].second;
+            inputs[i].width = static_cast<uint32_t>(texture.width);
+            inputs[i].height = static_cast<uint32_t>(texture.height);
+            inputs[i].format = static_cast<uint32_t>(texture.format);
+            inputs[i].levels = static_cast<uint32_t>(texture.levels.size());
+            inputs[i].present = texture.pixels || !texture.levels.empty();
+        }
+        return inputs;
+    };
+
+    std::vector<TexturePackInput> inputs = describe();
+    texturePack = planTexturePack(inputs, VK_FORMAT_R8G8B8A8_SRGB, maxExtent, maxLayers, ATLAS_MIP_LEVELS);
+    if (texturePack.mode == TexturePackMode::None) {
+        // Block-compressed textures only share an image when they match; the atlas takes
+        // the PNGs instead
+        aout << "Warning: Pre-encoded textures differ in size or format, packing their PNGs instead" << std::endl;
+        threadPool->parallelFor(decodedTextures.size(), [&](size_t i) {
+            DecodedTexture& texture = decodedTextures[i].second;
+            if (!texture.levels.empty()) {
+                texture = decodeTexture(texture.filename, false);
+            }
+        });
+        inputs = describe();
+        texturePack = planTexturePack(inputs, VK_FORMAT_R8G8B8A8_SRGB, maxExtent, maxLayers, ATLAS_MIP_LEVELS);
+    }
+    if (texturePack.mode == TexturePackMode::None) {
+        throw std::runtime_error("failed to pack textures into " + std::to_string(maxLayers) + " layers of " +
+                                 std::to_string(maxExtent) + "x" + std::to_string(maxExtent) + "!");
+    }
+    aout << "Packed " << inputs.size() << " textures into " << texturePack.layers << " "
+         << (texturePack.mode == TexturePackMode::Array ? "array" : "atlas") << " layers of " << texturePack.width
+         << "x" << texturePack.height << " (" << 100.0 * texturePack.usage(inputs) << "% of texels used)" << std::endl;
+}
+
+void VulkanRenderer::prepareTextureUploads() {
+    // Virtual textures have no images of their own; their tiles stream while frames run
+    if (textureBinding == TextureBinding::Virtual) {
+        return;
+    }
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_SRGB, &formatProperties);
+    const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                              VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    linearBlitSupported = (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+    if (!linearBlitSupported) {
+        createMipmapPipeline();
+    }
+
+    // The packed image needs every texture, so it is built once all are decoded
+    if (textureBinding == TextureBinding::Packed) {
+        return;
+    }
+
+    // Slots for every texture of the registry, filled in whatever order the decodes
+    // finish; bindless mode keeps its placeholder after them
+    const size_t count = registry->textures().size() + (textureBinding == TextureBinding::Bindless ? 1 : 0);
+    textureImages.assign(count, VK_NULL_HANDLE);
+    textureImageMemories.assign(count, VK_NULL_HANDLE);
+    textureMipLevels.assign(count, 1);
+    textureFormats.assign(count, VK_FORMAT_R8G8B8A8_SRGB);
+    textureExtents.assign(count, {1, 1});
+    if (textureBinding == TextureBinding::Bindless) {
+        prepareBindlessTextures();
+    }
+    textureUploadsOpen = true;
+}
+
+// Bytes of each level of the image uploadTexture made from texture
+static std::vector<uint64_t> textureLevelBytes(const DecodedTexture& texture, uint32_t mipLevels) {
+    std::vector<uint64_t> levelBytes;
+    if (!texture.levels.empty()) {
+        for (const AssetData& level : texture.levels) {
+            levelBytes.push_back(level.size);
+        }
+        return levelBytes;
+    }
+    const uint32_t width = texture.pixels ? static_cast<uint32_t>(texture.width) : 1;
+    const uint32_t height = texture.pixels ? static_cast<uint32_t>(texture.height) : 1;
+    for (uint32_t level = 0; level < mipLevels; level++) {
+        levelBytes.push_back(uint64_t(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * 4);
+    }
+    return levelBytes;
+}
+
+// First level of texture's chain no larger than tailSize on either side, the last one
+// if none is; 0 for a texture without prebuilt levels
+static uint32_t streamTailLevel(const DecodedTexture& texture, uint32_t tailSize) {
+    uint32_t level = 0;
+    while (level + 1 < texture.levels.size() &&
+           std::max(static_cast<uint32_t>(texture.width) >> level, static_cast<uint32_t>(texture.height) >> level) >
+                   tailSize) {
+        level++;
+    }
+    return level;
+}
+
+void VulkanRenderer::uploadDecodedTextures() {
+    std::vector<std::pair<int, DecodedTexture>> ready;
+    {
+        std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+        ready.swap(decodedTextures);
+    }
+    for (auto& [index, texture] : ready) {
+        if (textureBinding != TextureBinding::Bindless) {
+            uploadTexture(texture, index);
+            continue;
+        }
+        // A reload replaces the trimmed image once the frames sampling it are done
+        releaseTexture(index);
+        // Progressive: the mip tail now, the finer levels over the next frames
+        const bool progressive = progressiveTextures && ktx2FormatInfo(static_cast<uint32_t>(texture.format));
+        const uint32_t firstLevel = progressive ? streamTailLevel(texture, TEXTURE_STREAM_TAIL_SIZE) : 0;
+        uploadTexture(texture, index, firstLevel);
+        registerTexture(index, firstLevel);
+        if (textureImages[index] == VK_NULL_HANDLE) {
+            continue;
+        }
+        if (firstLevel > 0) {
+            textureStreams.push_back({index, std::move(texture.levels), firstLevel, 0});
+        } else {
+            textureResidency->setResident(index, textureLevelBytes(texture, textureMipLevels[index]));
+        }
+    }
+}
+
+void VulkanRenderer::createTextures() {
+    if (textureBinding == TextureBinding::Packed) {
+        createPackedTexture();
+        return;
+    }
+    if (textureBinding == TextureBinding::Virtual) {
+        createVirtualTextures();
+        return;
+    }
+    if (textureBinding == TextureBinding::Bindless) {
+        // Views and slots were made as each texture landed
+        uploadDecodedTextures();
+        textureUploadsOpen = false;
+        numTextures = static_cast<int>(textureSlots.size()) - 1;
+        aout << "Registered " << textureTable->size() << " textures (placeholder included) in a bindless table of "
+             << textureTable->capacity() << " slots" << std::endl;
+        return;
+    }
+
+    // Every decode has finished; upload the ones render() has not picked up yet. Only
+    // bindless mode decodes again later, so the staging ring goes.
+    uploadDecodedTextures();
+    textureUploadsOpen = false;
+    textureStaging.reset();
+
+    numTextures = static_cast<int>(textureImages.size());
+    aout << "Loaded " << numTextures << " texture images" << std::endl;
+
+    // Create image views
+    for (size_t i = 0; i < textureImages.size(); i++) {
+        textureImageViews.push_back(createImageView(textureImages[i], textureFormats[i], VK_IMAGE_ASPECT_COLOR_BIT,
+                                                    textureMipLevels[i]));
+    }
+    aout << "Created " << textureImageViews.size() << " texture image views" << std::endl;
+
+    // Create samplers (one per texture for Phase 1)
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.mipLodBias = 0.0f;
+
+    for (size_t i = 0; i < numTextures; i++) {
+        // The whole chain, down to 1x1
+        samplerInfo.maxLod = static_cast<float>(textureMipLevels[i]);
+        VkSampler sampler;
+        if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create texture sampler!");
+        }
+        textureSamplers.push_back(sampler);
+    }
+    aout << "Created " << textureSamplers.size() << " texture samplers" << std::endl;
+}
+
+void VulkanRenderer::createPackedTexture() {
+    std::vector<std::pair<int, DecodedTexture>> decoded;
+    {
+        std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+        decoded.swap(decodedTextures);
+    }
+    const TexturePack& pack = texturePack;
+    const VkFormat format = static_cast<VkFormat>(pack.format);
+
+    // Pre-encoded arrays bring their levels; RGBA8 chains are built here when the GPU can
+    const bool encoded = format != VK_FORMAT_R8G8B8A8_SRGB;
+    const bool computeMips = !encoded && !linearBlitSupported && mipmapPipeline != VK_NULL_HANDLE;
+    const uint32_t mipLevels = encoded || linearBlitSupported || computeMips ? pack.mipLevels : 1;
+
+    // One layer is staged at a time: all levels of it for encoded arrays (16-byte offsets,
+    // like uploadEncodedTexture), level 0 otherwise
+    std::vector<VkDeviceSize> levelOffsets;
+    VkDeviceSize layerSize = 0;
+    if (encoded) {
+        for (const auto& [index, texture] : decoded) {
+            if (texture.levels.empty()) {
+                continue;
+            }
+            for (const AssetData& level : texture.levels) {
+                levelOffsets.push_back(layerSize);
+                layerSize += (level.size + 15) & ~VkDeviceSize(15);
+            }
+            break;
+        }
+    } else {
+        layerSize = VkDeviceSize(pack.width) * pack.height * 4;
+    }
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    createBuffer(layerSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 stagingBuffer, stagingBufferMemory);
+    void* data;
+    vkMapMemory(device, stagingBufferMemory, 0, layerSize, 0, &data);
+    auto* staging = static_cast<uint8_t*>(data);
+
+    VkImage image;
+    VkDeviceMemory imageMemory;
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (!encoded && linearBlitSupported) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    createImage(pack.width, pack.height, mipLevels, VK_SAMPLE_COUNT_1_BIT, format, VK_IMAGE_TILING_OPTIMAL, usage,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory, 0, pack.layers);
+    transitionImageLayout(image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels,
+                          pack.layers);
+
+    for (uint32_t layer = 0; layer < pack.layers; layer++) {
+        // Atlas texels no tile covers stay white, as does the layer of a scene without textures
+        if (!encoded) {
+            memset(staging, 0xFF, static_cast<size_t>(layerSize));
+        }
+        for (const auto& [index, texture] : decoded) {
+            const bool present = texture.pixels || !texture.levels.empty();
+            if (!present || pack.placements[index].layer != layer) {
+                continue;
+            }
+            if (encoded) {
+                for (size_t level = 0; level < texture.levels.size(); level++) {
+                    memcpy(staging + levelOffsets[level], texture.levels[level].data, texture.levels[level].size);
+                }
+            } else if (pack.mode == TexturePackMode::Atlas) {
+                copyIntoAtlas(pack, pack.placements[index], texture.pixels.bytes(),
+                              static_cast<uint32_t>(texture.width), static_cast<uint32_t>(texture.height), staging);
+            } else {
+                memcpy(staging, texture.pixels.data, texture.pixels.size);
+            }
+        }
+
+        if (computeMips && mipLevels > 1) {
+            generateMipmapsCompute(stagingBuffer, image, static_cast<int32_t>(pack.width),
+                                   static_cast<int32_t>(pack.height), mipLevels, layer);
+            continue;
+        }
+        std::vector<VkBufferImageCopy> regions(encoded ? mipLevels : 1);
+        for (uint32_t level = 0; level < regions.size(); level++) {
+            VkBufferImageCopy& region = regions[level];
+            region.bufferOffset = encoded ? levelOffsets[level] : 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.baseArrayLayer = layer;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {std::max(pack.width >> level, 1u), std::max(pack.height >> level, 1u), 1};
+        }
+        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+        endSingleTimeCommands(commandBuffer);
+    }
+
+    if (!computeMips || mipLevels == 1) {
+        if (!encoded && mipLevels > 1) {
+            generateMipmaps(image, static_cast<int32_t>(pack.width), static_cast<int32_t>(pack.height), mipLevels,
+                            pack.layers);
+        } else {
+            transitionImageLayout(image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels, pack.layers);
+        }
+    }
+
+    vkUnmapMemory(device, stagingBufferMemory);
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingBufferMemory, nullptr);
+
+    textureImages = {image};
+    textureImageMemories = {imageMemory};
+    textureMipLevels = {mipLevels};
+    textureFormats = {format};
+    textureImageViews = {createImageView(image, format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels,
+                                         VK_IMAGE_VIEW_TYPE_2D_ARRAY, pack.layers)};
+    numTextures = static_cast<int>(pack.rects.size());
+
+    // One sampler for every material. Whole-layer textures repeat through the sampler;
+    // atlas tiles repeat through their gutters, so the page edges clamp.
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    const VkSamplerAddressMode addressMode = pack.mode == TexturePackMode::Atlas
+                                             ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+                                             : VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = addressMode;
+    samplerInfo.addressModeV = addressMode;
+    samplerInfo.addressModeW = addressMode;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(mipLevels);
+    samplerInfo.mipLodBias = 0.0f;
+    VkSampler sampler;
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+    textureSamplers = {sampler};
+
+    // The table the fragment shader indexes with the draw's texture; never empty, so the
+    // descriptor has a buffer to point at
+    std::vector<TextureRect> rects = pack.rects;
+    rects.resize(std::max<size_t>(rects.size(), 1));
+    const VkDeviceSize rectSize = rects.size() * sizeof(TextureRect);
+    VkBuffer rectStaging;
+    VkDeviceMemory rectStagingMemory;
+    createBuffer(rectSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 rectStaging, rectStagingMemory);
+    vkMapMemory(device, rectStagingMemory, 0, rectSize, 0, &data);
+    memcpy(data, rects.data(), static_cast<size_t>(rectSize));
+    vkUnmapMemory(device, rectStagingMemory);
+    createBuffer(rectSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureRectBuffer, textureRectBufferMemory);
+    copyBuffer(rectStaging, textureRectBuffer, rectSize);
+    vkDestroyBuffer(device, rectStaging, nullptr);
+    vkFreeMemory(device, rectStagingMemory, nullptr);
+
+    aout << "Loaded " << numTextures << " textures into one " << pack.width << "x" << pack.height << "x"
+         << pack.layers << " image (format " << format << ", " << mipLevels << " mip levels), one view, one sampler"
+         << std::endl;
+}
+
+void VulkanRenderer::prepareBindlessTextures() {
+    const int placeholder = static_cast<int>(textureImages.size()) - 1;
+    textureImageViews.assign(textureImages.size(), VK_NULL_HANDLE);
+    textureSlots.assign(textureImages.size(), TextureTable::kInvalidSlot);
+
+    // One sampler for the whole table; its LOD range covers every chain
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    samplerInfo.mipLodBias = 0.0f;
+    VkSampler sampler;
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+    textureSamplers = {sampler};
+    textureResidency = std::make_unique<TextureResidency>(placeholder, TEXTURE_MEMORY_BUDGET);
+
+    // Every draw samples the white placeholder until its own texture is registered
+    DecodedTexture white;
+    white.filename = "(placeholder)";
+    uploadTexture(white, placeholder);
+    registerTexture(placeholder);
+    placeholderSlot = textureSlots[placeholder];
+    std::fill(textureSlots.begin(), textureSlots.begin() + placeholder, placeholderSlot);
+}
+
+void VulkanRenderer::registerTexture(int textureIndex, uint32_t baseLevel) {
+    const uint32_t slot = textureTable->allocate();
+    if (slot == TextureTable::kInvalidSlot) {
+        if (textureSlots[textureIndex] != placeholderSlot) {
+            return;  // A streaming texture keeps its coarser view
+        }
+        // The placeholder always has a slot, so a full table only costs this texture
+        aout << "Warning: Bindless texture table full, texture [" << textureIndex << "] drawn white" << std::endl;
+        vkDestroyImage(device, textureImages[textureIndex], nullptr);
+        vkFreeMemory(device, textureImageMemories[textureIndex], nullptr);
+        textureImages[textureIndex] = VK_NULL_HANDLE;
+        textureImageMemories[textureIndex] = VK_NULL_HANDLE;
+        return;
+    }
+    if (textureSlots[textureIndex] != placeholderSlot) {
+        // A streaming texture's finer view: the old view and slot retire like those of a
+        // released texture, the image stays
+        textureTable->release(textureSlots[textureIndex], frameNumber);
+        retiredTextures.push_back({VK_NULL_HANDLE, VK_NULL_HANDLE, textureImageViews[textureIndex], frameNumber});
+    }
+    textureImageViews[textureIndex] =
+            createImageView(textureImages[textureIndex], textureFormats[textureIndex], VK_IMAGE_ASPECT_COLOR_BIT,
+                            textureMipLevels[textureIndex] - baseLevel, VK_IMAGE_VIEW_TYPE_2D, 1, baseLevel);
+    textureSlots[textureIndex] = slot;
+
+    // Sets allocated later write every registered slot themselves. Frames in flight
+    // never sample a slot that is being (re)written, which update-unused-while-pending
+    // allows.
+    for (VkDescriptorSet descriptorSet : descriptorSets) {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = textureImageViews[textureIndex];
+        imageInfo.sampler = textureSamplers[0];
+
+        VkWriteDescriptorSet textureWrite{};
+        textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        textureWrite.dstSet = descriptorSet;
+        textureWrite.dstBinding = 1;
+        textureWrite.dstArrayElement = slot;
+        textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        textureWrite.descriptorCount = 1;
+        textureWrite.pImageInfo = &imageInfo;
+        vkUpdateDescriptorSets(device, 1, &textureWrite, 0, nullptr);
+    }
+}
+
+void VulkanRenderer::releaseTexture(int textureIndex) {
+    // Bindless only: draws recorded from now on sample the placeholder, and the slot and
+    // image go once the frames already submitted are done with them
+    if (textureBinding != TextureBinding::Bindless || textureSlots[textureIndex] == placeholderSlot) {
+        return;
+    }
+    auto stream = std::find_if(textureStreams.begin(), textureStreams.end(),
+                               [&](const TextureStream& candidate) { return candidate.texture == textureIndex; });
+    if (stream != textureStreams.end()) {
+        retiredStaging.push_back({std::move(stream->levels), frameNumber});
+        textureStreams.erase(stream);
+    }
+    textureTable->release(textureSlots[textureIndex], frameNumber);
+    retiredTextures.push_back({textureImages[textureIndex], textureImageMemories[textureIndex],
+                               textureImageViews[textureIndex], frameNumber});
+    textureSlots[textureIndex] = placeholderSlot;
+    textureImages[textureIndex] = VK_NULL_HANDLE;
+    textureImageMemories[textureIndex] = VK_NULL_HANDLE;
+    textureImageViews[textureIndex] = VK_NULL_HANDLE;
+}
+
+void VulkanRenderer::retireTextures() {
+    // Called once the fence of currentFrame has signalled: the frame that last used it,
+    // MAX_FRAMES_IN_FLIGHT submissions ago, and every earlier one have finished
+    const uint64_t finished = frameNumber + 1 > MAX_FRAMES_IN_FLIGHT ? frameNumber + 1 - MAX_FRAMES_IN_FLIGHT : 0;
+    textureTable->retire(finished);
+    while (!retiredTextures.empty() && retiredTextures.front().frames <= finished) {
+        const RetiredTexture& retired = retiredTextures.front();
+        vkDestroyImageView(device, retired.view, nullptr);
+        vkDestroyImage(device, retired.image, nullptr);
+        vkFreeMemory(device, retired.memory, nullptr);
+        retiredTextures.pop_front();
+    }
+    while (!retiredStaging.empty() && retiredStaging.front().frames <= finished) {
+        retiredStaging.pop_front();
+    }
+}
+
+void VulkanRenderer::updateTextureResidency() {
+    // Textures drawn while trimmed or evicted are decoded again (mapped from the asset
+    // cache, usually) and replace their image whole through uploadDecodedTextures
+    const std::vector<std::string>& names = registry->textures();
+    for (uint32_t texture : textureResidency->takeReloads()) {
+        threadPool->submit([this, texture, name = names[texture]]() {
+            DecodedTexture decoded = decodeTexture(name);
+            std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+            decodedTextures.emplace_back(static_cast<int>(texture), std::move(decoded));
+        });
+    }
+    uploadDecodedTextures();
+
+    if (frameNumber % TEXTURE_BUDGET_QUERY_FRAMES == 0) {
+        textureResidency->setBudget(queryTextureBudget());
+    }
+    // Idle textures are far older than any frame in flight, so nothing on the GPU
+    // samples the images trimmed here
+    const uint64_t idleSince = frameNumber > TEXTURE_IDLE_FRAMES ? frameNumber - TEXTURE_IDLE_FRAMES : 0;
+    for (const TextureResidency::Trim& trim :
+         textureResidency->planTrims(idleSince, TEXTURE_MIN_LEVEL_BYTES, TEXTURE_TRIMS_PER_FRAME)) {
+        if (trim.firstLevel == TextureResidency::kEvicted) {
+            releaseTexture(static_cast<int>(trim.texture));
+        } else {
+            trimTexture(static_cast<int>(trim.texture), trim.firstLevel);
+        }
+    }
+}
+
+void VulkanRenderer::trimTexture(int textureIndex, uint32_t firstLevel) {
+    // The image keeps the last levels of the chain; the ones from firstLevel on are
+    // copied into a smaller image that takes its place
+    const uint32_t keptLevels = textureResidency->levelCount(textureIndex) - firstLevel;
+    const uint32_t dropped = textureMipLevels[textureIndex] - keptLevels;
+    const VkImage oldImage = textureImages[textureIndex];
+    const VkFormat format = textureFormats[textureIndex];
+    const VkExtent2D extent = {std::max(textureExtents[textureIndex].width >> dropped, 1u),
+                               std::max(textureExtents[textureIndex].height >> dropped, 1u)};
+
+    VkImage image;
+    VkDeviceMemory imageMemory;
+    createImage(extent.width, extent.height, keptLevels, VK_SAMPLE_COUNT_1_BIT, format, VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    std::array<VkImageMemoryBarrier, 2> barriers{};
+    for (VkImageMemoryBarrier& barrier : barriers) {
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = keptLevels;
+        barrier.subresourceRange.layerCount = 1;
+    }
+    barriers[0].image = oldImage;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].subresourceRange.baseMipLevel = dropped;
+    barriers[1].image = image;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    std::vector<VkImageCopy> regions(keptLevels);
+    for (uint32_t level = 0; level < keptLevels; level++) {
+        VkImageCopy& region = regions[level];
+        region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, dropped + level, 0, 1};
+        region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        region.extent = {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), 1};
+    }
+    vkCmdCopyImage(commandBuffer, oldImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barriers[1]);
+    endSingleTimeCommands(commandBuffer);
+
+    // The old image and slot retire like any released texture
+    releaseTexture(textureIndex);
+    textureImages[textureIndex] = image;
+    textureImageMemories[textureIndex] = imageMemory;
+    textureMipLevels[textureIndex] = keptLevels;
+    textureExtents[textureIndex] = extent;
+    registerTexture(textureIndex);
+}
+
+uint64_t VulkanRenderer::queryTextureBudget() {
+    if (getMemoryProperties2 == nullptr) {
+        return TEXTURE_MEMORY_BUDGET;
+    }
+
+    // What the driver says this process may still allocate from the device-local
+    // heaps, less some headroom for everything else, on top of what the textures hold
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    properties.pNext = &budget;
+    getMemoryProperties2(physicalDevice, &properties);
+    uint64_t heapBudget = 0;
+    uint64_t heapUsage = 0;
+    for (uint32_t heap = 0; heap < properties.memoryProperties.memoryHeapCount; heap++) {
+        if (properties.memoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            heapBudget += budget.heapBudget[heap];
+            heapUsage += budget.heapUsage[heap];
+        }
+    }
+    const uint64_t limit = heapBudget > TEXTURE_HEAP_HEADROOM ? heapBudget - TEXTURE_HEAP_HEADROOM : 0;
+    const uint64_t textures = textureResidency->residentBytes();
+    const uint64_t others = heapUsage > textures ? heapUsage - textures : 0;
+    return std::min(TEXTURE_MEMORY_BUDGET, limit > others ? limit - others : 0);
+}
+
+void VulkanRenderer::recordTextureStreams(VkCommandBuffer commandBuffer) {
+    // The coarsest missing level of any texture goes first, so all of them sharpen at
+    // the same pace; one that gets no staging this frame waits for the next
+    VkDeviceSize budget = TEXTURE_STREAM_BYTES_PER_FRAME;
+    std::vector<bool> stalled(textureStreams.size(), false);
+    while (budget > 0) {
+        size_t next = textureStreams.size();
+        for (size_t i = 0; i < textureStreams.size(); i++) {
+            const TextureStream& stream = textureStreams[i];
+            if (stream.level == 0 || stalled[i]) {
+                continue;
+            }
+            if (next == textureStreams.size() ||
+                stream.levels[stream.level - 1].size < textureStreams[next].levels[textureStreams[next].level - 1].size) {
+                next = i;
+            }
+        }
+        if (next == textureStreams.size()) {
+            break;
+        }
+        if (!copyTextureBand(commandBuffer, textureStreams[next], budget)) {
+            stalled[next] = true;
+        }
+    }
+    textureStreams.erase(std::remove_if(textureStreams.begin(), textureStreams.end(),
+                                        [](const TextureStream& stream) { return stream.level == 0; }),
+                         textureStreams.end());
+}
+
+bool VulkanRenderer::copyTextureBand(VkCommandBuffer commandBuffer, TextureStream& stream, VkDeviceSize& budget) {
+    const int index = stream.texture;
+    const uint32_t level = stream.level - 1;
+    const AssetData& data = stream.levels[level];
+    const Ktx2FormatInfo* info = ktx2FormatInfo(static_cast<uint32_t>(textureFormats[index]));
+    const uint32_t height = std::max(textureExtents[index].height >> level, 1u);
+    const uint32_t blockRows = (height + info->blockHeight - 1) / info->blockHeight;
+    const VkDeviceSize rowBytes = data.size / blockRows;
+
+    // Whole block rows, as many as the budget has room for but at least one
+    const uint32_t rows = static_cast<uint32_t>(
+            std::min<VkDeviceSize>(blockRows - stream.rows, std::max<VkDeviceSize>(budget / rowBytes, 1)));
+    const VkDeviceSize bytes = rows * rowBytes;
+    const uint8_t* band = data.bytes() + stream.rows * rowBytes;
+    VkDeviceSize bufferOffset;
+    if (textureStaging->contains(band)) {
+        bufferOffset = textureStaging->offsetOf(band);
+    } else {
+        AssetData staging = allocateTextureStaging(bytes);
+        if (!staging) {
+            return false;
+        }
+        memcpy(const_cast<void*>(staging.data), band, bytes);
+        bufferOffset = textureStaging->offsetOf(staging.data);
+        retiredStaging.push_back({{std::move(staging)}, frameNumber + 1});
+    }
 
-            Vertex vertex{};
+    VkBufferImageCopy region{};
+    region.bufferOffset = bufferOffset;
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+    const uint32_t y = stream.rows * info->blockHeight;
+    region.imageOffset = {0, static_cast<int32_t>(y), 0};
+    region.imageExtent = {std::max(textureExtents[index].width >> level, 1u),
+                          std::min(rows * info->blockHeight, height - y), 1};
+    vkCmdCopyBufferToImage(commandBuffer, textureStaging->buffer(), textureImages[index],
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    budget -= std::min(bytes, budget);
+    stream.rows += rows;
+    if (stream.rows < blockRows) {
+        return true;
+    }
 
-            if (vi >= 0 && vi * 3 + 2 < attrib.vertices.size()) {
-                vertex.pos = {
-                    attrib.vertices[3 * vi + 0],
-                    -attrib.vertices[3 * vi + 1],
-                    attrib.vertices[3 * vi + 2]
-                };
-            }
+    // The level is complete; the draws recorded after this sample it through a view
+    // that starts there
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = textureImages[index];
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+    stream.level = level;
+    stream.rows = 0;
+    registerTexture(index, level);
+
+    if (level == 0) {
+        // Whole: from now on the residency budget manages it like any other texture
+        std::vector<uint64_t> levelBytes;
+        for (const AssetData& levelData : stream.levels) {
+            levelBytes.push_back(levelData.size);
+        }
+        textureResidency->setResident(index, levelBytes);
+        retiredStaging.push_back({std::move(stream.levels), frameNumber + 1});
+    }
+    return true;
+}
 
-            if (vti >= 0 && vti * 2 + 1 < attrib.texcoords.size()) {
-                vertex.texCoord = {
-                    attrib.texcoords[2 * vti + 0],
-                    1.0f - attrib.texcoords[2 * vti + 1]
-                };
-            }
+uint32_t VulkanRenderer::textureDescriptor(uint32_t texture) const {
+    // What the fragment shader indexes binding 1 (or the packed rects) with
+    return textureBinding == TextureBinding::Bindless ? textureSlots[texture] : texture;
+}
 
-            vertex.color = {1.0f, 1.0f, 1.0f};
-            vertex.texIndex = face.matId;
+VirtualTexture VulkanRenderer::loadVirtualTexture(const std::string& filename) {
+    if (filename.empty()) {
+        return {};  // Untextured model, draws white
+    }
 
-            if (uniqueVertices.count(vertex) == 0) {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
-            }
+    // A tile file from tools/vtexconv next to the PNG is used as it is
+    const std::string vtexPath = filename.substr(0, filename.find_last_of('.')) + ".vtex";
+    if (AssetData asset = assets->open(vtexPath)) {
+        try {
+            return readVirtualTextureFile(asset);
+        } catch (const std::exception& e) {
+            aout << "Warning: Skipping " << vtexPath << ": " << e.what() << std::endl;
+        }
+    }
 
-            indices.push_back(uniqueVertices[vertex]);
+    // Otherwise the PNG is cut into tiles once and the tiles are mapped from the asset
+    // cache, so the kernel can drop them again under memory pressure
+    AssetData asset = assets->open(filename);
+    if (!asset) {
+        aout << "Warning: Could not open texture file: " << filename << std::endl;
+        return {};
+    }
+    const std::string cacheKey =
+            AssetCache::makeKey("vtex", TEXTURE_CACHE_VERSION, hashBytes(asset.data, asset.size));
+    if (AssetData cached = assetCache->load(cacheKey)) {
+        try {
+            return readVirtualTextureFile(cached);
+        } catch (const std::exception& e) {
+            aout << "Warning: Ignoring corrupt cache entry for " << filename << ": " << e.what() << std::endl;
         }
     }
 
-    aout << "Loaded " << vertices.size() << " vertices, " << indices.size() << " indices" << std::endl;
-    aout << "Total materials: " << materialToTextureIndex.size() << std::endl;
-    
-    // Calculate and log model bounds
-    if (!vertices.empty()) {
-        glm::vec3 minBounds(FLT_MAX);
-        glm::vec3 maxBounds(-FLT_MAX);
-        for (const auto& vertex : vertices) {
-            minBounds = glm::min(minBounds, vertex.pos);
-            maxBounds = glm::max(maxBounds, vertex.pos);
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load_from_memory(asset.bytes(), static_cast<int>(asset.size), &width, &height, &channels,
+                                            STBI_rgb_alpha);
+    if (!pixels) {
+        aout << "Warning: Failed to load texture: " << filename << std::endl;
+        return {};
+    }
+    std::vector<uint8_t> file;
+    try {
+        file = serializeVirtualTexture(uint32_t(width), uint32_t(height), pixels, nullptr);
+    } catch (const std::exception& e) {
+        aout << "Warning: Failed to tile texture " << filename << ": " << e.what() << std::endl;
+    }
+    stbi_image_free(pixels);
+    if (file.empty()) {
+        return {};
+    }
+
+    if (assetCache->store(cacheKey, file.data(), file.size(), nullptr, 0)) {
+        if (AssetData stored = assetCache->load(cacheKey)) {
+            return readVirtualTextureFile(stored);
         }
-        glm::vec3 center = (minBounds + maxBounds) * 0.5f;
-        glm::vec3 size = maxBounds - minBounds;
-        aout << "Model bounds - Min: (" << minBounds.x << ", " << minBounds.y << ", " << minBounds.z << ")" << std::endl;
-        aout << "Model bounds - Max: (" << maxBounds.x << ", " << maxBounds.y << ", " << maxBounds.z << ")" << std::endl;
-        aout << "Model center: (" << center.x << ", " << center.y << ", " << center.z << ")" << std::endl;
-        aout << "Model size: (" << size.x << ", " << size.y << ", " << size.z << ")" << std::endl;
     }
+    // The cache is full or not writable; the tiles stay on the heap
+    auto owned = std::make_shared<std::vector<uint8_t>>(std::move(file));
+    return readVirtualTextureFile(AssetData{owned->data(), owned->size(), owned});
 }
 
-void VulkanRenderer::createVertexBuffer() {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
+// Copy of one staged tile, border included, into its slot of the cache image
+static VkBufferImageCopy tileCopyRegion(VkDeviceSize bufferOffset, uint32_t slot, uint32_t slotsPerSide) {
+    const uint32_t tileStride = kVirtualTextureTileSize + 2 * kVirtualTextureBorder;
+    VkBufferImageCopy region{};
+    region.bufferOffset = bufferOffset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {static_cast<int32_t>(slot % slotsPerSide * tileStride),
+                          static_cast<int32_t>(slot / slotsPerSide * tileStride), 0};
+    region.imageExtent = {tileStride, tileStride, 1};
+    return region;
+}
+
+void VulkanRenderer::createVirtualTextures() {
+    // Pages of every texture, and the table the shader finds them through
+    virtualCache = std::make_unique<VirtualTextureCache>(VIRTUAL_CACHE_TILES);
+    std::vector<VirtualTextureInfo> infos(std::max<size_t>(virtualTextures.size(), 1), VirtualTextureInfo{});
+    uint64_t virtualTexels = 0;
+    for (size_t i = 0; i < virtualTextures.size(); i++) {
+        const VirtualTexture& texture = virtualTextures[i];
+        if (!texture) {
+            continue;
+        }
+        std::vector<uint32_t> levelFirstPage;
+        VirtualTextureInfo& info = infos[i];
+        info.width = texture.width;
+        info.height = texture.height;
+        info.levelCount = texture.levelCount;
+        info.firstPage = virtualCache->addTexture(texture.width, texture.height, levelFirstPage);
+        std::copy(levelFirstPage.begin(), levelFirstPage.end(), info.levelFirstPage);
+        virtualCacheTextures.push_back(static_cast<uint32_t>(i));
+        virtualTexels += uint64_t(texture.width) * texture.height;
+    }
 
+    // The cache image; a slot holds whichever tile the cache put there last
+    const uint32_t tileStride = kVirtualTextureTileSize + 2 * kVirtualTextureBorder;
+    const uint32_t cacheSize = VIRTUAL_CACHE_TILES * tileStride;
+    const VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    VkImage image;
+    VkDeviceMemory imageMemory;
+    createImage(cacheSize, cacheSize, 1, VK_SAMPLE_COUNT_1_BIT, format, VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                image, imageMemory);
+    transitionImageLayout(image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
+
+    // Mip tails are read now, in parallel, and pinned, so every texture always has a
+    // resident page to fall back on
+    const size_t tileBytes = virtualTextureTileBytes();
+    const size_t tailCount = virtualCacheTextures.size();
+    const VkDeviceSize stagingSize = std::max<size_t>(tailCount, 1) * tileBytes;
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                  stagingBuffer, stagingBufferMemory);
-
     void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices.data(), (size_t)bufferSize);
+    vkMapMemory(device, stagingBufferMemory, 0, stagingSize, 0, &data);
+    auto* staging = static_cast<uint8_t*>(data);
+    threadPool->parallelFor(tailCount, [&](size_t t) {
+        const VirtualTextureCache::Page& tail = virtualCache->page(virtualCache->tailPage(static_cast<uint32_t>(t)));
+        uint8_t* tile = staging + t * tileBytes;
+        try {
+            virtualTextures[virtualCacheTextures[t]].readTile(tail.level, tail.x, tail.y, tile);
+        } catch (const std::exception& e) {
+            aout << "Warning: Failed to read the mip tail of texture [" << virtualCacheTextures[t]
+                 << "]: " << e.what() << std::endl;
+            memset(tile, 0xFF, tileBytes);
+        }
+    });
+    std::vector<VkBufferImageCopy> regions;
+    for (uint32_t t = 0; t < tailCount; t++) {
+        const uint32_t slot = virtualCache->insert(virtualCache->tailPage(t), 0, true);
+        if (slot == VirtualTextureCache::kNoSlot) {
+            aout << "Warning: Virtual texture cache full, texture [" << virtualCacheTextures[t]
+                 << "] has no pinned mip tail" << std::endl;
+            continue;
+        }
+        regions.push_back(tileCopyRegion(t * tileBytes, slot, VIRTUAL_CACHE_TILES));
+    }
+    if (!regions.empty()) {
+        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+        endSingleTimeCommands(commandBuffer);
+    }
+    transitionImageLayout(image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
     vkUnmapMemory(device, stagingBufferMemory);
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingBufferMemory, nullptr);
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+    textureImages = {image};
+    textureImageMemories = {imageMemory};
+    textureMipLevels = {1};
+    textureFormats = {format};
+    textureImageViews = {createImageView(image, format, VK_IMAGE_ASPECT_COLOR_BIT, 1)};
 
-    copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+    // The shader picks the level and filters within a tile; the borders keep bilinear
+    // taps inside it
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+    samplerInfo.mipLodBias = 0.0f;
+    VkSampler sampler;
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+    textureSamplers = {sampler};
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    const VkDeviceSize infoSize = infos.size() * sizeof(VirtualTextureInfo);
+    VkBuffer infoStaging;
+    VkDeviceMemory infoStagingMemory;
+    createBuffer(infoSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 infoStaging, infoStagingMemory);
+    vkMapMemory(device, infoStagingMemory, 0, infoSize, 0, &data);
+    memcpy(data, infos.data(), static_cast<size_t>(infoSize));
+    vkUnmapMemory(device, infoStagingMemory);
+    createBuffer(infoSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, virtualTextureInfoBuffer, virtualTextureInfoBufferMemory);
+    copyBuffer(infoStaging, virtualTextureInfoBuffer, infoSize);
+    vkDestroyBuffer(device, infoStaging, nullptr);
+    vkFreeMemory(device, infoStagingMemory, nullptr);
+
+    createVirtualFrames();
+    numTextures = static_cast<int>(virtualTextures.size());
+
+    aout << "Virtual textures: " << tailCount << " of " << numTextures << " present, "
+         << virtualCache->pageCount() << " pages over " << virtualTexels * 4 / (1024 * 1024)
+         << " MB of level 0 texels; cache " << cacheSize << "x" << cacheSize << " ("
+         << virtualCache->slotCount() << " tiles, " << uint64_t(cacheSize) * cacheSize * 4 / (1024 * 1024)
+         << " MB), " << regions.size() << " mip tails pinned" << std::endl;
 }
 
-void VulkanRenderer::createIndexBuffer() {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+void VulkanRenderer::createVirtualFrames() {
+    // Host-visible: the CPU reads a frame's feedback and rewrites its page table and
+    // staging once the frame's fence has signalled
+    virtualCache->updatePageTable();
+    const std::vector<uint32_t>& table = virtualCache->pageTable();
+    const uint32_t cacheSize = VIRTUAL_CACHE_TILES * (kVirtualTextureTileSize + 2 * kVirtualTextureBorder);
+    const VkDeviceSize tableSize = (4 + table.size()) * sizeof(uint32_t);
+    const VkDeviceSize feedbackSize = std::max<size_t>((table.size() + 31) / 32, 1) * sizeof(uint32_t);
+    const VkDeviceSize stagingSize = VIRTUAL_TILE_UPLOADS_PER_FRAME * virtualTextureTileBytes();
+    const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                              VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    virtualFrames.resize(MAX_FRAMES_IN_FLIGHT);
+    for (VirtualFrame& frame : virtualFrames) {
+        createBuffer(tableSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible, frame.pageTable,
+                     frame.pageTableMemory);
+        createBuffer(feedbackSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible, frame.feedback,
+                     frame.feedbackMemory);
+        createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, hostVisible, frame.tileStaging,
+                     frame.tileStagingMemory);
+        void* data;
+        vkMapMemory(device, frame.pageTableMemory, 0, tableSize, 0, &data);
+        frame.pageTableMapped = static_cast<uint32_t*>(data);
+        vkMapMemory(device, frame.feedbackMemory, 0, feedbackSize, 0, &data);
+        frame.feedbackMapped = static_cast<uint32_t*>(data);
+        vkMapMemory(device, frame.tileStagingMemory, 0, stagingSize, 0, &data);
+        frame.tileStagingMapped = static_cast<uint8_t*>(data);
+
+        // Header: feedback pixel, cache size in texels, two unused words
+        frame.pageTableMapped[0] = 0;
+        frame.pageTableMapped[1] = cacheSize;
+        frame.pageTableMapped[2] = 0;
+        frame.pageTableMapped[3] = 0;
+        memcpy(frame.pageTableMapped + 4, table.data(), table.size() * sizeof(uint32_t));
+        frame.pageTableVersion = virtualCache->version();
+        memset(frame.feedbackMapped, 0, static_cast<size_t>(feedbackSize));
+    }
+}
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 stagingBuffer, stagingBufferMemory);
+void VulkanRenderer::updateVirtualTextures() {
+    // Called once the fence of currentFrame has signalled: the feedback of the frame that
+    // last used it is complete, and its page table and staging are free to rewrite
+    VirtualFrame& frame = virtualFrames[currentFrame];
+    const uint32_t words = (virtualCache->pageCount() + 31) / 32;
+    for (uint32_t word = 0; word < words; word++) {
+        const uint32_t bits = frame.feedbackMapped[word];
+        if (bits == 0) {
+            continue;
+        }
+        frame.feedbackMapped[word] = 0;
+        for (uint32_t bit = 0; bit < 32; bit++) {
+            if (bits & (1u << bit)) {
+                virtualCache->request(word * 32 + bit, frameNumber);
+            }
+        }
+    }
 
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), (size_t)bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
+    // The wanted tiles are read on the workers, coarsest first, a bounded number at a time
+    for (uint32_t page : virtualCache->takeLoads(VIRTUAL_TILE_LOADS_IN_FLIGHT - tileLoadsInFlight)) {
+        const VirtualTextureCache::Page key = virtualCache->page(page);
+        const VirtualTexture* texture = &virtualTextures[virtualCacheTextures[key.texture]];
+        tileLoadsInFlight++;
+        threadPool->submit([this, page, key, texture]() {
+            LoadedTile tile{page, std::vector<uint8_t>(virtualTextureTileBytes())};
+            try {
+                texture->readTile(key.level, key.x, key.y, tile.texels.data());
+            } catch (const std::exception& e) {
+                aout << "Warning: Failed to read a virtual texture tile: " << e.what() << std::endl;
+                tile.texels.clear();
+            }
+            std::lock_guard<std::mutex> lock(loadedTilesMutex);
+            loadedTiles.push_back(std::move(tile));
+        });
+    }
+
+    // Tiles read so far go into this frame's staging, and recordTileCopies copies them
+    // into their slots. Pages the feedback showed within the last cycle are not evicted.
+    frame.tileCopies.clear();
+    const uint64_t keepSince = frameNumber > VIRTUAL_FEEDBACK_CYCLE ? frameNumber - VIRTUAL_FEEDBACK_CYCLE : 0;
+    const size_t tileBytes = virtualTextureTileBytes();
+    while (frame.tileCopies.size() < VIRTUAL_TILE_UPLOADS_PER_FRAME) {
+        LoadedTile tile;
+        {
+            std::lock_guard<std::mutex> lock(loadedTilesMutex);
+            if (loadedTiles.empty()) {
+                break;
+            }
+            tile = std::move(loadedTiles.front());
+            loadedTiles.pop_front();
+        }
+        tileLoadsInFlight--;
+        if (tile.texels.empty()) {
+            virtualCache->cancelLoad(tile.page);
+            continue;
+        }
+        const uint32_t slot = virtualCache->insert(tile.page, keepSince);
+        if (slot == VirtualTextureCache::kNoSlot) {
+            continue;  // Every slot is still in use; the feedback asks again
+        }
+        const VkDeviceSize offset = frame.tileCopies.size() * tileBytes;
+        memcpy(frame.tileStagingMapped + offset, tile.texels.data(), tileBytes);
+        frame.tileCopies.push_back(tileCopyRegion(offset, slot, VIRTUAL_CACHE_TILES));
+    }
+
+    if (virtualCache->updatePageTable() || frame.pageTableVersion != virtualCache->version()) {
+        const std::vector<uint32_t>& table = virtualCache->pageTable();
+        memcpy(frame.pageTableMapped + 4, table.data(), table.size() * sizeof(uint32_t));
+        frame.pageTableVersion = virtualCache->version();
+    }
+    // 23 is odd, so over VIRTUAL_FEEDBACK_CYCLE frames every pixel of the shader's 8x8
+    // block reports once
+    frame.pageTableMapped[0] = static_cast<uint32_t>(frameNumber * 23 % VIRTUAL_FEEDBACK_CYCLE);
+}
+
+void VulkanRenderer::recordTileCopies(VkCommandBuffer commandBuffer) {
+    const VirtualFrame& frame = virtualFrames[currentFrame];
+    if (frame.tileCopies.empty()) {
+        return;
+    }
+    // Frames submitted earlier may still sample the slots being overwritten; the barrier
+    // waits for their fragment shaders, which come first in submission order
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = textureImages[0];
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkCmdCopyBufferToImage(commandBuffer, frame.tileStaging, textureImages[0], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(frame.tileCopies.size()), frame.tileCopies.data());
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+std::vector<MtlMaterial> VulkanRenderer::parseMTLFile(const std::string& mtlFilename) {
+    AssetData asset = assets->open(mtlFilename);
+    if (!asset) {
+        aout << "Warning: Could not open MTL file: " << mtlFilename << std::endl;
+        return {};
+    }
+
+    aout << "Parsing MTL file: " << mtlFilename << std::endl;
+
+    std::vector<MtlMaterial> materials = parseMtl(asset.chars(), asset.size);
+
+    for (const auto& material : materials) {
+        if (material.diffuseTexture.empty()) {
+            aout << "Inferred texture for " << material.name << ": " << inferTextureFile(material.name) << std::endl;
+        } else {
+            aout << "Material " << material.name << " -> texture: " << material.diffuseTexture << std::endl;
+        }
+    }
+    return materials;
+}
+
+bool VulkanRenderer::loadMeshFile(Model& model, AssetData asset, const std::string& name) {
+    if (!asset) {
+        return false;
+    }
+
+    try {
+        model.mesh = readMeshFile(asset.data, asset.size);
+    } catch (const std::exception& e) {
+        aout << "Warning: Ignoring " << name << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    // Keep the mapping alive until the vertex and index data are uploaded
+    model.source = std::move(asset);
+    return true;
+}
+
+bool VulkanRenderer::loadModel(Model& model) {
+    const std::string meshFile = model.file.substr(0, model.file.rfind('.')) + ".vmesh";
+
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    auto elapsedMs = [&]() {
+        return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+    };
+
+    // Prefer the preprocessed mesh (tools/vmeshconv.cpp). Stored uncompressed (see
+    // noCompress in build.gradle.kts), so this is an mmap of the APK.
+    if (loadMeshFile(model, assets->open(meshFile), meshFile)) {
+        aout << "Loaded " << meshFile << " in " << elapsedMs() << " ms" << std::endl;
+        return true;
+    }
+
+    AssetData asset = assets->open(model.file);
+    if (!asset) {
+        aout << "Warning: Could not open model " << model.file << ", skipping it" << std::endl;
+        return false;
+    }
+
+    // Next, the mesh an earlier launch built from the same OBJ and MTL bytes
+    uint64_t contentHash = hashBytes(asset.data, asset.size);
+    for (const std::string& library : findMaterialLibraries(asset.chars(), asset.size)) {
+        AssetData mtl = assets->open(library);
+        contentHash = hashBytes(mtl.data, mtl.size, contentHash);
+    }
+    const std::string cacheKey = AssetCache::makeKey("mesh", MESH_CACHE_VERSION, contentHash);
+    if (loadMeshFile(model, assetCache->load(cacheKey), "cached " + model.file)) {
+        aout << "Loaded cached " << model.file << " in " << elapsedMs() << " ms" << std::endl;
+        return true;
+    }
+
+    // Otherwise parse the OBJ. The parser reads the asset in place, no copy.
+    ObjData obj;
+    parseObjParallel(asset.chars(), asset.size, obj, *threadPool);
+    const size_t objLength = asset.size;
+    asset = AssetData{};
+
+    aout << "Parsed " << model.file << " (" << objLength << " bytes) in " << elapsedMs() << " ms on "
+         << threadPool->size() << " threads" << std::endl;
+    aout << "Parsed " << obj.triangleCount() << " triangles, " << obj.materialNames.size() << " materials" << std::endl;
+
+    // Parse MTL file to get material-to-texture mapping
+    std::vector<MtlMaterial> materials;
+    if (!obj.materialLibraries.empty()) {
+        materials = parseMTLFile(obj.materialLibraries.front());
+    }
+
+    buildMesh(obj, materials, model.storage, threadPool.get());
+    MeshOptimizationStats optimization = optimizeMesh(model.storage);
+    buildLodChain(model.storage);
+    splitForShortIndices(model.storage);
+    buildMeshlets(model.storage);
+    model.mesh = makeMeshView(model.storage);
+
+    aout << "Optimized " << model.file << ": ACMR " << optimization.before.acmr << " -> " << optimization.after.acmr
+         << ", ATVR " << optimization.before.atvr << " -> " << optimization.after.atvr
+         << " (" << optimization.clusterCount << " overdraw clusters)" << std::endl;
+    aout << "Built " << model.file << " in " << elapsedMs() << " ms total" << std::endl;
+
+    // The next launch maps this instead
+    std::vector<uint8_t> serialized = serializeMesh(model.storage);
+    assetCache->store(cacheKey, nullptr, 0, serialized.data(), serialized.size());
+    return true;
+}
+
+void VulkanRenderer::loadModels() {
+    registry = std::make_unique<ModelRegistry>(sceneModels());
+
+    // One model per task; each also spreads its OBJ parse over the pool, which is safe
+    // because the waiting caller helps run the chunks
+    std::vector<Model>& models = registry->models();
+    threadPool->parallelFor(models.size(), [&](size_t i) {
+        models[i].loaded = loadModel(models[i]);
+    });
+    registry->layout();
+
+    aout << "Scene: " << registry->models().size() << " models, " << registry->vertexCount() << " vertices, "
+         << registry->indexCount() << " indices (" << registry->indexSize() * 8 << "-bit), "
+         << registry->textures().size() << " textures" << std::endl;
+    for (const Model& model : registry->models()) {
+        const MeshView& mesh = model.mesh;
+        aout << model.file << ": " << mesh.vertexCount << " vertices from " << model.firstVertex << ", "
+             << mesh.indexCount << " indices from " << model.firstIndex << ", "
+             << mesh.ranges.size() << " draw ranges" << std::endl;
+        for (size_t level = 0; level < mesh.lods.size(); level++) {
+            const MeshLod& lod = mesh.lods[level];
+            aout << "  LOD " << level << ": " << lod.indexCount / 3 << " triangles, "
+                 << model.rangeMeshlets[lod.firstRange + lod.rangeCount] - model.rangeMeshlets[lod.firstRange]
+                 << " meshlets, error " << lod.error << std::endl;
+        }
+
+        // Log model bounds
+        if (mesh.vertexCount > 0) {
+            glm::vec3 center = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+            glm::vec3 size = mesh.boundsMax - mesh.boundsMin;
+            aout << "  Model center: (" << center.x << ", " << center.y << ", " << center.z << ")" << std::endl;
+            aout << "  Model size: (" << size.x << ", " << size.y << ", " << size.z << ")" << std::endl;
+        }
+    }
+}
+
+void VulkanRenderer::createStagingRing() {
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    stagingRing = std::make_unique<StagingRing>(physicalDevice, device, graphicsQueue, indices.graphicsFamily.value());
+}
+
+void VulkanRenderer::createVertexBuffer() {
+    VkDeviceSize bufferSize = registry->vertexCount() *
+            (vertexFormat == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex));
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+    // The mesh shader fetches vertices itself
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    if (useMeshShaders) {
+        usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    }
+    createBuffer(bufferSize, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+}
+
+void VulkanRenderer::createIndexBuffer() {
+    createBuffer(registry->indexCount() * registry->indexSize(),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+}
 
-    copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+void VulkanRenderer::createMeshletBuffers() {
+    if (!useMeshShaders || registry->meshletCount() == 0) {
+        return;
+    }
+    const VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    createBuffer(registry->meshletCount() * sizeof(Meshlet), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                 meshletBuffer, meshletBufferMemory);
+    createBuffer(registry->meshletVertexCount() * sizeof(uint32_t), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                 meshletVertexBuffer, meshletVertexBufferMemory);
+    createBuffer(registry->meshletTriangleCount() * sizeof(uint32_t), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                 meshletTriangleBuffer, meshletTriangleBufferMemory);
+    createBuffer(registry->models().size() * sizeof(glm::mat4), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                 modelTransformBuffer, modelTransformBufferMemory);
+}
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+void VulkanRenderer::streamMesh() {
+    // Model by model, vertices then indices, so the first models become drawable while
+    // the rest are still on their way. Within a model the ranges are in LOD order.
+    const uint32_t indexSize = registry->indexSize();
+    for (Model& model : registry->models()) {
+        const MeshView& mesh = model.mesh;
+        if (vertexFormat == VertexFormat::Packed) {
+            // Whole vertices per block, quantized straight into the staging memory.
+            // .vmesh vertex sections are 16-byte aligned, so the view can be read as
+            // Vertex in place.
+            const Vertex* vertices = static_cast<const Vertex*>(mesh.vertexData);
+            model.quantization = computeVertexQuantization(vertices, mesh.vertexCount);
+            const size_t blockVertices = stagingRing->blockSize() / sizeof(PackedVertex);
+            for (size_t first = 0; first < mesh.vertexCount; first += blockVertices) {
+                size_t count = std::min(blockVertices, mesh.vertexCount - first);
+                StagingRing::Block block;
+                if (!stagingRing->acquire(block)) {
+                    return;
+                }
+                quantizeVertices(vertices + first, count, model.quantization, static_cast<PackedVertex*>(block.data));
+                stagingRing->submit(block, vertexBuffer, (model.firstVertex + first) * sizeof(PackedVertex),
+                                    count * sizeof(PackedVertex));
+            }
+        } else if (!stagingRing->upload(mesh.vertexData, mesh.vertexBytes(), vertexBuffer,
+                                        VkDeviceSize(model.firstVertex) * sizeof(Vertex))) {
+            return;
+        }
+
+        const VkDeviceSize indexOffset = VkDeviceSize(model.firstIndex) * indexSize;
+        if (mesh.indexSize == indexSize) {
+            if (!stagingRing->upload(mesh.indexData, mesh.indexBytes(), indexBuffer, indexOffset)) {
+                return;
+            }
+            continue;
+        }
+        // 16-bit model in a 32-bit scene: widen block by block
+        const uint16_t* indices = static_cast<const uint16_t*>(mesh.indexData);
+        const size_t blockIndices = stagingRing->blockSize() / sizeof(uint32_t);
+        for (size_t first = 0; first < mesh.indexCount; first += blockIndices) {
+            size_t count = std::min(blockIndices, mesh.indexCount - first);
+            StagingRing::Block block;
+            if (!stagingRing->acquire(block)) {
+                return;
+            }
+            std::copy(indices + first, indices + first + count, static_cast<uint32_t*>(block.data));
+            stagingRing->submit(block, indexBuffer, indexOffset + first * sizeof(uint32_t), count * sizeof(uint32_t));
+        }
+    }
+
+    if (meshletBuffer == VK_NULL_HANDLE) {
+        return;
+    }
+    std::vector<glm::mat4> transforms;
+    for (const Model& model : registry->models()) {
+        const MeshView& mesh = model.mesh;
+        if (!stagingRing->upload(mesh.meshlets.data(), mesh.meshlets.size() * sizeof(Meshlet), meshletBuffer,
+                                 VkDeviceSize(model.firstMeshlet) * sizeof(Meshlet)) ||
+            !stagingRing->upload(mesh.meshletVertices, mesh.meshletVertexCount * sizeof(uint32_t), meshletVertexBuffer,
+                                 VkDeviceSize(model.firstMeshletVertex) * sizeof(uint32_t)) ||
+            !stagingRing->upload(mesh.meshletTriangles, mesh.meshletTriangleCount * sizeof(uint32_t),
+                                 meshletTriangleBuffer, VkDeviceSize(model.firstMeshletTriangle) * sizeof(uint32_t))) {
+            return;
+        }
+        transforms.push_back(model.transform);
+    }
+    stagingRing->upload(transforms.data(), transforms.size() * sizeof(glm::mat4), modelTransformBuffer);
+}
+
+void VulkanRenderer::updateMeshResidency() {
+    if (meshResident || !meshStreamed || !stagingRing->idle()) {
+        return;
+    }
+    meshResident = true;
+    aout << "Mesh resident "
+         << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - streamStart).count()
+         << " ms after its buffers were created" << std::endl;
+}
+
+void VulkanRenderer::createMeshletDescriptorSet() {
+    if (meshletBuffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 5;
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &meshletDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = meshletDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &meshletSetLayout;
+    if (vkAllocateDescriptorSets(device, &allocInfo, &meshletDescriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate meshlet descriptor set!");
+    }
+
+    // Bindings 0-4 of meshlet.task / meshlet.mesh
+    std::array<VkDescriptorBufferInfo, 5> bufferInfos{};
+    bufferInfos[0].buffer = meshletBuffer;
+    bufferInfos[1].buffer = vertexBuffer;
+    bufferInfos[2].buffer = meshletVertexBuffer;
+    bufferInfos[3].buffer = meshletTriangleBuffer;
+    bufferInfos[4].buffer = modelTransformBuffer;
+    std::array<VkWriteDescriptorSet, 5> writes{};
+    for (uint32_t i = 0; i < writes.size(); i++) {
+        bufferInfos[i].offset = 0;
+        bufferInfos[i].range = VK_WHOLE_SIZE;
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = meshletDescriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].descriptorCount = 1;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 }
 
 void VulkanRenderer::createUniformBuffers() {
@@ -1307,24 +3586,41 @@ void VulkanRenderer::createUniformBuffers() {
 }
 
 void VulkanRenderer::createDescriptorPool() {
-    // Phase 1: Allocate for MAX_PHASE_1_TEXTURES textures
-    // Phase 2 (Bindless): Will need much larger pool
-    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    // Phase 1: Allocate for MAX_PHASE_1_TEXTURES textures, or the packed image and its table
+    // Phase 2 (Bindless): the whole table of every set
+    // Virtual: the tile cache, the texture table and each set's page table and feedback
+    uint32_t samplerCount = MAX_PHASE_1_TEXTURES;
+    uint32_t storageBufferCount = 0;
+    if (textureBinding == TextureBinding::Packed) {
+        samplerCount = 1;
+        storageBufferCount = 1;
+    } else if (textureBinding == TextureBinding::Virtual) {
+        samplerCount = 1;
+        storageBufferCount = 3;
+    } else if (textureBinding == TextureBinding::Bindless) {
+        samplerCount = bindlessCapacity;
+    }
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_PHASE_1_TEXTURES * MAX_FRAMES_IN_FLIGHT);
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(samplerCount * MAX_FRAMES_IN_FLIGHT);
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[2].descriptorCount = static_cast<uint32_t>(storageBufferCount * MAX_FRAMES_IN_FLIGHT);
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.poolSizeCount = static_cast<uint32_t>(storageBufferCount > 0 ? poolSizes.size() : 2);
     poolInfo.pPoolSizes = poolSizes.data();
     poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    if (textureBinding == TextureBinding::Bindless) {
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    }
 
     if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor pool!");
     }
-    aout << "Created descriptor pool with capacity for " << MAX_PHASE_1_TEXTURES << " textures" << std::endl;
+    aout << "Created descriptor pool with capacity for " << samplerCount << " texture descriptors" << std::endl;
 }
 
 void VulkanRenderer::createDescriptorSets() {
@@ -1335,10 +3631,22 @@ void VulkanRenderer::createDescriptorSets() {
     allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
     allocInfo.pSetLayouts = layouts.data();
 
-    descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+    // The bindless table is variable-sized; every set takes the full capacity
+    std::vector<uint32_t> tableSizes(MAX_FRAMES_IN_FLIGHT, bindlessCapacity);
+    VkDescriptorSetVariableDescriptorCountAllocateInfoEXT variableCountInfo{};
+    variableCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT;
+    variableCountInfo.descriptorSetCount = static_cast<uint32_t>(tableSizes.size());
+    variableCountInfo.pDescriptorCounts = tableSizes.data();
+    if (textureBinding == TextureBinding::Bindless) {
+        allocInfo.pNext = &variableCountInfo;
+    }
+
+    std::vector<VkDescriptorSet> sets(MAX_FRAMES_IN_FLIGHT);
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
+    // Published afterwards, so registerTexture only writes sets that exist
+    descriptorSets = sets;
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         VkDescriptorBufferInfo bufferInfo{};
@@ -1347,12 +3655,27 @@ void VulkanRenderer::createDescriptorSets() {
         bufferInfo.range = sizeof(UniformBufferObject);
 
         std::vector<VkDescriptorImageInfo> textureInfos;
+        std::vector<uint32_t> textureElements;
 
-        for (size_t t = 0; t < numTextures && t < MAX_PHASE_1_TEXTURES; t++) {
+        // Packed: textureImageViews / textureSamplers hold the one array image. Bindless:
+        // every texture registered so far goes to its slot, through the shared sampler.
+        for (size_t t = 0; t < textureImageViews.size(); t++) {
             VkDescriptorImageInfo imageInfo{};
             imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
             imageInfo.imageView = textureImageViews[t];
-            imageInfo.sampler = textureSamplers[t];
+            if (textureBinding == TextureBinding::Bindless) {
+                if (textureImageViews[t] == VK_NULL_HANDLE) {
+                    continue;
+                }
+                imageInfo.sampler = textureSamplers[0];
+                textureElements.push_back(textureSlots[t]);
+            } else {
+                if (t >= MAX_PHASE_1_TEXTURES) {
+                    break;
+                }
+                imageInfo.sampler = textureSamplers[t];
+                textureElements.push_back(static_cast<uint32_t>(t));
+            }
             textureInfos.push_back(imageInfo);
         }
 
@@ -1368,15 +3691,55 @@ void VulkanRenderer::createDescriptorSets() {
         uboWrite.pBufferInfo = &bufferInfo;
         descriptorWrites.push_back(uboWrite);
 
-        VkWriteDescriptorSet textureWrite{};
-        textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        textureWrite.dstSet = descriptorSets[i];
-        textureWrite.dstBinding = 1;
-        textureWrite.dstArrayElement = 0;
-        textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        textureWrite.descriptorCount = static_cast<uint32_t>(textureInfos.size());
-        textureWrite.pImageInfo = textureInfos.data();
-        descriptorWrites.push_back(textureWrite);
+        for (size_t t = 0; t < textureInfos.size(); t++) {
+            VkWriteDescriptorSet textureWrite{};
+            textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            textureWrite.dstSet = descriptorSets[i];
+            textureWrite.dstBinding = 1;
+            textureWrite.dstArrayElement = textureElements[t];
+            textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            textureWrite.descriptorCount = 1;
+            textureWrite.pImageInfo = &textureInfos[t];
+            descriptorWrites.push_back(textureWrite);
+        }
+
+        VkDescriptorBufferInfo rectInfo{};
+        rectInfo.buffer = textureRectBuffer;
+        rectInfo.offset = 0;
+        rectInfo.range = VK_WHOLE_SIZE;
+        if (textureBinding == TextureBinding::Packed) {
+            VkWriteDescriptorSet rectWrite{};
+            rectWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            rectWrite.dstSet = descriptorSets[i];
+            rectWrite.dstBinding = 2;
+            rectWrite.dstArrayElement = 0;
+            rectWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            rectWrite.descriptorCount = 1;
+            rectWrite.pBufferInfo = &rectInfo;
+            descriptorWrites.push_back(rectWrite);
+        }
+
+        // Virtual: the texture table, then this frame's page table and feedback bits
+        std::array<VkDescriptorBufferInfo, 3> virtualInfos{};
+        if (textureBinding == TextureBinding::Virtual) {
+            virtualInfos[0].buffer = virtualTextureInfoBuffer;
+            virtualInfos[1].buffer = virtualFrames[i].pageTable;
+            virtualInfos[2].buffer = virtualFrames[i].feedback;
+            for (uint32_t b = 0; b < virtualInfos.size(); b++) {
+                virtualInfos[b].offset = 0;
+                virtualInfos[b].range = VK_WHOLE_SIZE;
+
+                VkWriteDescriptorSet bufferWrite{};
+                bufferWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                bufferWrite.dstSet = descriptorSets[i];
+                bufferWrite.dstBinding = 2 + b;
+                bufferWrite.dstArrayElement = 0;
+                bufferWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                bufferWrite.descriptorCount = 1;
+                bufferWrite.pBufferInfo = &virtualInfos[b];
+                descriptorWrites.push_back(bufferWrite);
+            }
+        }
 
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
     }
@@ -1432,6 +3795,17 @@ void VulkanRenderer::drawFrame() {
     if (std::chrono::duration<float>(currentTime - lastFpsTime).count() >= 1.0f) {
         float fps = frameCount / std::chrono::duration<float>(currentTime - lastFpsTime).count();
         aout << "FPS: " << fps << std::endl;
+        if (textureResidency) {
+            aout << "Textures: " << textureResidency->residentBytes() / 1024 << " KB resident of a "
+                 << textureResidency->budget() / 1024 << " KB budget, " << textureResidency->evictedBytes() / 1024
+                 << " KB evicted, " << textureResidency->reloads() << " reloads, " << textureStreams.size()
+                 << " streaming" << std::endl;
+        }
+        if (virtualCache) {
+            aout << "Virtual textures: " << virtualCache->residentPages() << "/" << virtualCache->slotCount()
+                 << " tiles resident, " << virtualCache->loadedPages() << " loaded, "
+                 << virtualCache->evictedPages() << " evicted" << std::endl;
+        }
         frameCount = 0;
         lastFpsTime = currentTime;
     }
@@ -1440,6 +3814,12 @@ void VulkanRenderer::drawFrame() {
     camera.updateTurntableDamping(deltaTime);
 
     vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    if (textureTable) {
+        retireTextures();
+    }
+    if (textureResidency && assetsReady) {
+        updateTextureResidency();
+    }
 
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
@@ -1453,6 +3833,9 @@ void VulkanRenderer::drawFrame() {
     }
 
     updateUniformBuffer(currentFrame);
+    if (virtualCache) {
+        updateVirtualTextures();
+    }
 
     vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
@@ -1477,6 +3860,7 @@ void VulkanRenderer::drawFrame() {
     if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
+    frameNumber++;
 
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -1508,6 +3892,13 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
+    if (virtualCache) {
+        recordTileCopies(commandBuffer);
+    }
+    if (!textureStreams.empty()) {
+        recordTextureStreams(commandBuffer);
+    }
+
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassInfo.renderPass = renderPass;
@@ -1519,12 +3910,31 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
     clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
     clearValues[1].depthStencil = {1.0f, 0};
 
+    // Placeholder while the startup tasks are still loading: a dark grey frame
+    if (!assetsReady) {
+        clearValues[0].color = {{0.1f, 0.1f, 0.1f, 1.0f}};
+    }
+
     renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassInfo.pClearValues = clearValues.data();
 
     vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    // Geometry keeps streaming after assetsReady; nothing is drawn until its first
+    // blocks have landed
+    VkDeviceSize landedVertexBytes = 0;
+    VkDeviceSize landedIndexBytes = 0;
+    if (assetsReady) {
+        landedVertexBytes = meshResident ? VK_WHOLE_SIZE : stagingRing->landed(vertexBuffer);
+        landedIndexBytes = meshResident ? VK_WHOLE_SIZE : stagingRing->landed(indexBuffer);
+    }
+    if (landedVertexBytes == 0 || landedIndexBytes == 0) {
+        vkCmdEndRenderPass(commandBuffer);
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+        return;
+    }
 
     VkViewport viewport{};
     viewport.x = 0.0f;
@@ -1548,28 +3958,183 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
     scissor.extent = swapChainExtent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    VkBuffer vertexBuffers[] = {vertexBuffer};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    if (meshletDescriptorSet != VK_NULL_HANDLE) {
+        // Task and mesh shaders may read any meshlet, so they wait for the whole scene
+        if (meshResident) {
+            drawMeshlets(commandBuffer);
+        }
+    } else {
+        // One bind of the shared buffers for the whole scene; models only differ in
+        // their push constants and ranges
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+
+        VkBuffer vertexBuffers[] = {vertexBuffer};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0,
+                             registry->indexSize() == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+
+        const VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        const VkDeviceSize vertexStride = vertexFormat == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+        const glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+        uint32_t texture = UINT32_MAX;
+        for (Model& model : registry->models()) {
+            // A model is drawn once all of its vertices have landed, which also
+            // publishes its quantization from the worker
+            const MeshView& mesh = model.mesh;
+            if (!meshResident &&
+                (VkDeviceSize(model.firstVertex) + mesh.vertexCount) * vertexStride > landedVertexBytes) {
+                continue;
+            }
+            const MeshLod& lod = mesh.lods[selectLod(model)];
+
+            DrawPushConstants constants{};
+            constants.model = model.transform;
+            constants.quantization = model.quantization;
+            vkCmdPushConstants(commandBuffer, pipelineLayout, stages, offsetof(DrawPushConstants, model),
+                               sizeof(constants) - offsetof(DrawPushConstants, model), &constants.model);
+
+            // Meshlets outside the frustum or facing away are skipped; the rest of each
+            // 64K-vertex range is drawn as a few contiguous runs of the index buffer.
+            // Bounds are in model space, so the camera is brought there.
+            uint32_t firstMeshlet = model.rangeMeshlets[lod.firstRange];
+            uint32_t meshletCount = model.rangeMeshlets[lod.firstRange + lod.rangeCount] - firstMeshlet;
+            if (meshletCount > 0) {
+                MeshletCullInfo cullInfo = makeMeshletCullInfo(viewProjection * model.transform,
+                                                               camera.getViewMatrix() * model.transform);
+                cullMeshlets(mesh.meshlets, mesh.ranges, firstMeshlet, meshletCount, cullInfo, visibleRanges);
+            } else {
+                visibleRanges.assign(mesh.ranges.begin() + lod.firstRange,
+                                     mesh.ranges.begin() + lod.firstRange + lod.rangeCount);
+            }
+            // Ranges are sorted by material, so the texture changes at most once per material
+            for (const DrawRange& range : visibleRanges) {
+                if (!meshResident &&
+                    (VkDeviceSize(range.firstIndex) + range.indexCount) * registry->indexSize() > landedIndexBytes) {
+                    continue;  // Still streaming
+                }
+                if (range.texture != texture) {
+                    texture = range.texture;
+                    if (textureResidency) {
+                        textureResidency->markUsed(texture, frameNumber);
+                    }
+                    const uint32_t descriptor = textureDescriptor(texture);
+                    vkCmdPushConstants(commandBuffer, pipelineLayout, stages, offsetof(DrawPushConstants, texture),
+                                       sizeof(descriptor), &descriptor);
+                }
+                vkCmdDrawIndexed(commandBuffer, range.indexCount, 1, range.firstIndex, range.vertexOffset, 0);
+            }
+        }
+    }
+
+    vkCmdEndRenderPass(commandBuffer);
 
-    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    // The feedback bits are read on the CPU once the frame's fence has signalled
+    if (virtualCache) {
+        VkMemoryBarrier feedbackBarrier{};
+        feedbackBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        feedbackBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        feedbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                             1, &feedbackBarrier, 0, nullptr, 0, nullptr);
+    }
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+}
 
-    // Log draw info once
-    static bool logged = false;
-    if (!logged) {
-        aout << "Drawing " << indices.size() << " indices, " << vertices.size() << " vertices" << std::endl;
-        logged = true;
+void VulkanRenderer::drawMeshlets(VkCommandBuffer commandBuffer) {
+#ifdef VK_EXT_mesh_shader
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshletPipeline);
+    std::array<VkDescriptorSet, 2> sets = {descriptorSets[currentFrame], meshletDescriptorSet};
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshletPipelineLayout, 0,
+                            static_cast<uint32_t>(sets.size()), sets.data(), 0, nullptr);
+
+    const VkShaderStageFlags stages =
+            VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    const glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+    std::vector<Model>& models = registry->models();
+    for (uint32_t m = 0; m < models.size(); m++) {
+        Model& model = models[m];
+        const MeshLod& lod = model.mesh.lods[selectLod(model)];
+
+        // The task shader culls with the same test as the CPU path, 32 meshlets per
+        // workgroup, in the model's space; the mesh shader reads its transform by index
+        MeshletCullInfo cullInfo = makeMeshletCullInfo(viewProjection * model.transform,
+                                                       camera.getViewMatrix() * model.transform);
+        MeshletPushConstants constants{};
+        constants.model = m;
+        std::copy(std::begin(cullInfo.frustumPlanes), std::end(cullInfo.frustumPlanes), constants.frustumPlanes);
+        constants.eye = glm::vec4(cullInfo.eye, 1.0f);
+        vkCmdPushConstants(commandBuffer, meshletPipelineLayout, stages, 0, sizeof(constants), &constants);
+
+        // One launch per range, so each material's texture is a push constant; only the
+        // leading texture / meshlet words change between them
+        for (uint32_t r = lod.firstRange; r < lod.firstRange + lod.rangeCount; r++) {
+            constants.texture = textureDescriptor(model.mesh.ranges[r].texture);
+            constants.firstMeshlet = model.firstMeshlet + model.rangeMeshlets[r];
+            constants.meshletCount = model.rangeMeshlets[r + 1] - model.rangeMeshlets[r];
+            if (constants.meshletCount == 0) {
+                continue;
+            }
+            if (textureResidency) {
+                // The task shader culls on the GPU, so every launched range counts as in view
+                textureResidency->markUsed(model.mesh.ranges[r].texture, frameNumber);
+            }
+            vkCmdPushConstants(commandBuffer, meshletPipelineLayout, stages, 0,
+                               offsetof(MeshletPushConstants, frustumPlanes), &constants);
+            cmdDrawMeshTasks(commandBuffer, (constants.meshletCount + 31) / 32, 1, 1);
+        }
     }
+#else
+    (void)commandBuffer;
+#endif
+}
 
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+uint32_t VulkanRenderer::selectLod(Model& model) {
+    const MeshView& mesh = model.mesh;
+    if (mesh.lods.size() < 2) {
+        return 0;
+    }
 
-    vkCmdEndRenderPass(commandBuffer);
+    // Bounding sphere of the model in world space (the UBO model matrix is identity)
+    // projected with the camera FOV: pixels per world unit at the sphere's nearest
+    // point, and errors scaled from mesh to world units by the largest axis scale
+    float scale = std::max({glm::length(glm::vec3(model.transform[0])), glm::length(glm::vec3(model.transform[1])),
+                            glm::length(glm::vec3(model.transform[2]))});
+    glm::vec3 center = glm::vec3(model.transform * glm::vec4((mesh.boundsMin + mesh.boundsMax) * 0.5f, 1.0f));
+    float radius = glm::length(mesh.boundsMax - mesh.boundsMin) * 0.5f * scale;
+    float distance = glm::length(camera.getPosition() - center) - radius;
+    uint32_t level = std::min<uint32_t>(model.currentLod, uint32_t(mesh.lods.size() - 1));
+    if (distance <= 0.0f) {
+        level = 0;
+    } else {
+        float pixelsPerUnit = float(swapChainExtent.height) * 0.5f /
+                              (distance * std::tan(glm::radians(camera.getFov()) * 0.5f));
+        auto pixelError = [&](uint32_t candidate) { return mesh.lods[candidate].error * scale * pixelsPerUnit; };
+
+        // Refine while the current level is visibly off; coarsen only with margin, so a
+        // camera resting near a threshold does not pop back and forth
+        while (level > 0 && pixelError(level) > LOD_PIXEL_ERROR) {
+            level--;
+        }
+        while (level + 1 < mesh.lods.size() && pixelError(level + 1) <= LOD_PIXEL_ERROR * LOD_HYSTERESIS) {
+            level++;
+        }
+    }
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
+    // Log draw info when the level changes
+    if (level != model.currentLod) {
+        const MeshLod& lod = mesh.lods[level];
+        aout << model.file << ": drawing LOD " << level << ", " << lod.indexCount << " indices in "
+             << lod.rangeCount << " ranges" << std::endl;
     }
+    model.currentLod = level;
+    return level;
 }
 
 void VulkanRenderer::updateUniformBuffer(uint32_t currentImage) {
@@ -1588,11 +4153,20 @@ void VulkanRenderer::updateUniformBuffer(uint32_t currentImage) {
     memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
 }
 
-VkShaderModule VulkanRenderer::createShaderModule(const std::vector<char>& code) {
+VkShaderModule VulkanRenderer::createShaderModule(const AssetData& code) {
+    // pCode must be 4-byte aligned; APK entries usually are, copy only if not
+    std::vector<uint32_t> alignedCode;
+    const uint32_t* words = static_cast<const uint32_t*>(code.data);
+    if (reinterpret_cast<uintptr_t>(code.data) % alignof(uint32_t) != 0) {
+        alignedCode.resize((code.size + 3) / 4);
+        memcpy(alignedCode.data(), code.data, code.size);
+        words = alignedCode.data();
+    }
+
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    createInfo.codeSize = code.size;
+    createInfo.pCode = words;
 
     VkShaderModule shaderModule;
     if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
@@ -1823,15 +4397,17 @@ bool VulkanRenderer::hasStencilComponent(VkFormat format) {
 
 void VulkanRenderer::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples,
                                  VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-                                 VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+                                 VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
+                                 VkImageCreateFlags flags, uint32_t arrayLayers) {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.flags = flags;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.extent.width = width;
     imageInfo.extent.height = height;
     imageInfo.extent.depth = 1;
     imageInfo.mipLevels = mipLevels;
-    imageInfo.arrayLayers = 1;
+    imageInfo.arrayLayers = arrayLayers;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -1858,17 +4434,18 @@ void VulkanRenderer::createImage(uint32_t width, uint32_t height, uint32_t mipLe
     vkBindImageMemory(device, image, imageMemory, 0);
 }
 
-VkImageView VulkanRenderer::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
+VkImageView VulkanRenderer::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels,
+                                            VkImageViewType viewType, uint32_t layerCount, uint32_t baseMipLevel) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.viewType = viewType;
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
-    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
     viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    viewInfo.subresourceRange.layerCount = layerCount;
 
     VkImageView imageView;
     if (vkCreateImageView(device, &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
@@ -1878,7 +4455,8 @@ VkImageView VulkanRenderer::createImageView(VkImage image, VkFormat format, VkIm
     return imageView;
 }
 
-void VulkanRenderer::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
+void VulkanRenderer::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels,
+                                           uint32_t layerCount, uint32_t baseMipLevel) {
     VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
     VkImageMemoryBarrier barrier{};
@@ -1889,10 +4467,10 @@ void VulkanRenderer::transitionImageLayout(VkImage image, VkFormat format, VkIma
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.baseMipLevel = baseMipLevel;
     barrier.subresourceRange.levelCount = mipLevels;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.layerCount = layerCount;
 
     VkPipelineStageFlags sourceStage;
     VkPipelineStageFlags destinationStage;
@@ -1925,11 +4503,12 @@ void VulkanRenderer::transitionImageLayout(VkImage image, VkFormat format, VkIma
     endSingleTimeCommands(commandBuffer);
 }
 
-void VulkanRenderer::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
+void VulkanRenderer::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height,
+                                       VkDeviceSize bufferOffset) {
     VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
     VkBufferImageCopy region{};
-    region.bufferOffset = 0;
+    region.bufferOffset = bufferOffset;
     region.bufferRowLength = 0;
     region.bufferImageHeight = 0;
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -2026,17 +4605,10 @@ uint32_t VulkanRenderer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFla
     throw std::runtime_error("failed to find suitable memory type!");
 }
 
-std::vector<char> VulkanRenderer::readFile(const std::string& filename) {
-    AAsset* file = AAssetManager_open(app_->activity->assetManager, filename.c_str(), AASSET_MODE_BUFFER);
+AssetData VulkanRenderer::readFile(const std::string& filename) {
+    AssetData file = assets->open(filename);
     if (!file) {
         throw std::runtime_error("failed to open file: " + filename);
     }
-
-    size_t fileLength = AAsset_getLength(file);
-    std::vector<char> fileContent(fileLength);
-
-    AAsset_read(file, fileContent.data(), fileLength);
-    AAsset_close(file);
-
-    return fileContent;
+    return file;
 }
\ No newline at end of file
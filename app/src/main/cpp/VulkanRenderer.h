@@ -6,6 +6,7 @@
 #include <vector>
 #include <optional>
 #include <array>
+#include <mutex>
 #include <unordered_map>
 
 #define GLM_FORCE_RADIANS
@@ -18,7 +19,24 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "Camera.h"
+#include "Mesh.h"
+#include "MeshletBuilder.h"
+#include "VertexQuantizer.h"
 #include "CameraController.h"
+#include "ThreadPool.h"
+#include "AssetSource.h"
+#include "AssetCache.h"
+#include "TaskGraph.h"
+#include "ObjParser.h"
+#include "ModelRegistry.h"
+#include "StagingRing.h"
+#include "TexturePacker.h"
+#include "TextureResidency.h"
+#include "TextureStagingRing.h"
+#include "TextureTable.h"
+#include "VirtualTextureCache.h"
+#include "VirtualTextureFile.h"
+#include <deque>
 #include <memory>
 
 struct QueueFamilyIndices {
@@ -36,29 +54,62 @@ struct SwapChainSupportDetails {
     std::vector<VkPresentModeKHR> presentModes;
 };
 
-struct Vertex {
-    glm::vec3 pos;
-    glm::vec3 color;
-    glm::vec2 texCoord;
-    int texIndex;
+// Vulkan input layout of Vertex or PackedVertex (see Mesh.h)
+VkVertexInputBindingDescription getVertexBindingDescription(VertexFormat format);
+std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions(VertexFormat format);
+
+// Texture read on a worker, waiting for upload on the main thread: either the mip levels
+// of a pre-encoded .ktx2 variant, or the PNG decoded (or mapped from the asset cache) to
+// RGBA8, with its chain built on the worker when bindless textures stream progressively.
+// Both are empty when the file is missing or broken; a white texel is uploaded instead.
+// RGBA8 pixels and chains may live in the texture staging ring, which gets the range
+// back when the last copy of them goes.
+struct DecodedTexture {
+    std::string filename;
+    int width = 0;
+    int height = 0;
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    AssetData pixels;               // RGBA8, width * height * 4 bytes
+    std::vector<AssetData> levels;  // every mip level in format, level 0 first; pixels is then empty
+};
 
-    static VkVertexInputBindingDescription getBindingDescription();
-    static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions();
+// Push constants of the vertex pipeline: the texture of the draw range (read by
+// shader.frag; its TextureTable slot in bindless mode), then the transform and
+// dequantization constants of the drawn model
+struct DrawPushConstants {
+    uint32_t texture;
+    uint32_t padding[3];
+    glm::mat4 model;
+    VertexQuantization quantization;
+};
 
-    bool operator==(const Vertex& other) const {
-        return pos == other.pos && color == other.color && texCoord == other.texCoord && texIndex == other.texIndex;
-    }
+// Push constants of the meshlet path: the texture, meshlets and model of the drawn
+// range, then the cull data of MeshletCullInfo in that model's space for meshlet.task
+struct MeshletPushConstants {
+    uint32_t texture;
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    uint32_t model;
+    glm::vec4 frustumPlanes[6];
+    glm::vec4 eye;
 };
 
-namespace std {
-    template<> struct hash<Vertex> {
-        size_t operator()(Vertex const& vertex) const {
-            return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-                  (hash<glm::vec2>()(vertex.texCoord) << 1) ^
-                  (std::hash<int>()(vertex.texIndex) << 2);
-        }
-    };
-}
+// shader.frag is shared by both pipelines
+static_assert(offsetof(DrawPushConstants, texture) == offsetof(MeshletPushConstants, texture),
+              "texture push constant must line up");
+static_assert(sizeof(DrawPushConstants) <= 128, "push constants beyond the guaranteed 128 bytes");
+static_assert(sizeof(MeshletPushConstants) <= 128, "push constants beyond the guaranteed 128 bytes");
+
+// std430 entry of the virtual texture table shader_virtual.frag reads (binding 2): the
+// texture's size and where its pages start in the page table, per level
+struct VirtualTextureInfo {
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;  // 0 for a missing texture
+    uint32_t firstPage;
+    uint32_t levelFirstPage[kVirtualTextureMaxLevels];
+};
+static_assert(sizeof(VirtualTextureInfo) == 80, "VirtualTextureInfo must match the shader's struct");
 
 struct UniformBufferObject {
     alignas(16) glm::mat4 model;
@@ -95,12 +146,78 @@ private:
 
     static constexpr int MAX_PHASE_1_TEXTURES = 16;  // Reasonable limit for mobile
 
-    // Material to texture mapping
-    std::unordered_map<std::string, int> materialToTextureIndex;
-    std::unordered_map<std::string, std::string> materialToTextureFile;
+    // How binding 1 holds the textures: MAX_PHASE_1_TEXTURES images with a sampler each,
+    // one packed array image, a descriptor indexing table the draws index by slot, or the
+    // tile cache of the virtual textures
+    enum class TextureBinding {
+        PerTexture,
+        Packed,
+        Bindless,
+        Virtual,
+    };
+
+    // Stream textures as 128x128 tiles into one cache image, driven by what the frames
+    // sample (see VirtualTextureCache.h). Meant for textures far larger than memory, so
+    // it is off for the bundled ones, which load faster whole.
+    const bool virtualTexturing = false;
+    // The cache image is VIRTUAL_CACHE_TILES tiles (with their borders) on a side
+    static constexpr uint32_t VIRTUAL_CACHE_TILES = 16;
+    // Tiles decoding on the workers at once, and copied into the cache per frame
+    static constexpr uint32_t VIRTUAL_TILE_LOADS_IN_FLIGHT = 16;
+    static constexpr uint32_t VIRTUAL_TILE_UPLOADS_PER_FRAME = 8;
+    // One pixel in VIRTUAL_FEEDBACK_CYCLE reports its page each frame; a page seen
+    // within that many frames is not evicted
+    static constexpr uint32_t VIRTUAL_FEEDBACK_CYCLE = 64;
+
+    // Register textures into one runtime-sized descriptor array (VK_EXT_descriptor_indexing)
+    // when the device and the shader support it; otherwise pack them, or bind them one by one
+    const bool bindlessTextures = true;
+    // Upper bound of the bindless table; the device limits may lower it
+    static constexpr uint32_t MAX_BINDLESS_TEXTURES = 4096;
+    // Bindless textures are kept under TEXTURE_MEMORY_BUDGET, or under what
+    // VK_EXT_memory_budget leaves of the device-local heaps minus TEXTURE_HEAP_HEADROOM
+    // (see TextureResidency.h). Textures no draw sampled for TEXTURE_IDLE_FRAMES lose
+    // their levels above TEXTURE_MIN_LEVEL_BYTES, then their image, at most
+    // TEXTURE_TRIMS_PER_FRAME per frame; the heap budget is read every
+    // TEXTURE_BUDGET_QUERY_FRAMES.
+    static constexpr uint64_t TEXTURE_MEMORY_BUDGET = 256ull << 20;
+    static constexpr uint64_t TEXTURE_HEAP_HEADROOM = 64ull << 20;
+    static constexpr uint64_t TEXTURE_IDLE_FRAMES = 300;
+    static constexpr uint64_t TEXTURE_MIN_LEVEL_BYTES = 64 * 64 * 4;
+    static constexpr size_t TEXTURE_TRIMS_PER_FRAME = 2;
+    static constexpr uint64_t TEXTURE_BUDGET_QUERY_FRAMES = 60;
+    // Bindless textures stream in coarse to fine: one is drawn as soon as its mip tail,
+    // the levels of at most TEXTURE_STREAM_TAIL_SIZE texels a side, is uploaded, and its
+    // finer levels follow in the frame command buffers, at most
+    // TEXTURE_STREAM_BYTES_PER_FRAME a frame across all textures
+    const bool progressiveTextures = true;
+    static constexpr uint32_t TEXTURE_STREAM_TAIL_SIZE = 64;
+    static constexpr VkDeviceSize TEXTURE_STREAM_BYTES_PER_FRAME = 2ull << 20;
+    // Sample every texture from one 2D array image (see TexturePacker.h) when the shader
+    // has the packed variant; otherwise each texture gets its own image and sampler
+    const bool packTextures = true;
+    // Atlas tiles are kept apart down to this many levels; their gutters are
+    // 2^(ATLAS_MIP_LEVELS - 1) texels wide
+    static constexpr uint32_t ATLAS_MIP_LEVELS = 5;
+    // In the modes that upload each texture as its decode finishes, PNGs are decoded
+    // straight into a mapped ring of this size (see TextureStagingRing.h); one that
+    // does not fit right then is decoded to the heap and copied at upload as before
+    static constexpr VkDeviceSize TEXTURE_STAGING_SIZE = 32ull << 20;
+
+    // LOD selection: the coarsest level whose error projects below LOD_PIXEL_ERROR is
+    // drawn; switching to a coarser level needs LOD_HYSTERESIS times less than that
+    static constexpr float LOD_PIXEL_ERROR = 1.0f;
+    static constexpr float LOD_HYSTERESIS = 0.5f;
+
+    // Bump when the OBJ build, the PNG decode or the Basis transcode changes its output,
+    // so cached results of the old code miss
+    static constexpr uint32_t MESH_CACHE_VERSION = 3;
+    static constexpr uint32_t TEXTURE_CACHE_VERSION = 1;
+    static constexpr uint32_t TRANSCODE_CACHE_VERSION = 1;
 
     // Vulkan objects
     VkInstance instance = VK_NULL_HANDLE;
+    uint32_t instanceApiVersion = VK_API_VERSION_1_0;
     VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
     VkSurfaceKHR surface = VK_NULL_HANDLE;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
@@ -129,14 +246,144 @@ private:
     std::vector<VkDeviceMemory> textureImageMemories;
     std::vector<VkImageView> textureImageViews;
     std::vector<VkSampler> textureSamplers;
+    std::vector<uint32_t> textureMipLevels;
+    std::vector<VkFormat> textureFormats;
+    std::vector<VkExtent2D> textureExtents;  // of each image's first level
     int numTextures = 0;
-
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
+    // File name suffixes of the .ktx2 variants this device samples, best first (see
+    // selectTextureVariants); textures without one fall back to the PNG
+    std::vector<std::string> textureVariants;
+    // Formats Basis .ktx2 files are transcoded to, for opaque textures and those with
+    // alpha; RGBA8 when the device samples no block format the transcoder writes
+    VkFormat transcodeFormat = VK_FORMAT_R8G8B8A8_SRGB;
+    VkFormat transcodeAlphaFormat = VK_FORMAT_R8G8B8A8_SRGB;
+    // Mip chains are blitted when the texture format filters linearly, otherwise built
+    // by the mipmap.comp pipeline (left null when that shader asset is missing)
+    bool linearBlitSupported = false;
+    TextureBinding textureBinding = TextureBinding::PerTexture;
+    // Packed mode: textureImages etc. hold the single array image, texturePack says
+    // where each texture is in it, and textureRectBuffer has its TextureRects
+    TexturePack texturePack;
+    VkBuffer textureRectBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory textureRectBufferMemory = VK_NULL_HANDLE;
+    // Bindless mode: textureImages etc. hold the registry's textures plus a white
+    // placeholder at the end, all sampled through textureSamplers[0]. textureSlots maps
+    // each texture to its slot of the table, the placeholder's until it is registered.
+    // Released textures are destroyed once the frames that might sample them are done.
+    uint32_t bindlessCapacity = 0;  // 0 without descriptor indexing
+    std::unique_ptr<TextureTable> textureTable;
+    std::vector<uint32_t> textureSlots;
+    uint32_t placeholderSlot = TextureTable::kInvalidSlot;
+    struct RetiredTexture {
+        VkImage image;
+        VkDeviceMemory memory;
+        VkImageView view;
+        uint64_t frames;  // submitted frames that may still sample it
+    };
+    std::deque<RetiredTexture> retiredTextures;
+    // Bindless mode: trims and reloads textureImages under the budget; null otherwise.
+    // getMemoryProperties2 is set when the device has VK_EXT_memory_budget.
+    std::unique_ptr<TextureResidency> textureResidency;
+    PFN_vkGetPhysicalDeviceMemoryProperties2 getMemoryProperties2 = nullptr;
+    // Bindless mode: textures whose finer levels are still being copied. The image has
+    // the whole chain; the view in the texture's slot starts at level, the finest one
+    // copied so far, and a new view and slot replace it as each level above lands. The
+    // chain, and staging taken for levels that are not in the ring, is kept until the
+    // frames copying from it are done.
+    struct TextureStream {
+        int texture;
+        std::vector<AssetData> levels;
+        uint32_t level;
+        uint32_t rows;  // block rows of level - 1 copied so far
+    };
+    std::vector<TextureStream> textureStreams;
+    struct RetiredStaging {
+        std::vector<AssetData> data;
+        uint64_t frames;  // submitted frames that may still copy from it
+    };
+    std::deque<RetiredStaging> retiredStaging;
+    // Virtual mode: textureImages etc. hold the cache image and virtualTextureInfoBuffer
+    // the VirtualTextureInfos. Each frame in flight has its own copy of the page table,
+    // its feedback bits and the staging of the tiles it copies into the cache.
+    bool fragmentStoresSupported = false;
+    std::vector<VirtualTexture> virtualTextures;  // one per registry texture
+    std::unique_ptr<VirtualTextureCache> virtualCache;
+    std::vector<uint32_t> virtualCacheTextures;   // registry texture of each cache texture
+    VkBuffer virtualTextureInfoBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory virtualTextureInfoBufferMemory = VK_NULL_HANDLE;
+    struct VirtualFrame {
+        VkBuffer pageTable = VK_NULL_HANDLE;
+        VkDeviceMemory pageTableMemory = VK_NULL_HANDLE;
+        uint32_t* pageTableMapped = nullptr;
+        uint64_t pageTableVersion = 0;
+        VkBuffer feedback = VK_NULL_HANDLE;
+        VkDeviceMemory feedbackMemory = VK_NULL_HANDLE;
+        uint32_t* feedbackMapped = nullptr;
+        VkBuffer tileStaging = VK_NULL_HANDLE;
+        VkDeviceMemory tileStagingMemory = VK_NULL_HANDLE;
+        uint8_t* tileStagingMapped = nullptr;
+        std::vector<VkBufferImageCopy> tileCopies;  // recorded before the frame's render pass
+    };
+    std::vector<VirtualFrame> virtualFrames;
+    // Tiles the workers have read, in completion order; empty texels when the read failed
+    struct LoadedTile {
+        uint32_t page;
+        std::vector<uint8_t> texels;
+    };
+    std::mutex loadedTilesMutex;
+    std::deque<LoadedTile> loadedTiles;
+    uint32_t tileLoadsInFlight = 0;
+    VkDescriptorSetLayout mipmapSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout mipmapPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline mipmapPipeline = VK_NULL_HANDLE;
+
+    // All asset reads go through here (AAsset_getBuffer on Android)
+    std::unique_ptr<AssetSource> assets;
+    // Built meshes and decoded textures from earlier launches, keyed by source content
+    std::unique_ptr<AssetCache> assetCache;
+
+    // Models of the scene, sharing the vertex, index and meshlet buffers below. A
+    // frame binds them once and draws each model's ranges with its own push constants.
+    std::unique_ptr<ModelRegistry> registry;
+    // Packed when the device and the shader asset support it; each model's constants
+    // are computed in streamMesh and pushed before its draws
+    VertexFormat vertexFormat = VertexFormat::Float;
+    // Without mesh shaders the meshlets that pass culling are drawn as visibleRanges
+    std::vector<DrawRange> visibleRanges;
     VkBuffer vertexBuffer = VK_NULL_HANDLE;
     VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
     VkBuffer indexBuffer = VK_NULL_HANDLE;
     VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+
+    // Geometry streams through the ring after the buffers exist: a worker fills blocks
+    // straight from the mapped mesh while render() submits them between frames. Ranges
+    // are drawn as soon as their vertices and indices have landed; meshResident is set
+    // once the last block has.
+    std::unique_ptr<StagingRing> stagingRing;
+    bool meshStreamed = false;
+    bool meshResident = false;
+    std::chrono::steady_clock::time_point streamStart;
+
+    // VK_EXT_mesh_shader path: used when the device supports task and mesh shaders and
+    // the meshlet shader assets exist; the pipeline reads the buffers below (set 1)
+    bool meshShadersSupported = false;
+    bool useMeshShaders = false;
+#ifdef VK_EXT_mesh_shader
+    PFN_vkCmdDrawMeshTasksEXT cmdDrawMeshTasks = nullptr;
+#endif
+    VkDescriptorSetLayout meshletSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout meshletPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline meshletPipeline = VK_NULL_HANDLE;
+    VkDescriptorPool meshletDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet meshletDescriptorSet = VK_NULL_HANDLE;
+    VkBuffer meshletBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory meshletBufferMemory = VK_NULL_HANDLE;
+    VkBuffer meshletVertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory meshletVertexBufferMemory = VK_NULL_HANDLE;
+    VkBuffer meshletTriangleBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory meshletTriangleBufferMemory = VK_NULL_HANDLE;
+    VkBuffer modelTransformBuffer = VK_NULL_HANDLE;  // mat4 per model
+    VkDeviceMemory modelTransformBufferMemory = VK_NULL_HANDLE;
     std::vector<VkBuffer> uniformBuffers;
     std::vector<VkDeviceMemory> uniformBuffersMemory;
     std::vector<void*> uniformBuffersMapped;
@@ -147,6 +394,7 @@ private:
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
     uint32_t currentFrame = 0;
+    uint64_t frameNumber = 0;  // frames submitted so far
     bool framebufferResized = false;
 
     // Frame timing for smooth animation
@@ -156,6 +404,22 @@ private:
     Camera camera;
     std::unique_ptr<CameraController> cameraController;
 
+    // Worker threads for asset loading
+    std::unique_ptr<ThreadPool> threadPool;
+
+    // Startup DAG (initVulkan). Frames are presented as soon as the swapchain and
+    // pipeline exist; until assetsReady they only clear to the placeholder color.
+    std::unique_ptr<TaskGraph> startup;
+    bool assetsReady = false;
+
+    // Textures the decode workers have finished, with their index in the registry's
+    // texture table. render() uploads them between frames while textureUploadsOpen;
+    // createTextures takes whatever is left once every decode is done.
+    std::mutex decodedTexturesMutex;
+    std::vector<std::pair<int, DecodedTexture>> decodedTextures;
+    bool textureUploadsOpen = false;
+    std::unique_ptr<TextureStagingRing> textureStaging;
+
     // Current surface transform from Vulkan (used to determine device orientation)
     VkSurfaceTransformFlagBitsKHR currentTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 
@@ -173,28 +437,78 @@ private:
     void createImageViews();
     void createDescriptorSetLayout();
     void createGraphicsPipeline();
+    bool supportsPackedVertices();
+    bool checkMeshShaderSupport(const std::vector<VkExtensionProperties>& availableExtensions);
+    uint32_t checkBindlessSupport(const std::vector<VkExtensionProperties>& availableExtensions);
+    void createMeshletPipeline(const AssetData& taskCode, const AssetData& meshCode,
+                               const VkPipelineShaderStageCreateInfo& fragmentStage,
+                               VkGraphicsPipelineCreateInfo pipelineInfo);
+    void createMeshletBuffers();
+    void createMeshletDescriptorSet();
     void createCommandPool();
     void createDepthResources();
     void createRenderPass();
     void createFramebuffers();
+    void selectTextureVariants();
+    void decodeTextures();
+    void prepareTextureUploads();
+    void uploadDecodedTextures();
     void createTextures();
-    void parseMTLFile(const std::string& mtlFilename);
-    void loadModel();
+    bool supportsFragmentVariant(const char* entryPoint, const char* glslFile);
+    TextureBinding selectTextureBinding();
+    void packDecodedTextures();
+    void createPackedTexture();
+    void prepareBindlessTextures();
+    void registerTexture(int textureIndex, uint32_t baseLevel = 0);
+    void releaseTexture(int textureIndex);
+    void retireTextures();
+    void updateTextureResidency();
+    void trimTexture(int textureIndex, uint32_t firstLevel);
+    uint64_t queryTextureBudget();
+    void recordTextureStreams(VkCommandBuffer commandBuffer);
+    bool copyTextureBand(VkCommandBuffer commandBuffer, TextureStream& stream, VkDeviceSize& budget);
+    VirtualTexture loadVirtualTexture(const std::string& filename);
+    void createVirtualTextures();
+    void createVirtualFrames();
+    void updateVirtualTextures();
+    void recordTileCopies(VkCommandBuffer commandBuffer);
+    uint32_t textureDescriptor(uint32_t texture) const;
+    std::vector<MtlMaterial> parseMTLFile(const std::string& mtlFilename);
+    void loadModels();
+    bool loadModel(Model& model);
+    bool loadMeshFile(Model& model, AssetData asset, const std::string& name);
+    void createStagingRing();
     void createVertexBuffer();
     void createIndexBuffer();
+    void streamMesh();
+    void updateMeshResidency();
     void createUniformBuffers();
     void createDescriptorPool();
     void createDescriptorSets();
     void createCommandBuffers();
     void createSyncObjects();
 
-    // Texture helper
-    void loadSingleTexture(const std::string& filename, int textureIndex);
+    // Texture helpers: decodeTexture is safe on worker threads, uploadTexture is not
+    DecodedTexture decodeTexture(const std::string& filename, bool allowEncoded = true);
+    AssetData allocateTextureStaging(size_t size);
+    void buildMipChain(DecodedTexture& texture, AssetData storage);
+    bool decodeKtx2Texture(const std::string& filename, DecodedTexture& texture);
+    bool readKtx2Texture(const AssetData& asset, const std::string& path, DecodedTexture& texture);
+    bool decodeBasisTexture(const std::string& filename, DecodedTexture& texture);
+    bool isSampledFormatSupported(VkFormat format);
+    void uploadTexture(const DecodedTexture& texture, int textureIndex, uint32_t firstLevel = 0);
+    void uploadEncodedTexture(const DecodedTexture& texture, int textureIndex, uint32_t firstLevel = 0);
+    void createMipmapPipeline();
+    void generateMipmaps(VkImage image, int32_t width, int32_t height, uint32_t mipLevels, uint32_t layerCount = 1);
+    void generateMipmapsCompute(VkBuffer pixels, VkImage image, int32_t width, int32_t height, uint32_t mipLevels,
+                                uint32_t layer = 0, VkDeviceSize pixelsOffset = 0);
     // Helper methods
     void drawFrame();
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    uint32_t selectLod(Model& model);
+    void drawMeshlets(VkCommandBuffer commandBuffer);
     void updateUniformBuffer(uint32_t currentImage);
-    VkShaderModule createShaderModule(const std::vector<char>& code);
+    VkShaderModule createShaderModule(const AssetData& code);
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
@@ -210,10 +524,15 @@ private:
     bool hasStencilComponent(VkFormat format);
     void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples,
                      VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-                     VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels);
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+                     VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
+                     VkImageCreateFlags flags = 0, uint32_t arrayLayers = 1);
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels,
+                                VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, uint32_t layerCount = 1,
+                                uint32_t baseMipLevel = 0);
+    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels,
+                               uint32_t layerCount = 1, uint32_t baseMipLevel = 0);
+    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height,
+                           VkDeviceSize bufferOffset = 0);
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
     VkCommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
@@ -222,7 +541,7 @@ private:
 
 
     // Asset loading
-    std::vector<char> readFile(const std::string& filename);
+    AssetData readFile(const std::string& filename);
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
             VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
             VkDebugUtilsMessageTypeFlagsEXT messageType,
@@ -0,0 +1,15 @@
+#include "Zstd.h"
+
+#include <zstd.h>
+
+#include <stdexcept>
+#include <string>
+
+size_t zstdDecompress(const void* src, size_t srcSize, void* dst, size_t dstCapacity) {
+    // Walks every frame, skipping skippable ones, and checks the content checksums
+    size_t written = ZSTD_decompress(dst, dstCapacity, src, srcSize);
+    if (ZSTD_isError(written)) {
+        throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(written));
+    }
+    return written;
+}
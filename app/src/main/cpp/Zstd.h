@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Zstandard frame decoder for the KTX2 zstd supercompression scheme and .vtex tiles, on
+// top of the reference decompressor (lib/zstd/zstddeclib.c). Decodes all frames in src
+// (skippable frames are ignored) into dst and returns the number of bytes written.
+// Throws std::runtime_error if the input is malformed, fails its checksum or does not fit.
+size_t zstdDecompress(const void* src, size_t srcSize, void* dst, size_t dstCapacity);
+
+// Compresses one buffer into a single frame. The app only links the decoder, so the
+// writers take the compressor as an argument (nullptr stores the data as is).
+using ZstdCompressor = std::vector<uint8_t> (*)(const void* src, size_t size);
+
+// libzstd at a high level with the frame checksum on. Host tools only: defined in
+// tools/ZstdCompress.cpp, which links the system libzstd (-lzstd).
+std::vector<uint8_t> zstdCompress(const void* src, size_t size);
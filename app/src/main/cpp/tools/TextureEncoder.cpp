@@ -0,0 +1,783 @@
+#include "TextureEncoder.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t kMaxBlockTexels = 36;
+
+// Texels of one block, row-major, as floats in 0..255
+struct Block {
+    uint32_t size = 0;
+    uint32_t count = 0;
+    float texels[kMaxBlockTexels][4];
+};
+
+void loadBlock(const RgbaImage& image, uint32_t blockX, uint32_t blockY, uint32_t size, Block& block) {
+    block.size = size;
+    block.count = size * size;
+    for (uint32_t y = 0; y < size; y++) {
+        uint32_t py = std::min(blockY * size + y, image.height - 1);
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t px = std::min(blockX * size + x, image.width - 1);
+            const uint8_t* texel = &image.pixels[(size_t(py) * image.width + px) * 4];
+            for (int c = 0; c < 4; c++) {
+                block.texels[y * size + x][c] = texel[c];
+            }
+        }
+    }
+}
+
+// Runs encode(block, out) for every block; block rows are spread over the pool
+template <typename Encode>
+std::vector<uint8_t> encodeBlocks(const RgbaImage& image, uint32_t blockSize, uint32_t blockBytes, ThreadPool& pool,
+                                  Encode encode) {
+    uint32_t blocksX = (image.width + blockSize - 1) / blockSize;
+    uint32_t blocksY = (image.height + blockSize - 1) / blockSize;
+    std::vector<uint8_t> out(size_t(blocksX) * blocksY * blockBytes);
+    pool.parallelFor(blocksY, [&](size_t row) {
+        Block block;
+        for (uint32_t x = 0; x < blocksX; x++) {
+            loadBlock(image, x, uint32_t(row), blockSize, block);
+            encode(block, &out[(row * blocksX + x) * blockBytes]);
+        }
+    });
+    return out;
+}
+
+// LSB-first into a zeroed block
+void putBits(uint8_t* block, uint32_t bit, uint32_t count, uint32_t value) {
+    for (uint32_t i = 0; i < count; i++, bit++) {
+        if ((value >> i) & 1) {
+            block[bit >> 3] |= uint8_t(1u << (bit & 7));
+        }
+    }
+}
+
+float clampUnit(float value) {
+    return std::min(std::max(value, 0.0f), 255.0f);
+}
+
+int roundByte(float value) {
+    return int(std::lround(clampUnit(value)));
+}
+
+float squaredDistance(const float* a, const int* b, int channels) {
+    float sum = 0.0f;
+    for (int c = 0; c < channels; c++) {
+        float d = a[c] - float(b[c]);
+        sum += d * d;
+    }
+    return sum;
+}
+
+// Endpoints spanning the texels along their principal axis
+void fitLine(const Block& block, int channels, float e0[4], float e1[4]) {
+    float mean[4] = {};
+    for (uint32_t i = 0; i < block.count; i++) {
+        for (int c = 0; c < channels; c++) {
+            mean[c] += block.texels[i][c];
+        }
+    }
+    for (int c = 0; c < channels; c++) {
+        mean[c] /= float(block.count);
+    }
+
+    float covariance[4][4] = {};
+    for (uint32_t i = 0; i < block.count; i++) {
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                covariance[a][b] += (block.texels[i][a] - mean[a]) * (block.texels[i][b] - mean[b]);
+            }
+        }
+    }
+
+    // Power iteration from the channel with the largest spread
+    float axis[4] = {};
+    int widest = 0;
+    for (int c = 1; c < channels; c++) {
+        if (covariance[c][c] > covariance[widest][widest]) {
+            widest = c;
+        }
+    }
+    axis[widest] = 1.0f;
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        float length = 0.0f;
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        if (length < 1e-12f) {
+            break;
+        }
+        length = std::sqrt(length);
+        for (int c = 0; c < channels; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float low = 0.0f;
+    float high = 0.0f;
+    for (uint32_t i = 0; i < block.count; i++) {
+        float projection = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            projection += (block.texels[i][c] - mean[c]) * axis[c];
+        }
+        low = std::min(low, projection);
+        high = std::max(high, projection);
+    }
+    for (int c = 0; c < 4; c++) {
+        e0[c] = c < channels ? clampUnit(mean[c] + low * axis[c]) : 255.0f;
+        e1[c] = c < channels ? clampUnit(mean[c] + high * axis[c]) : 255.0f;
+    }
+}
+
+// Least-squares endpoints for fixed interpolation factors (0 = e0, 1 = e1) per texel
+void solveEndpoints(const Block& block, const float* factors, int channels, float e0[4], float e1[4]) {
+    double aa = 0.0, ab = 0.0, bb = 0.0;
+    double ax[4] = {}, bx[4] = {};
+    for (uint32_t i = 0; i < block.count; i++) {
+        double b = factors[i];
+        double a = 1.0 - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < channels; c++) {
+            ax[c] += a * block.texels[i][c];
+            bx[c] += b * block.texels[i][c];
+        }
+    }
+    double determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6) {
+        return;  // all texels on one factor: keep the current endpoints
+    }
+    for (int c = 0; c < channels; c++) {
+        e0[c] = clampUnit(float((ax[c] * bb - bx[c] * ab) / determinant));
+        e1[c] = clampUnit(float((bx[c] * aa - ax[c] * ab) / determinant));
+    }
+}
+
+int interpolate64(int e0, int e1, int weight) {
+    return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+// BC7 mode 6: one subset, 7-bit RGBA endpoints with a p-bit each, 4-bit indices
+
+constexpr int kBc7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+float bc7Indices(const Block& block, const int q0[4], const int q1[4], uint8_t indices[16]) {
+    int palette[16][4];
+    for (int k = 0; k < 16; k++) {
+        for (int c = 0; c < 4; c++) {
+            palette[k][c] = interpolate64(q0[c], q1[c], kBc7Weights[k]);
+        }
+    }
+    float total = 0.0f;
+    for (uint32_t i = 0; i < 16; i++) {
+        float best = std::numeric_limits<float>::max();
+        for (int k = 0; k < 16; k++) {
+            float error = squaredDistance(block.texels[i], palette[k], 4);
+            if (error < best) {
+                best = error;
+                indices[i] = uint8_t(k);
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+void encodeBc7Block(const Block& block, uint8_t* out) {
+    float e0[4], e1[4];
+    fitLine(block, 4, e0, e1);
+
+    float bestError = std::numeric_limits<float>::max();
+    int best0[4], best1[4];
+    int bestP0 = 0, bestP1 = 0;
+    uint8_t bestIndices[16];
+    for (int iteration = 0; iteration < 2; iteration++) {
+        for (int pbits = 0; pbits < 4; pbits++) {
+            int p0 = pbits & 1;
+            int p1 = pbits >> 1;
+            int q0[4], q1[4];
+            for (int c = 0; c < 4; c++) {
+                q0[c] = std::min(std::max(int(std::lround((e0[c] - p0) * 0.5f)), 0), 127) << 1 | p0;
+                q1[c] = std::min(std::max(int(std::lround((e1[c] - p1) * 0.5f)), 0), 127) << 1 | p1;
+            }
+            uint8_t indices[16];
+            float error = bc7Indices(block, q0, q1, indices);
+            if (error < bestError) {
+                bestError = error;
+                std::copy_n(q0, 4, best0);
+                std::copy_n(q1, 4, best1);
+                bestP0 = p0;
+                bestP1 = p1;
+                std::copy_n(indices, 16, bestIndices);
+            }
+        }
+        float factors[16];
+        for (int i = 0; i < 16; i++) {
+            factors[i] = kBc7Weights[bestIndices[i]] / 64.0f;
+        }
+        solveEndpoints(block, factors, 4, e0, e1);
+    }
+
+    // The anchor (first) index drops its top bit, so it has to be below 8
+    if (bestIndices[0] >= 8) {
+        std::swap(best0, best1);
+        std::swap(bestP0, bestP1);
+        for (uint8_t& index : bestIndices) {
+            index = uint8_t(15 - index);
+        }
+    }
+
+    putBits(out, 0, 7, 1u << 6);
+    uint32_t bit = 7;
+    for (int c = 0; c < 4; c++) {
+        putBits(out, bit, 7, uint32_t(best0[c] >> 1));
+        putBits(out, bit + 7, 7, uint32_t(best1[c] >> 1));
+        bit += 14;
+    }
+    putBits(out, bit++, 1, uint32_t(bestP0));
+    putBits(out, bit++, 1, uint32_t(bestP1));
+    putBits(out, bit, 3, bestIndices[0]);
+    bit += 3;
+    for (int i = 1; i < 16; i++, bit += 4) {
+        putBits(out, bit, 4, bestIndices[i]);
+    }
+}
+
+// ETC2 RGB, restricted to the ETC1 individual and differential modes
+
+constexpr int kEtcModifiers[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+// Pixel index (msb << 1 | lsb): 0 = +small, 1 = +large, 2 = -small, 3 = -large
+int etcModifier(int table, int index) {
+    int modifier = kEtcModifiers[table][index & 1];
+    return index & 2 ? -modifier : modifier;
+}
+
+int etcExpand(int value, int bits) {
+    return bits == 4 ? value << 4 | value : value << 3 | value >> 2;
+}
+
+bool inEtcSubblock(uint32_t texel, bool flip, int subblock) {
+    uint32_t coordinate = flip ? texel / 4 : texel % 4;
+    return (coordinate >= 2) == (subblock == 1);
+}
+
+float etcTexelError(const float* texel, const int color[3], int table, int& index) {
+    float best = std::numeric_limits<float>::max();
+    for (int k = 0; k < 4; k++) {
+        int modifier = etcModifier(table, k);
+        int value[3];
+        for (int c = 0; c < 3; c++) {
+            value[c] = std::min(std::max(color[c] + modifier, 0), 255);
+        }
+        float error = squaredDistance(texel, value, 3);
+        if (error < best) {
+            best = error;
+            index = k;
+        }
+    }
+    return best;
+}
+
+struct EtcSubblock {
+    int base[3];  // quantized to 4 or 5 bits
+    int table = 0;
+    float error = 0.0f;
+};
+
+// Tries the quantized subblock average rounded both ways per channel with every table
+EtcSubblock fitEtcSubblock(const Block& block, bool flip, int subblock, int bits) {
+    float average[3] = {};
+    for (uint32_t i = 0; i < 16; i++) {
+        if (inEtcSubblock(i, flip, subblock)) {
+            for (int c = 0; c < 3; c++) {
+                average[c] += block.texels[i][c] / 8.0f;
+            }
+        }
+    }
+    int maxValue = (1 << bits) - 1;
+    int low[3];
+    for (int c = 0; c < 3; c++) {
+        low[c] = std::min(int(average[c] * maxValue / 255.0f), maxValue);
+    }
+
+    EtcSubblock best;
+    best.error = std::numeric_limits<float>::max();
+    for (int candidate = 0; candidate < 8; candidate++) {
+        int base[3];
+        int color[3];
+        for (int c = 0; c < 3; c++) {
+            base[c] = std::min(low[c] + ((candidate >> c) & 1), maxValue);
+            color[c] = etcExpand(base[c], bits);
+        }
+        for (int table = 0; table < 8; table++) {
+            float error = 0.0f;
+            int index;
+            for (uint32_t i = 0; i < 16 && error < best.error; i++) {
+                if (inEtcSubblock(i, flip, subblock)) {
+                    error += etcTexelError(block.texels[i], color, table, index);
+                }
+            }
+            if (error < best.error) {
+                std::copy_n(base, 3, best.base);
+                best.table = table;
+                best.error = error;
+            }
+        }
+    }
+    return best;
+}
+
+uint64_t packEtcBlock(const Block& block, bool differential, bool flip, const EtcSubblock& first,
+                      const EtcSubblock& second) {
+    uint64_t bits = 0;
+    if (differential) {
+        for (int c = 0; c < 3; c++) {
+            int shift = 59 - c * 8;
+            bits |= uint64_t(first.base[c]) << shift;
+            bits |= uint64_t((second.base[c] - first.base[c]) & 7) << (shift - 3);
+        }
+    } else {
+        for (int c = 0; c < 3; c++) {
+            int shift = 60 - c * 8;
+            bits |= uint64_t(first.base[c]) << shift;
+            bits |= uint64_t(second.base[c]) << (shift - 4);
+        }
+    }
+    bits |= uint64_t(first.table) << 37 | uint64_t(second.table) << 34;
+    bits |= uint64_t(differential) << 33 | uint64_t(flip) << 32;
+
+    int colorBits = differential ? 5 : 4;
+    int colors[2][3];
+    for (int c = 0; c < 3; c++) {
+        colors[0][c] = etcExpand(first.base[c], colorBits);
+        colors[1][c] = etcExpand(second.base[c], colorBits);
+    }
+    for (uint32_t i = 0; i < 16; i++) {
+        int subblock = inEtcSubblock(i, flip, 1) ? 1 : 0;
+        int index = 0;
+        etcTexelError(block.texels[i], colors[subblock], subblock ? second.table : first.table, index);
+        uint32_t pixel = (i % 4) * 4 + i / 4;  // indices are stored column by column
+        bits |= uint64_t(index >> 1) << (16 + pixel) | uint64_t(index & 1) << pixel;
+    }
+    return bits;
+}
+
+void storeBigEndian(uint64_t bits, uint8_t* out) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = uint8_t(bits >> (56 - i * 8));
+    }
+}
+
+void encodeEtcColorBlock(const Block& block, uint8_t* out) {
+    float bestError = std::numeric_limits<float>::max();
+    uint64_t bestBits = 0;
+    for (bool flip : {false, true}) {
+        EtcSubblock first = fitEtcSubblock(block, flip, 0, 4);
+        EtcSubblock second = fitEtcSubblock(block, flip, 1, 4);
+        if (first.error + second.error < bestError) {
+            bestError = first.error + second.error;
+            bestBits = packEtcBlock(block, false, flip, first, second);
+        }
+
+        // Differential only while the second color stays in range; overflowing
+        // selects the ETC2 T, H and planar modes instead
+        first = fitEtcSubblock(block, flip, 0, 5);
+        second = fitEtcSubblock(block, flip, 1, 5);
+        bool representable = true;
+        for (int c = 0; c < 3; c++) {
+            int delta = second.base[c] - first.base[c];
+            representable = representable && delta >= -4 && delta <= 3;
+        }
+        if (representable && first.error + second.error < bestError) {
+            bestError = first.error + second.error;
+            bestBits = packEtcBlock(block, true, flip, first, second);
+        }
+    }
+    storeBigEndian(bestBits, out);
+}
+
+constexpr int kEacModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10}, {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},  {-2, -4, -8, -10, 1, 3, 7, 9},  {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},  {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+float eacIndices(const Block& block, int base, int multiplier, int table, uint8_t indices[16], float limit) {
+    float total = 0.0f;
+    for (uint32_t i = 0; i < 16 && total < limit; i++) {
+        float best = std::numeric_limits<float>::max();
+        for (int k = 0; k < 8; k++) {
+            int value = std::min(std::max(base + kEacModifiers[table][k] * multiplier, 0), 255);
+            float d = block.texels[i][3] - float(value);
+            if (d * d < best) {
+                best = d * d;
+                indices[i] = uint8_t(k);
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+void encodeEacAlphaBlock(const Block& block, uint8_t* out) {
+    float low = 255.0f;
+    float high = 0.0f;
+    for (uint32_t i = 0; i < 16; i++) {
+        low = std::min(low, block.texels[i][3]);
+        high = std::max(high, block.texels[i][3]);
+    }
+
+    // Table 13 has a zero modifier, which covers constant alpha exactly
+    int bestBase = int(low), bestMultiplier = 1, bestTable = 13;
+    uint8_t bestIndices[16];
+    float bestError = eacIndices(block, bestBase, bestMultiplier, bestTable, bestIndices,
+                                 std::numeric_limits<float>::max());
+    for (int table = 0; table < 16 && bestError > 0.0f; table++) {
+        int lowModifier = kEacModifiers[table][3];
+        int highModifier = kEacModifiers[table][7];
+        int multiplier = int(std::lround((high - low) / float(highModifier - lowModifier)));
+        for (int m = std::max(multiplier - 1, 1); m <= std::min(multiplier + 1, 15); m++) {
+            int center = int(std::lround((low + high) * 0.5f - m * (lowModifier + highModifier) * 0.5f));
+            for (int base = std::max(center - 1, 0); base <= std::min(center + 1, 255); base++) {
+                uint8_t indices[16];
+                float error = eacIndices(block, base, m, table, indices, bestError);
+                if (error < bestError) {
+                    bestError = error;
+                    bestBase = base;
+                    bestMultiplier = m;
+                    bestTable = table;
+                    std::copy_n(indices, 16, bestIndices);
+                }
+            }
+        }
+    }
+
+    uint64_t bits = uint64_t(bestBase) << 56 | uint64_t(bestMultiplier) << 52 | uint64_t(bestTable) << 48;
+    for (uint32_t i = 0; i < 16; i++) {
+        uint32_t pixel = (i % 4) * 4 + i / 4;
+        bits |= uint64_t(bestIndices[i]) << (45 - 3 * pixel);
+    }
+    storeBigEndian(bits, out);
+}
+
+// ASTC: one partition, direct LDR endpoints (CEM 8 for RGB, CEM 12 for RGBA) at full 8-bit
+// precision, weights on a 4x4 grid that is interpolated up for 6x6 blocks
+
+constexpr uint32_t kAstcGridSize = 4;
+
+struct AstcMode {
+    uint32_t blockMode;
+    uint32_t endpointMode;
+    int channels;
+    int weightBits;
+    int levelCount;
+    int levels[8];  // unquantized weights, 0..64
+};
+
+// 4x4 grid, QUANT_8 weights; leaves 63 bits for the six 8-bit endpoint values
+constexpr AstcMode kAstcRgb = {83, 8, 3, 3, 8, {0, 9, 18, 27, 37, 46, 55, 64}};
+// 4x4 grid, QUANT_4 weights; leaves 79 bits for the eight 8-bit endpoint values
+constexpr AstcMode kAstcRgba = {66, 12, 4, 2, 4, {0, 21, 43, 64}};
+
+// Grid points and bilinear factors (summing to 16) behind one texel, per the spec's infill
+struct AstcInfill {
+    uint8_t points[4];
+    uint8_t factors[4];
+};
+
+void computeInfill(uint32_t blockSize, AstcInfill* infill) {
+    uint32_t scale = (1024 + blockSize / 2) / (blockSize - 1);
+    for (uint32_t t = 0; t < blockSize; t++) {
+        for (uint32_t s = 0; s < blockSize; s++) {
+            uint32_t gs = (scale * s * (kAstcGridSize - 1) + 32) >> 6;
+            uint32_t gt = (scale * t * (kAstcGridSize - 1) + 32) >> 6;
+            uint32_t js = gs >> 4, fs = gs & 15;
+            uint32_t jt = gt >> 4, ft = gt & 15;
+            uint32_t w11 = (fs * ft + 8) >> 4;
+            // The far neighbours of the last row / column carry no weight; clamp them
+            uint32_t js1 = std::min(js + 1, kAstcGridSize - 1);
+            uint32_t jt1 = std::min(jt + 1, kAstcGridSize - 1);
+            AstcInfill& texel = infill[t * blockSize + s];
+            texel.points[0] = uint8_t(jt * kAstcGridSize + js);
+            texel.points[1] = uint8_t(jt * kAstcGridSize + js1);
+            texel.points[2] = uint8_t(jt1 * kAstcGridSize + js);
+            texel.points[3] = uint8_t(jt1 * kAstcGridSize + js1);
+            texel.factors[0] = uint8_t(16 - fs - ft + w11);
+            texel.factors[1] = uint8_t(fs - w11);
+            texel.factors[2] = uint8_t(ft - w11);
+            texel.factors[3] = uint8_t(w11);
+        }
+    }
+}
+
+int texelWeight(const AstcMode& mode, const AstcInfill& infill, const uint8_t grid[16]) {
+    int sum = 8;
+    for (int k = 0; k < 4; k++) {
+        sum += mode.levels[grid[infill.points[k]]] * infill.factors[k];
+    }
+    return sum >> 4;
+}
+
+float astcTexelError(const Block& block, const AstcMode& mode, const int q0[4], const int q1[4], uint32_t i,
+                     int weight) {
+    int color[4];
+    for (int c = 0; c < mode.channels; c++) {
+        color[c] = interpolate64(q0[c], q1[c], weight);
+    }
+    return squaredDistance(block.texels[i], color, mode.channels);
+}
+
+// Quantized grid weights for fixed endpoints
+float fitAstcWeights(const Block& block, const AstcMode& mode, const AstcInfill* infill, const int q0[4],
+                     const int q1[4], uint8_t grid[16]) {
+    if (block.size == kAstcGridSize) {
+        // One grid point per texel: pick each one directly
+        float total = 0.0f;
+        for (uint32_t i = 0; i < block.count; i++) {
+            float best = std::numeric_limits<float>::max();
+            for (int level = 0; level < mode.levelCount; level++) {
+                float error = astcTexelError(block, mode, q0, q1, i, mode.levels[level]);
+                if (error < best) {
+                    best = error;
+                    grid[i] = uint8_t(level);
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    // Start from the texels' projections onto the endpoint line, averaged per grid point...
+    float lineLength = 0.0f;
+    for (int c = 0; c < mode.channels; c++) {
+        lineLength += float((q1[c] - q0[c]) * (q1[c] - q0[c]));
+    }
+    float sums[16] = {};
+    float totals[16] = {};
+    for (uint32_t i = 0; i < block.count; i++) {
+        float projection = 0.0f;
+        for (int c = 0; c < mode.channels; c++) {
+            projection += (block.texels[i][c] - float(q0[c])) * float(q1[c] - q0[c]);
+        }
+        float ideal = lineLength > 0.0f ? std::min(std::max(projection / lineLength, 0.0f), 1.0f) : 0.0f;
+        for (int k = 0; k < 4; k++) {
+            sums[infill[i].points[k]] += ideal * infill[i].factors[k];
+            totals[infill[i].points[k]] += infill[i].factors[k];
+        }
+    }
+    for (uint32_t g = 0; g < 16; g++) {
+        float ideal = totals[g] > 0.0f ? sums[g] / totals[g] * 64.0f : 0.0f;
+        int nearest = 0;
+        for (int level = 1; level < mode.levelCount; level++) {
+            if (std::abs(mode.levels[level] - ideal) < std::abs(mode.levels[nearest] - ideal)) {
+                nearest = level;
+            }
+        }
+        grid[g] = uint8_t(nearest);
+    }
+
+    // ...then improve one grid point at a time against the interpolated result, looking
+    // only at the texels that point contributes to
+    float texelErrors[kMaxBlockTexels];
+    for (uint32_t i = 0; i < block.count; i++) {
+        texelErrors[i] = astcTexelError(block, mode, q0, q1, i, texelWeight(mode, infill[i], grid));
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t g = 0; g < 16; g++) {
+            uint32_t touched[kMaxBlockTexels];
+            uint32_t touchedCount = 0;
+            for (uint32_t i = 0; i < block.count; i++) {
+                for (int k = 0; k < 4; k++) {
+                    if (infill[i].points[k] == g && infill[i].factors[k] > 0) {
+                        touched[touchedCount++] = i;
+                        break;
+                    }
+                }
+            }
+
+            uint8_t bestLevel = grid[g];
+            float bestDelta = 0.0f;
+            for (int level = 0; level < mode.levelCount; level++) {
+                grid[g] = uint8_t(level);
+                float delta = 0.0f;
+                for (uint32_t t = 0; t < touchedCount; t++) {
+                    uint32_t i = touched[t];
+                    delta += astcTexelError(block, mode, q0, q1, i, texelWeight(mode, infill[i], grid)) - texelErrors[i];
+                }
+                if (delta < bestDelta) {
+                    bestDelta = delta;
+                    bestLevel = uint8_t(level);
+                }
+            }
+            grid[g] = bestLevel;
+            for (uint32_t t = 0; t < touchedCount; t++) {
+                uint32_t i = touched[t];
+                texelErrors[i] = astcTexelError(block, mode, q0, q1, i, texelWeight(mode, infill[i], grid));
+            }
+        }
+    }
+    float total = 0.0f;
+    for (uint32_t i = 0; i < block.count; i++) {
+        total += texelErrors[i];
+    }
+    return total;
+}
+
+void encodeAstcBlock(const Block& block, const AstcMode& mode, const AstcInfill* infill, uint8_t* out) {
+    float e0[4], e1[4];
+    fitLine(block, mode.channels, e0, e1);
+
+    float bestError = std::numeric_limits<float>::max();
+    int best0[4], best1[4];
+    uint8_t bestGrid[16];
+    for (int iteration = 0; iteration < 3; iteration++) {
+        int q0[4], q1[4];
+        int sum0 = 0, sum1 = 0;
+        for (int c = 0; c < mode.channels; c++) {
+            q0[c] = roundByte(e0[c]);
+            q1[c] = roundByte(e1[c]);
+            if (c < 3) {
+                sum0 += q0[c];
+                sum1 += q1[c];
+            }
+        }
+        // A darker second endpoint would select blue contraction
+        if (sum1 < sum0) {
+            std::swap(q0, q1);
+        }
+
+        uint8_t grid[16];
+        float error = fitAstcWeights(block, mode, infill, q0, q1, grid);
+        if (error < bestError) {
+            bestError = error;
+            std::copy_n(q0, 4, best0);
+            std::copy_n(q1, 4, best1);
+            std::copy_n(grid, 16, bestGrid);
+        }
+        if (bestError == 0.0f) {
+            break;
+        }
+
+        float factors[kMaxBlockTexels];
+        for (uint32_t i = 0; i < block.count; i++) {
+            factors[i] = texelWeight(mode, infill[i], bestGrid) / 64.0f;
+        }
+        for (int c = 0; c < mode.channels; c++) {
+            e0[c] = float(best0[c]);
+            e1[c] = float(best1[c]);
+        }
+        solveEndpoints(block, factors, mode.channels, e0, e1);
+    }
+
+    // Block mode, one partition (bits 11-12 stay zero), endpoint mode, then the endpoint
+    // values in r0 r1 g0 g1 b0 b1 [a0 a1] order
+    putBits(out, 0, 11, mode.blockMode);
+    putBits(out, 13, 4, mode.endpointMode);
+    uint32_t bit = 17;
+    for (int c = 0; c < mode.channels; c++, bit += 16) {
+        putBits(out, bit, 8, uint32_t(best0[c]));
+        putBits(out, bit + 8, 8, uint32_t(best1[c]));
+    }
+    // Weights fill the block from the top, bit reversed
+    for (uint32_t g = 0; g < 16; g++) {
+        for (int b = 0; b < mode.weightBits; b++) {
+            if ((bestGrid[g] >> b) & 1) {
+                putBits(out, 127 - (g * mode.weightBits + b), 1, 1);
+            }
+        }
+    }
+}
+
+float srgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float value) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+} // namespace
+
+bool hasTranslucentTexels(const RgbaImage& image) {
+    for (size_t i = 3; i < image.pixels.size(); i += 4) {
+        if (image.pixels[i] != 255) {
+            return true;
+        }
+    }
+    return false;
+}
+
+RgbaImage downsample(const RgbaImage& image, bool srgb) {
+    float toLinear[256];
+    for (int i = 0; i < 256; i++) {
+        toLinear[i] = srgb ? srgbToLinear(i / 255.0f) : i / 255.0f;
+    }
+
+    RgbaImage result;
+    result.width = std::max(image.width / 2, 1u);
+    result.height = std::max(image.height / 2, 1u);
+    result.pixels.resize(size_t(result.width) * result.height * 4);
+    for (uint32_t y = 0; y < result.height; y++) {
+        for (uint32_t x = 0; x < result.width; x++) {
+            float sum[4] = {};
+            for (uint32_t dy = 0; dy < 2; dy++) {
+                for (uint32_t dx = 0; dx < 2; dx++) {
+                    uint32_t sx = std::min(x * 2 + dx, image.width - 1);
+                    uint32_t sy = std::min(y * 2 + dy, image.height - 1);
+                    const uint8_t* texel = &image.pixels[(size_t(sy) * image.width + sx) * 4];
+                    for (int c = 0; c < 3; c++) {
+                        sum[c] += toLinear[texel[c]];
+                    }
+                    sum[3] += texel[3] / 255.0f;
+                }
+            }
+            uint8_t* out = &result.pixels[(size_t(y) * result.width + x) * 4];
+            for (int c = 0; c < 4; c++) {
+                float value = sum[c] * 0.25f;
+                if (c < 3 && srgb) {
+                    value = linearToSrgb(value);
+                }
+                out[c] = uint8_t(roundByte(value * 255.0f));
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<uint8_t> encodeBc7(const RgbaImage& image, ThreadPool& pool) {
+    return encodeBlocks(image, 4, 16, pool, encodeBc7Block);
+}
+
+std::vector<uint8_t> encodeEtc2(const RgbaImage& image, bool alpha, ThreadPool& pool) {
+    if (!alpha) {
+        return encodeBlocks(image, 4, 8, pool, encodeEtcColorBlock);
+    }
+    return encodeBlocks(image, 4, 16, pool, [](const Block& block, uint8_t* out) {
+        encodeEacAlphaBlock(block, out);
+        encodeEtcColorBlock(block, out + 8);
+    });
+}
+
+std::vector<uint8_t> encodeAstc(const RgbaImage& image, uint32_t blockSize, bool alpha, ThreadPool& pool) {
+    AstcInfill infill[kMaxBlockTexels];
+    computeInfill(blockSize, infill);
+    const AstcMode& mode = alpha ? kAstcRgba : kAstcRgb;
+    return encodeBlocks(image, blockSize, 16, pool, [&](const Block& block, uint8_t* out) {
+        encodeAstcBlock(block, mode, infill, out);
+    });
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Mip generation and block compression for tools/ktx2conv. Not part of the Android build.
+
+struct RgbaImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;  // RGBA8, top row first
+};
+
+bool hasTranslucentTexels(const RgbaImage& image);
+
+// Next mip level: 2x2 box with the last row / column clamped on odd sizes, colors
+// averaged in linear space when srgb is set. Matches what the renderer generates for PNGs.
+RgbaImage downsample(const RgbaImage& image, bool srgb);
+
+// Block encoders for one mip level. Blocks reaching past the right or bottom edge repeat
+// the edge texels. Values are fitted in the encoded space, so the same bytes serve the
+// UNORM and SRGB variant of each format.
+std::vector<uint8_t> encodeBc7(const RgbaImage& image, ThreadPool& pool);
+// ETC1-compatible individual / differential blocks, prefixed by EAC alpha when alpha is set
+std::vector<uint8_t> encodeEtc2(const RgbaImage& image, bool alpha, ThreadPool& pool);
+// One partition on a 4x4 weight grid; blockSize is 4 or 6
+std::vector<uint8_t> encodeAstc(const RgbaImage& image, uint32_t blockSize, bool alpha, ThreadPool& pool);
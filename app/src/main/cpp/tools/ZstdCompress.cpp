@@ -0,0 +1,33 @@
+// zstdCompress for the host tools, on the system libzstd. Not part of the Android build,
+// which only carries the decoder (lib/zstd/zstddeclib.c).
+
+#include "Zstd.h"
+
+#include <zstd.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Offline, so ratio over speed: the tools compress once and the app decodes every launch
+constexpr int kCompressionLevel = 19;
+
+} // namespace
+
+std::vector<uint8_t> zstdCompress(const void* src, size_t size) {
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    if (!context) {
+        throw std::runtime_error("zstd: out of memory");
+    }
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, kCompressionLevel);
+    ZSTD_CCtx_setParameter(context, ZSTD_c_checksumFlag, 1);
+    std::vector<uint8_t> out(ZSTD_compressBound(size));
+    size_t written = ZSTD_compress2(context, out.data(), out.size(), src, size);
+    ZSTD_freeCCtx(context);
+    if (ZSTD_isError(written)) {
+        throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(written));
+    }
+    out.resize(written);
+    return out;
+}
@@ -0,0 +1,174 @@
+// Offline converter: PNG -> block-compressed .ktx2 files with full mip chains, named the
+// way VulkanRenderer looks for them next to the PNG. Not part of the Android build.
+//
+// Build from app/src/main/cpp:
+//   g++ -O2 -std=c++17 -pthread -I. -Ilib/stb-master tools/ktx2conv.cpp tools/TextureEncoder.cpp tools/ZstdCompress.cpp AssetCache.cpp AssetSource.cpp Ktx2File.cpp ThreadPool.cpp Zstd.cpp -lzstd -o ktx2conv
+// Usage:
+//   ./ktx2conv [--formats astc4x4,astc6x6,bc7,etc2] [--zstd] ../assets/lambert5SG_baseColor.png ...
+// writes ../assets/lambert5SG_baseColor.astc4x4.ktx2 etc. All formats by default.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "AssetSource.h"
+#include "Ktx2File.h"
+#include "ThreadPool.h"
+#include "Zstd.h"
+#include "tools/TextureEncoder.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct OutputFormat {
+    const char* name;  // file name suffix, see VulkanRenderer::decodeTexture
+    uint32_t opaqueFormat;
+    uint32_t alphaFormat;
+};
+
+constexpr OutputFormat kOutputFormats[] = {
+    {"astc4x4", kKtx2FormatAstc4x4Srgb, kKtx2FormatAstc4x4Srgb},
+    {"astc6x6", kKtx2FormatAstc6x6Srgb, kKtx2FormatAstc6x6Srgb},
+    {"bc7", kKtx2FormatBc7Srgb, kKtx2FormatBc7Srgb},
+    {"etc2", kKtx2FormatEtc2Rgb8Srgb, kKtx2FormatEtc2Rgba8Srgb},
+};
+
+const OutputFormat& findOutputFormat(const std::string& name) {
+    for (const OutputFormat& format : kOutputFormats) {
+        if (name == format.name) {
+            return format;
+        }
+    }
+    throw std::runtime_error("unknown format " + name);
+}
+
+std::string replaceExtension(const std::string& path, const std::string& extension) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + extension;
+    }
+    return path.substr(0, dot) + extension;
+}
+
+RgbaImage loadImage(const std::string& path) {
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        throw std::runtime_error("failed to load " + path + ": " + stbi_failure_reason());
+    }
+    RgbaImage image;
+    image.width = uint32_t(width);
+    image.height = uint32_t(height);
+    image.pixels.assign(pixels, pixels + size_t(width) * height * 4);
+    stbi_image_free(pixels);
+    return image;
+}
+
+std::vector<uint8_t> encodeLevel(const RgbaImage& image, uint32_t vkFormat, bool alpha, ThreadPool& pool) {
+    switch (vkFormat) {
+        case kKtx2FormatAstc4x4Srgb:
+            return encodeAstc(image, 4, alpha, pool);
+        case kKtx2FormatAstc6x6Srgb:
+            return encodeAstc(image, 6, alpha, pool);
+        case kKtx2FormatBc7Srgb:
+            return encodeBc7(image, pool);
+        case kKtx2FormatEtc2Rgb8Srgb:
+        case kKtx2FormatEtc2Rgba8Srgb:
+            return encodeEtc2(image, alpha, pool);
+        default:
+            throw std::runtime_error("no encoder for format " + std::to_string(vkFormat));
+    }
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    if (!file) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<const OutputFormat*> formats;
+    ZstdCompressor compress = nullptr;
+    std::vector<std::string> inputs;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string argument = argv[i];
+            if (argument == "--formats" && i + 1 < argc) {
+                std::stringstream list(argv[++i]);
+                std::string name;
+                while (std::getline(list, name, ',')) {
+                    formats.push_back(&findOutputFormat(name));
+                }
+            } else if (argument == "--zstd") {
+                compress = zstdCompress;
+            } else {
+                inputs.push_back(argument);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (inputs.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--formats astc4x4,astc6x6,bc7,etc2] [--zstd] input.png..."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (formats.empty()) {
+        for (const OutputFormat& format : kOutputFormats) {
+            formats.push_back(&format);
+        }
+    }
+
+    try {
+        ThreadPool pool;
+        for (const std::string& inputPath : inputs) {
+            // Same chain the renderer builds from the PNG, so switching formats keeps the look
+            std::vector<RgbaImage> mips{loadImage(inputPath)};
+            while (mips.back().width > 1 || mips.back().height > 1) {
+                mips.push_back(downsample(mips.back(), true));
+            }
+            bool alpha = hasTranslucentTexels(mips.front());
+            size_t rgbaBytes = mips.front().pixels.size();
+            std::cout << inputPath << ": " << mips.front().width << "x" << mips.front().height << ", "
+                      << mips.size() << " levels" << (alpha ? ", with alpha" : "") << std::endl;
+
+            for (const OutputFormat* format : formats) {
+                auto start = std::chrono::high_resolution_clock::now();
+                uint32_t vkFormat = alpha ? format->alphaFormat : format->opaqueFormat;
+                std::vector<std::vector<uint8_t>> levels;
+                size_t levelBytes = 0;
+                for (const RgbaImage& mip : mips) {
+                    levels.push_back(encodeLevel(mip, vkFormat, alpha, pool));
+                    levelBytes += levels.back().size();
+                }
+                std::vector<uint8_t> file = serializeKtx2(vkFormat, mips.front().width, mips.front().height, levels,
+                                                          compress);
+                std::string outputPath = replaceExtension(inputPath, std::string(".") + format->name + ".ktx2");
+                writeFile(outputPath, file);
+
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+                std::cout << "  -> " << outputPath << ": " << levelBytes << " bytes of levels ("
+                          << double(rgbaBytes * 4 / 3) / double(levelBytes) << "x smaller than RGBA8 with mips), "
+                          << file.size() << " bytes on disk (" << ms << " ms)" << std::endl;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
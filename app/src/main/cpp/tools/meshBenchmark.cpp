@@ -0,0 +1,626 @@
+// Host-side microbenchmark for the mesh loading path. Not part of the Android build.
+//
+// Build and run from app/src/main/cpp:
+//   g++ -O2 -std=c++17 -pthread -I. -Ilib/tiny_obj_loader -Ilib/glm-1.0.3 tools/meshBenchmark.cpp AssetCache.cpp AssetSource.cpp ObjParser.cpp ThreadPool.cpp MeshBuilder.cpp MeshFile.cpp MeshletBuilder.cpp MeshOptimizer.cpp MeshSimplifier.cpp VertexQuantizer.cpp VertexWelder.cpp -o meshBenchmark
+//   ./meshBenchmark ../assets/viking_room.obj [iterations] [maxThreads] [cacheDirectory]
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include "AssetCache.h"
+#include "Camera.h"
+#include "MeshBuilder.h"
+#include "MeshFile.h"
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+#include "ThreadPool.h"
+#include "VertexQuantizer.h"
+#include "VertexWelder.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::vector<char> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open " + path);
+    }
+    std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), buffer.size());
+    return buffer;
+}
+
+struct LegacyFace {
+    int v[3];
+    int vt[3];
+    int matId;
+};
+
+// Mirrors the previous VulkanRenderer::loadModel: mtllib scan, tinyobj through an
+// istringstream copy, then a third istringstream pass re-parsing usemtl/f with std::stoi.
+size_t loadLegacy(const std::vector<char>& assetData, tinyobj::attrib_t& attrib, std::vector<LegacyFace>& faces) {
+    std::string line;
+    std::string mtlFilename;
+    std::istringstream objStream(std::string(assetData.begin(), assetData.end()));
+
+    std::istringstream objStream2(std::string(assetData.begin(), assetData.end()));
+    while (std::getline(objStream2, line)) {
+        std::istringstream lineStream(line);
+        std::string token;
+        lineStream >> token;
+        if (token == "mtllib") {
+            lineStream >> mtlFilename;
+            break;
+        }
+    }
+
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string err;
+    attrib = tinyobj::attrib_t();
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, &objStream, nullptr)) {
+        throw std::runtime_error(err);
+    }
+
+    faces.clear();
+    std::unordered_map<std::string, int> materialToIndex;
+    int currentMatId = 0;
+    std::istringstream objStream3(std::string(assetData.begin(), assetData.end()));
+    while (std::getline(objStream3, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream lineStream(line);
+        std::string token;
+        lineStream >> token;
+
+        if (token == "usemtl") {
+            std::string name;
+            lineStream >> name;
+            auto it = materialToIndex.emplace(name, static_cast<int>(materialToIndex.size())).first;
+            currentMatId = it->second;
+        } else if (token == "f") {
+            LegacyFace face{};
+            face.matId = currentMatId;
+            std::string part;
+            int component = 0;
+            while (lineStream >> part && component < 3) {
+                std::istringstream partStream(part);
+                std::string indexStr;
+                int v = -1, vt = -1;
+                if (std::getline(partStream, indexStr, '/') && !indexStr.empty()) v = std::stoi(indexStr);
+                if (std::getline(partStream, indexStr, '/') && !indexStr.empty()) vt = std::stoi(indexStr);
+                face.v[component] = v - 1;
+                face.vt[component] = vt - 1;
+                component++;
+            }
+            if (face.v[0] >= 0 && face.v[1] >= 0 && face.v[2] >= 0) {
+                faces.push_back(face);
+            }
+        }
+    }
+    return faces.size();
+}
+
+template <typename F>
+double medianMs(int iterations, F&& body) {
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        body();
+        auto end = std::chrono::high_resolution_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+void report(const char* name, double ms, size_t bytes) {
+    std::cout << "  " << name << ": " << ms << " ms (" << (bytes / (1024.0 * 1024.0)) / (ms / 1000.0) << " MB/s)" << std::endl;
+}
+
+// Checks that both paths produce the same triangles (legacy only keeps three corners per face)
+void verify(const tinyobj::attrib_t& attrib, const std::vector<LegacyFace>& faces, const ObjData& obj) {
+    if (attrib.vertices != obj.positions || attrib.texcoords != obj.texCoords) {
+        throw std::runtime_error("vertex attributes differ from tinyobj");
+    }
+    if (faces.size() != obj.triangleCount()) {
+        std::cout << "  note: " << obj.triangleCount() - faces.size()
+                  << " extra triangles from n-gon triangulation" << std::endl;
+        return;
+    }
+    for (size_t i = 0; i < faces.size(); i++) {
+        for (int c = 0; c < 3; c++) {
+            const ObjIndex& corner = obj.indices[i * 3 + c];
+            if (corner.position != faces[i].v[c] || corner.texCoord != faces[i].vt[c]) {
+                throw std::runtime_error("face indices differ at triangle " + std::to_string(i));
+            }
+        }
+        if (std::max(obj.triangleMaterials[i], 0) != faces[i].matId) {
+            throw std::runtime_error("material differs at triangle " + std::to_string(i));
+        }
+    }
+}
+
+// The hash the renderer used before VertexWelder: XOR-shifted glm hashes
+struct LegacyVertexHash {
+    size_t operator()(Vertex const& vertex) const {
+        return ((std::hash<glm::vec3>()(vertex.pos) ^ (std::hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
+               (std::hash<glm::vec2>()(vertex.texCoord) << 1);
+    }
+};
+
+// The previous dedup loop: count() followed by two operator[] lookups per corner
+void weldLegacy(const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::unordered_map<Vertex, uint32_t, LegacyVertexHash> uniqueVertices{};
+    vertices.clear();
+    indices.clear();
+    for (const auto& vertex : corners) {
+        if (uniqueVertices.count(vertex) == 0) {
+            uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(vertex);
+        }
+        indices.push_back(uniqueVertices[vertex]);
+    }
+}
+
+// Un-welds a mesh back to one vertex per corner
+std::vector<Vertex> expandCorners(const MeshData& mesh) {
+    std::vector<Vertex> corners;
+    corners.reserve(mesh.indices.size());
+    for (uint32_t index : mesh.indices) {
+        corners.push_back(mesh.vertices[index]);
+    }
+    return corners;
+}
+
+void benchmarkWelding(const std::vector<Vertex>& corners, int iterations, size_t maxThreads) {
+    std::vector<Vertex> expectedVertices, vertices;
+    std::vector<uint32_t> expectedIndices, indices;
+    size_t bytes = corners.size() * sizeof(Vertex);
+
+    double legacyMs = medianMs(iterations, [&] { weldLegacy(corners, expectedVertices, expectedIndices); });
+    report("unordered_map (legacy hash)", legacyMs, bytes);
+
+    auto check = [&](const char* name) {
+        if (vertices.size() != expectedVertices.size() || indices != expectedIndices ||
+            !std::equal(vertices.begin(), vertices.end(), expectedVertices.begin())) {
+            throw std::runtime_error(std::string(name) + " output differs from unordered_map");
+        }
+    };
+
+    double hashMs = medianMs(iterations, [&] {
+        weldVertices(corners.data(), corners.size(), vertices, indices, WeldMode::Hash);
+    });
+    report("flat hash", hashMs, bytes);
+    check("flat hash");
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        double ms = medianMs(iterations, [&] {
+            weldVertices(corners.data(), corners.size(), vertices, indices, WeldMode::Sort, &pool);
+        });
+        std::string label = "radix sort, " + std::to_string(threads) + " thread(s)";
+        report(label.c_str(), ms, bytes);
+        check("radix sort");
+    }
+    std::cout << "  " << corners.size() << " corners -> " << expectedVertices.size() << " vertices" << std::endl;
+}
+
+// Triangles as vertex values, rotated to start at the smallest corner and sorted, so
+// two meshes compare equal when they draw the same triangles in any order
+std::vector<std::array<Vertex, 3>> canonicalTriangles(const MeshData& mesh) {
+    auto less = [](const Vertex& a, const Vertex& b) {
+        return std::memcmp(&a, &b, sizeof(Vertex)) < 0;
+    };
+    std::vector<std::array<Vertex, 3>> triangles(mesh.indices.size() / 3);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        std::array<Vertex, 3> triangle = {mesh.vertices[mesh.indices[3 * t]], mesh.vertices[mesh.indices[3 * t + 1]],
+                                          mesh.vertices[mesh.indices[3 * t + 2]]};
+        auto first = std::min_element(triangle.begin(), triangle.end(), less);
+        std::rotate(triangle.begin(), first, triangle.end());
+        triangles[t] = triangle;
+    }
+    std::sort(triangles.begin(), triangles.end(), [&](const auto& a, const auto& b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), less);
+    });
+    return triangles;
+}
+
+void benchmarkOptimization(const MeshData& input, int iterations) {
+    MeshData optimized;
+    MeshOptimizationStats stats;
+    double ms = medianMs(iterations, [&] {
+        optimized = input;
+        stats = optimizeMesh(optimized);
+    });
+    report("optimizeMesh", ms, input.indices.size() * sizeof(uint32_t));
+    std::cout << "  ACMR " << stats.before.acmr << " -> " << stats.after.acmr << ", ATVR " << stats.before.atvr
+              << " -> " << stats.after.atvr << ", " << stats.clusterCount << " clusters" << std::endl;
+
+    auto before = canonicalTriangles(input);
+    auto after = canonicalTriangles(optimized);
+    if (before.size() != after.size() ||
+        std::memcmp(before.data(), after.data(), before.size() * sizeof(before[0])) != 0) {
+        throw std::runtime_error("optimizeMesh changed the triangle set");
+    }
+}
+
+// Rebuilds 32-bit global indices from a view's ranges, or from one LOD's ranges
+MeshData unsplitMesh(const MeshView& view, const MeshLod* lod = nullptr) {
+    MeshData mesh;
+    const Vertex* vertices = static_cast<const Vertex*>(view.vertexData);
+    mesh.vertices.assign(vertices, vertices + view.vertexCount);
+    size_t firstRange = lod ? lod->firstRange : 0;
+    size_t rangeCount = lod ? lod->rangeCount : view.ranges.size();
+    for (size_t r = firstRange; r < firstRange + rangeCount; r++) {
+        const DrawRange& range = view.ranges[r];
+        for (uint32_t i = range.firstIndex; i < range.firstIndex + range.indexCount; i++) {
+            uint32_t index = view.indexSize == sizeof(uint16_t) ? static_cast<const uint16_t*>(view.indexData)[i]
+                                                                : static_cast<const uint32_t*>(view.indexData)[i];
+            if (index >= range.vertexCount) {
+                throw std::runtime_error("index outside its draw range");
+            }
+            mesh.indices.push_back(index + range.vertexOffset);
+        }
+    }
+    return mesh;
+}
+
+void benchmarkShortIndices(const MeshData& input, int iterations) {
+    MeshData split;
+    double ms = medianMs(iterations, [&] {
+        split = input;
+        splitForShortIndices(split);
+    });
+    report("splitForShortIndices", ms, input.indices.size() * sizeof(uint32_t));
+    std::cout << "  " << input.indices.size() * sizeof(uint32_t) << " -> " << split.shortIndices.size() * sizeof(uint16_t)
+              << " index bytes, " << split.ranges.size() << " ranges, " << input.vertices.size() << " -> "
+              << split.vertices.size() << " vertices" << std::endl;
+
+    std::vector<uint8_t> vmesh = serializeMesh(split);
+    MeshData roundTrip = unsplitMesh(readMeshFile(vmesh.data(), vmesh.size()));
+    auto before = canonicalTriangles(input);
+    auto after = canonicalTriangles(roundTrip);
+    if (before.size() != after.size() ||
+        std::memcmp(before.data(), after.data(), before.size() * sizeof(before[0])) != 0) {
+        throw std::runtime_error("splitForShortIndices changed the triangle set");
+    }
+}
+
+void benchmarkLodChain(const MeshData& input, int iterations) {
+    MeshData chain;
+    double ms = medianMs(iterations, [&] {
+        chain = input;
+        buildLodChain(chain);
+    });
+    report("buildLodChain", ms, input.indices.size() * sizeof(uint32_t));
+
+    float diagonal = glm::length(input.boundsMax - input.boundsMin);
+    for (size_t level = 0; level < chain.lods.size(); level++) {
+        const MeshLod& lod = chain.lods[level];
+        // Material ranges of a level are contiguous in the index buffer
+        const DrawRange& range = chain.ranges[lod.firstRange];
+        VertexCacheStats stats = analyzeVertexCache(chain.indices.data() + range.firstIndex, lod.indexCount,
+                                                    chain.vertices.size());
+        std::cout << "  LOD " << level << ": " << lod.indexCount / 3 << " triangles ("
+                  << 100.0f * float(lod.indexCount) / float(input.indices.size()) << "%), error " << lod.error
+                  << " (" << 100.0f * lod.error / diagonal << "% of diagonal), ACMR " << stats.acmr << std::endl;
+    }
+
+    // Every level must survive the 16-bit split and the vmesh round trip unchanged
+    MeshData split = chain;
+    splitForShortIndices(split);
+    std::vector<uint8_t> vmesh = serializeMesh(split);
+    MeshView view = readMeshFile(vmesh.data(), vmesh.size());
+    if (view.lods.size() != chain.lods.size()) {
+        throw std::runtime_error(".vmesh lost LOD levels");
+    }
+    for (size_t level = 0; level < chain.lods.size(); level++) {
+        MeshData expected;
+        expected.vertices = chain.vertices;
+        const MeshLod& lod = chain.lods[level];
+        const DrawRange& range = chain.ranges[lod.firstRange];
+        expected.indices.assign(chain.indices.begin() + range.firstIndex,
+                                chain.indices.begin() + range.firstIndex + lod.indexCount);
+        auto before = canonicalTriangles(expected);
+        auto after = canonicalTriangles(unsplitMesh(view, &view.lods[level]));
+        if (before.size() != after.size() ||
+            std::memcmp(before.data(), after.data(), before.size() * sizeof(before[0])) != 0) {
+            throw std::runtime_error("LOD " + std::to_string(level) + " changed in the 16-bit split");
+        }
+    }
+}
+
+// Orbits the renderer's camera around the mesh and reports how much the meshlet culling
+// keeps. Every meshlet culled inside the frustum must only hold back faces.
+void benchmarkMeshlets(const MeshData& input, int iterations) {
+    MeshData split = input;
+    splitForShortIndices(split);
+    MeshData built;
+    double ms = medianMs(iterations, [&] {
+        built = split;
+        buildMeshlets(built);
+    });
+    report("buildMeshlets", ms, split.shortIndices.size() * sizeof(uint16_t));
+    std::cout << "  " << built.meshlets.size() << " meshlets, "
+              << float(built.meshletVertices.size()) / float(built.meshlets.size()) << " vertices and "
+              << float(built.meshletTriangles.size()) / float(built.meshlets.size()) << " triangles on average"
+              << std::endl;
+
+    MeshData before = unsplitMesh(makeMeshView(split));
+    MeshData after = unsplitMesh(makeMeshView(built));
+    VertexCacheStats cacheBefore = analyzeVertexCache(before.indices.data(), before.indices.size(), before.vertices.size());
+    VertexCacheStats cacheAfter = analyzeVertexCache(after.indices.data(), after.indices.size(), after.vertices.size());
+    std::cout << "  ACMR " << cacheBefore.acmr << " -> " << cacheAfter.acmr << std::endl;
+    auto trianglesBefore = canonicalTriangles(before);
+    auto trianglesAfter = canonicalTriangles(after);
+    if (trianglesBefore.size() != trianglesAfter.size() ||
+        std::memcmp(trianglesBefore.data(), trianglesAfter.data(), trianglesBefore.size() * sizeof(trianglesBefore[0])) != 0) {
+        throw std::runtime_error("buildMeshlets changed the triangle set");
+    }
+    // The mesh shader's view of each meshlet must match the index buffer run
+    for (const Meshlet& meshlet : built.meshlets) {
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+            uint32_t packed = built.meshletTriangles[meshlet.firstTriangle + t];
+            for (uint32_t k = 0; k < 3; k++) {
+                uint32_t local = (packed >> (8 * k)) & 0xFF;
+                uint32_t index = built.meshletVertices[meshlet.firstVertex + local];
+                if (local >= meshlet.vertexCount || index != built.shortIndices[meshlet.firstIndex + 3 * t + k]) {
+                    throw std::runtime_error("meshlet triangles do not match the index buffer");
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> vmesh = serializeMesh(built);
+    MeshView loaded = readMeshFile(vmesh.data(), vmesh.size());
+    if (loaded.meshlets.size() != built.meshlets.size() ||
+        std::memcmp(loaded.meshlets.data(), built.meshlets.data(), built.meshlets.size() * sizeof(Meshlet)) != 0 ||
+        loaded.meshletTriangleCount != built.meshletTriangles.size() ||
+        std::memcmp(loaded.meshletTriangles, built.meshletTriangles.data(), built.meshletTriangles.size() * sizeof(uint32_t)) != 0) {
+        throw std::runtime_error("meshlets changed in the vmesh round trip");
+    }
+
+    const MeshData& mesh = after;
+    const std::vector<Meshlet>& meshlets = built.meshlets;
+    glm::vec3 center = (input.boundsMin + input.boundsMax) * 0.5f;
+    float radius = glm::length(input.boundsMax - input.boundsMin) * 0.5f;
+    const Vertex* vertices = mesh.vertices.data();
+    std::vector<DrawRange> visible;
+    size_t kept = 0;
+    size_t total = 0;
+    size_t views = 0;
+    for (float elevation : {-0.5f, 0.0f, 0.7f}) {
+        for (int step = 0; step < 16; step++) {
+            float azimuth = float(step) * glm::two_pi<float>() / 16.0f;
+            glm::vec3 direction(std::cos(azimuth) * std::cos(elevation), std::sin(azimuth) * std::cos(elevation),
+                                std::sin(elevation));
+            Camera camera(center + direction * radius * 2.5f, center);
+            camera.setAspectRatio(1080.0f, 2400.0f);
+            MeshletCullInfo info = makeMeshletCullInfo(camera.getProjectionMatrix() * camera.getViewMatrix(),
+                                                       camera.getViewMatrix());
+
+            kept += cullMeshlets(meshlets, built.ranges, 0, uint32_t(meshlets.size()), info, visible);
+            total += mesh.indices.size() / 3;
+            views++;
+
+            for (const Meshlet& meshlet : meshlets) {
+                if (!isMeshletCulled(meshlet, info)) {
+                    continue;
+                }
+                for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + 3 * meshlet.triangleCount; i += 3) {
+                    const glm::vec3& p0 = vertices[mesh.indices[i]].pos;
+                    const glm::vec3& p1 = vertices[mesh.indices[i + 1]].pos;
+                    const glm::vec3& p2 = vertices[mesh.indices[i + 2]].pos;
+                    // Front faces point cross(p1 - p0, p2 - p0) away from the eye
+                    bool frontFacing = glm::dot(glm::cross(p1 - p0, p2 - p0), p0 - info.eye) > 0.0f;
+                    bool inFrustum = true;
+                    for (const glm::vec4& plane : info.frustumPlanes) {
+                        inFrustum = inFrustum && glm::dot(glm::vec3(plane), p0) + plane.w >= 0.0f;
+                    }
+                    if (frontFacing && inFrustum) {
+                        throw std::runtime_error("meshlet culling removed a visible triangle");
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "  orbit (" << views << " views): " << 100.0f * float(kept) / float(total)
+              << "% of triangles kept, " << visible.size() << " draws in the last view" << std::endl;
+}
+
+void benchmarkQuantization(const MeshData& mesh, int iterations) {
+    std::vector<PackedVertex> packed(mesh.vertices.size());
+    VertexQuantization quantization;
+    double ms = medianMs(iterations, [&] {
+        quantization = computeVertexQuantization(mesh.vertices.data(), mesh.vertices.size());
+        quantizeVertices(mesh.vertices.data(), mesh.vertices.size(), quantization, packed.data());
+    });
+    report("quantizeVertices", ms, mesh.vertices.size() * sizeof(Vertex));
+
+    // Worst error relative to the extent of each range
+    float positionError = 0.0f;
+    float texCoordError = 0.0f;
+    glm::vec3 extent = glm::max(glm::vec3(quantization.positionScale) * 2.0f, glm::vec3(FLT_MIN));
+    glm::vec2 uvExtent = glm::max(glm::vec2(quantization.texCoordScaleBias), glm::vec2(FLT_MIN));
+    for (size_t i = 0; i < packed.size(); i++) {
+        Vertex decoded = dequantizeVertex(packed[i], quantization);
+        glm::vec3 dp = glm::abs(decoded.pos - mesh.vertices[i].pos) / extent;
+        glm::vec2 dt = glm::abs(decoded.texCoord - mesh.vertices[i].texCoord) / uvExtent;
+        positionError = std::max({positionError, dp.x, dp.y, dp.z});
+        texCoordError = std::max({texCoordError, dt.x, dt.y});
+    }
+    std::cout << "  " << sizeof(Vertex) << " -> " << sizeof(PackedVertex) << " bytes per vertex, max error "
+              << positionError << " of extent (position), " << texCoordError << " (UV)" << std::endl;
+}
+
+bool sameObj(const ObjData& a, const ObjData& b) {
+    return a.positions == b.positions && a.texCoords == b.texCoords && a.normals == b.normals &&
+           a.indices == b.indices && a.triangleMaterials == b.triangleMaterials &&
+           a.materialNames == b.materialNames && a.materialLibraries == b.materialLibraries;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "../assets/viking_room.obj";
+    int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+    size_t maxThreads = argc > 3 ? std::max(1, std::atoi(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+    std::string cacheDirectory = argc > 4 ? argv[4] : "/tmp/meshBenchmark-cache";
+
+    try {
+        std::vector<char> data = readFile(path);
+        std::cout << path << ": " << data.size() << " bytes, " << iterations << " iterations (median)" << std::endl;
+
+        tinyobj::attrib_t attrib;
+        std::vector<LegacyFace> faces;
+        double legacyMs = medianMs(iterations, [&] { loadLegacy(data, attrib, faces); });
+
+        ObjData obj;
+        double parserMs = medianMs(iterations, [&] { parseObj(data.data(), data.size(), obj); });
+
+        std::cout << "OBJ parse" << std::endl;
+        report("tinyobj + istringstream", legacyMs, data.size());
+        report("ObjParser", parserMs, data.size());
+        std::cout << "  speedup: " << legacyMs / parserMs << "x" << std::endl;
+        std::cout << "  " << obj.positions.size() / 3 << " positions, " << obj.texCoords.size() / 2
+                  << " texcoords, " << obj.triangleCount() << " triangles" << std::endl;
+
+        verify(attrib, faces, obj);
+
+        // Chunked parsing; small chunks so even the sample assets are split
+        std::cout << "Parallel OBJ parse" << std::endl;
+        const size_t chunkSize = std::max<size_t>(data.size() / (maxThreads * 4), 16 * 1024);
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            ThreadPool pool(threads);
+            ObjData parallel;
+            double ms = medianMs(iterations, [&] { parseObjParallel(data.data(), data.size(), parallel, pool, chunkSize); });
+            std::string label = std::to_string(threads) + " thread(s)";
+            report(label.c_str(), ms, data.size());
+            if (!sameObj(obj, parallel)) {
+                throw std::runtime_error("parallel parse differs from serial parse");
+            }
+        }
+
+        // Full OBJ -> renderer mesh versus loading the preprocessed .vmesh
+        std::cout << "Mesh load" << std::endl;
+        MeshData mesh;
+        double buildMs = medianMs(iterations, [&] {
+            parseObj(data.data(), data.size(), obj);
+            buildMesh(obj, {}, mesh);
+        });
+        std::vector<uint8_t> vmesh = serializeMesh(mesh);
+        std::vector<uint8_t> staging(mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(uint32_t));
+        double vmeshMs = medianMs(iterations, [&] {
+            MeshView view = readMeshFile(vmesh.data(), vmesh.size());
+            std::memcpy(staging.data(), view.vertexData, view.vertexBytes());
+            std::memcpy(staging.data() + view.vertexBytes(), view.indexData, view.indexBytes());
+        });
+        report("OBJ parse + build", buildMs, data.size());
+        report(".vmesh read + memcpy", vmeshMs, vmesh.size());
+        if (std::memcmp(staging.data(), mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex)) != 0) {
+            throw std::runtime_error(".vmesh round trip differs");
+        }
+
+        // What a warm start pays instead of the OBJ build: hashing the source, then
+        // mapping the cached .vmesh bytes
+        std::cout << "Asset cache (" << cacheDirectory << ")" << std::endl;
+        AssetCache cache(cacheDirectory);
+        uint64_t contentHash = 0;
+        double hashMs = medianMs(iterations, [&] { contentHash = hashBytes(data.data(), data.size()); });
+        const std::string cacheKey = AssetCache::makeKey("meshBenchmark", 1, contentHash);
+        double storeMs = medianMs(iterations, [&] {
+            if (!cache.store(cacheKey, nullptr, 0, vmesh.data(), vmesh.size())) {
+                throw std::runtime_error("failed to store into " + cacheDirectory);
+            }
+        });
+        double warmMs = medianMs(iterations, [&] {
+            AssetData entry = cache.load(cacheKey);
+            MeshView view = readMeshFile(entry.data, entry.size);
+            std::memcpy(staging.data(), view.vertexData, view.vertexBytes());
+            std::memcpy(staging.data() + view.vertexBytes(), view.indexData, view.indexBytes());
+        });
+        report("content hash", hashMs, data.size());
+        report("store (write + fsync + rename)", storeMs, vmesh.size());
+        report("warm load (map + read + memcpy)", warmMs, vmesh.size());
+        AssetCache::Stats cacheStats = cache.stats();
+        std::cout << "  " << cacheStats.hits << " hits, " << cacheStats.misses << " misses, " << cacheStats.bytes
+                  << " bytes cached" << std::endl;
+
+        std::cout << "Vertex welding" << std::endl;
+        std::vector<Vertex> corners = expandCorners(mesh);
+        benchmarkWelding(corners, iterations, maxThreads);
+
+        std::cout << "Mesh optimization" << std::endl;
+        benchmarkOptimization(mesh, iterations);
+
+        std::cout << "16-bit indices" << std::endl;
+        benchmarkShortIndices(mesh, iterations);
+
+        std::cout << "LOD chain" << std::endl;
+        MeshData optimized = mesh;
+        optimizeMesh(optimized);
+        benchmarkLodChain(optimized, iterations);
+
+        std::cout << "Meshlets" << std::endl;
+        benchmarkMeshlets(optimized, iterations);
+
+        std::cout << "Vertex quantization" << std::endl;
+        benchmarkQuantization(mesh, iterations);
+
+        // Large synthetic input: 64 translated copies of the model
+        std::cout << "Vertex welding, 64 copies" << std::endl;
+        std::vector<Vertex> largeCorners;
+        largeCorners.reserve(corners.size() * 64);
+        for (int copy = 0; copy < 64; copy++) {
+            for (Vertex vertex : corners) {
+                vertex.pos.x += float(copy) * 10.0f;
+                largeCorners.push_back(vertex);
+            }
+        }
+        benchmarkWelding(largeCorners, std::max(1, iterations / 4), maxThreads);
+
+        std::cout << "Mesh optimization, 64 copies" << std::endl;
+        MeshData largeMesh;
+        weldVertices(largeCorners.data(), largeCorners.size(), largeMesh.vertices, largeMesh.indices);
+        benchmarkOptimization(largeMesh, std::max(1, iterations / 4));
+
+        std::cout << "16-bit indices, 64 copies" << std::endl;
+        optimizeMesh(largeMesh);
+        benchmarkShortIndices(largeMesh, std::max(1, iterations / 4));
+
+        std::cout << "LOD chain, 64 copies" << std::endl;
+        largeMesh.boundsMin = glm::vec3(FLT_MAX);
+        largeMesh.boundsMax = glm::vec3(-FLT_MAX);
+        for (const Vertex& vertex : largeMesh.vertices) {
+            largeMesh.boundsMin = glm::min(largeMesh.boundsMin, vertex.pos);
+            largeMesh.boundsMax = glm::max(largeMesh.boundsMax, vertex.pos);
+        }
+        benchmarkLodChain(largeMesh, 1);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+// Offline converter: OBJ (+MTL) -> .vmesh, using the same parse/build path as loadModel.
+// Not part of the Android build.
+//
+// Build from app/src/main/cpp:
+//   g++ -O2 -std=c++17 -pthread -I. -Ilib/glm-1.0.3 tools/vmeshconv.cpp AssetSource.cpp ObjParser.cpp ThreadPool.cpp MeshBuilder.cpp MeshFile.cpp MeshletBuilder.cpp MeshOptimizer.cpp MeshSimplifier.cpp VertexWelder.cpp -o vmeshconv
+// Usage:
+//   ./vmeshconv ../assets/logo.obj [../assets/logo.vmesh]
+
+#include "AssetSource.h"
+#include "MeshBuilder.h"
+#include "MeshFile.h"
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+std::string fileNameOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+std::string replaceExtension(const std::string& path, const std::string& extension) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + extension;
+    }
+    return path.substr(0, dot) + extension;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " input.obj [output.vmesh]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string inputPath = argv[1];
+    std::string outputPath = argc > 2 ? argv[2] : replaceExtension(inputPath, ".vmesh");
+
+    try {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        // MTL paths are relative to the OBJ, as they are in the assets folder
+        DirectoryAssetSource assets(directoryOf(inputPath));
+        AssetData objData = assets.open(fileNameOf(inputPath));
+        if (!objData) {
+            throw std::runtime_error("failed to open " + inputPath);
+        }
+        ThreadPool pool;
+        ObjData obj;
+        parseObjParallel(objData.chars(), objData.size, obj, pool);
+
+        std::vector<MtlMaterial> materials;
+        if (!obj.materialLibraries.empty()) {
+            AssetData mtlData = assets.open(obj.materialLibraries.front());
+            if (mtlData) {
+                materials = parseMtl(mtlData.chars(), mtlData.size);
+            } else {
+                std::cerr << "warning: failed to open " << obj.materialLibraries.front()
+                          << ", materials will use texture 0" << std::endl;
+            }
+        }
+
+        MeshData mesh;
+        buildMesh(obj, materials, mesh, &pool);
+        MeshOptimizationStats optimization = optimizeMesh(mesh);
+        buildLodChain(mesh);
+        splitForShortIndices(mesh);
+        buildMeshlets(mesh);
+        writeMeshFile(outputPath, mesh);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << inputPath << " -> " << outputPath << " (" << ms << " ms)" << std::endl;
+        std::cout << "  " << mesh.vertices.size() << " vertices, " << mesh.shortIndices.size() / 3 << " triangles (all LODs) in "
+                  << mesh.ranges.size() << " ranges, " << mesh.meshlets.size() << " meshlets, "
+                  << mesh.textures.size() << " textures" << std::endl;
+        std::cout << "  ACMR " << optimization.before.acmr << " -> " << optimization.after.acmr
+                  << ", ATVR " << optimization.before.atvr << " -> " << optimization.after.atvr
+                  << ", " << optimization.clusterCount << " overdraw clusters" << std::endl;
+        for (size_t i = 0; i < mesh.lods.size(); i++) {
+            std::cout << "  LOD " << i << ": " << mesh.lods[i].indexCount / 3 << " triangles in "
+                      << mesh.lods[i].rangeCount << " ranges, error " << mesh.lods[i].error << std::endl;
+        }
+        for (size_t i = 0; i < mesh.textures.size(); i++) {
+            std::cout << "  texture " << i << ": " << mesh.textures[i] << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+// Offline converter: PNG -> .vtex tile file for the virtual texturing path, named the way
+// VulkanRenderer looks for it next to the PNG. Not part of the Android build.
+//
+// Build from app/src/main/cpp:
+//   g++ -O2 -std=c++17 -I. -Ilib/stb-master tools/vtexconv.cpp tools/ZstdCompress.cpp VirtualTextureFile.cpp MipChain.cpp AssetCache.cpp AssetSource.cpp Zstd.cpp -lzstd -o vtexconv
+// Usage:
+//   ./vtexconv [--zstd] ../assets/lambert5SG_baseColor.png ...
+// writes ../assets/lambert5SG_baseColor.vtex.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "VirtualTextureFile.h"
+#include "Zstd.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string replaceExtension(const std::string& path, const std::string& extension) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + extension;
+    }
+    return path.substr(0, dot) + extension;
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    if (!file) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ZstdCompressor compress = nullptr;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--zstd") {
+            compress = zstdCompress;
+        } else {
+            inputs.push_back(argument);
+        }
+    }
+    if (inputs.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--zstd] input.png..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        for (const std::string& inputPath : inputs) {
+            auto start = std::chrono::high_resolution_clock::now();
+            int width, height, channels;
+            stbi_uc* pixels = stbi_load(inputPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            if (!pixels) {
+                throw std::runtime_error("failed to load " + inputPath + ": " + stbi_failure_reason());
+            }
+            std::vector<uint8_t> file;
+            try {
+                file = serializeVirtualTexture(uint32_t(width), uint32_t(height), pixels, compress);
+            } catch (...) {
+                stbi_image_free(pixels);
+                throw;
+            }
+            stbi_image_free(pixels);
+
+            std::string outputPath = replaceExtension(inputPath, ".vtex");
+            writeFile(outputPath, file);
+
+            VirtualTextureHeader header;
+            std::memcpy(&header, file.data(), sizeof(header));
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            std::cout << inputPath << ": " << width << "x" << height << " -> " << outputPath << ": "
+                      << header.levelCount << " levels, " << header.tileCount << " tiles, " << file.size()
+                      << " bytes on disk (" << ms << " ms)" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,17 @@
+#version 450
+
+layout(binding = 1) uniform sampler2D texSamplers[16];
+
+// Texture of the current draw range; push constants keep the index dynamically uniform
+layout(push_constant) uniform Material {
+    uint texture;
+} material;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(texSamplers[material.texture], fragTexCoord);
+}
\ No newline at end of file
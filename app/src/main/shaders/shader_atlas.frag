@@ -0,0 +1,42 @@
+#version 450
+
+// Fragment shader of the packed texture mode (VulkanRenderer::createPackedTexture): every
+// texture lives in one array image, and the table below says where.
+// Compile with: glslc shader_atlas.frag -o shader_atlas.frag.spv
+
+layout(binding = 1) uniform sampler2DArray textures;
+
+// TextureRect (TexturePacker.h)
+struct TextureRect {
+    vec2 scale;
+    vec2 bias;
+    float layer;  // negative for a missing texture
+    float padding[3];
+};
+
+layout(std430, binding = 2) readonly buffer TextureRects {
+    TextureRect rects[];
+};
+
+// Texture of the current draw range; push constants keep the index dynamically uniform
+layout(push_constant) uniform Material {
+    uint texture;
+} material;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    TextureRect rect = rects[material.texture];
+    if (rect.layer < 0.0) {
+        outColor = vec4(1.0);
+        return;
+    }
+    // The tile repeats through fract; the gradients of the unwrapped coordinate keep the
+    // mip level and anisotropy steady across the wrap
+    vec2 uv = fract(fragTexCoord) * rect.scale + rect.bias;
+    outColor = textureGrad(textures, vec3(uv, rect.layer), dFdx(fragTexCoord) * rect.scale,
+                           dFdy(fragTexCoord) * rect.scale);
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Fragment shader of the bindless texture mode (VK_EXT_descriptor_indexing): binding 1
+// is a runtime-sized table of every registered texture, and the push constant is a slot
+// of TextureTable rather than an index into the registry.
+// Compile with: glslc shader_bindless.frag -o shader_bindless.frag.spv
+
+layout(binding = 1) uniform sampler2D textures[];
+
+// Slot of the current draw range's texture; push constants keep it dynamically uniform
+layout(push_constant) uniform Material {
+    uint texture;
+} material;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(textures[material.texture], fragTexCoord);
+}
\ No newline at end of file
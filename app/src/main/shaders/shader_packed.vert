@@ -0,0 +1,31 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// Matches DrawPushConstants (VulkanRenderer.h): the transform and dequantization
+// constants of the drawn model; the texture index at offset 0 is read by the fragment
+// shader
+layout(push_constant) uniform Model {
+    layout(offset = 16) mat4 transform;
+    vec4 positionScale;
+    vec4 positionBias;
+    vec4 texCoordScaleBias;
+} model;
+
+// PackedVertex: snorm16 position, unorm16 UV
+layout(location = 0) in vec4 inPosition;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+void main() {
+    vec3 position = inPosition.xyz * model.positionScale.xyz + model.positionBias.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * model.transform * vec4(position, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = inTexCoord * model.texCoordScaleBias.xy + model.texCoordScaleBias.zw;
+}
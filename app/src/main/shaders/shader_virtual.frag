@@ -0,0 +1,89 @@
+#version 450
+
+// Fragment shader of the virtual texturing mode (VulkanRenderer::createVirtualTextures):
+// binding 1 is the physical cache of 128x128 tiles with a 4 texel border each, and the
+// page table says which tile holds each page of each texture. Pages that are not
+// resident point at their closest resident ancestor. One pixel of every 8x8 block, which
+// the renderer rotates each frame, reports the page it wanted, so the CPU learns what to
+// load next.
+// Compile with: glslc shader_virtual.frag -o shader_virtual.frag.spv
+
+layout(binding = 1) uniform sampler2D cache;
+
+// VirtualTextureInfo (VulkanRenderer.h)
+struct VirtualTextureInfo {
+    uint width;
+    uint height;
+    uint levelCount;  // 0 for a missing texture
+    uint firstPage;
+    uint levelFirstPage[16];
+};
+
+layout(std430, binding = 2) readonly buffer VirtualTextures {
+    VirtualTextureInfo textures[];
+};
+
+// Header (the feedback pixel of this frame, the cache size in texels, two unused words),
+// then the VirtualTextureCache entry of every page
+layout(std430, binding = 3) readonly buffer PageTable {
+    uint pageTable[];
+};
+
+// One bit per page, cleared by the CPU once it has read them
+layout(std430, binding = 4) buffer Feedback {
+    uint requested[];
+};
+
+// Texture of the current draw range; push constants keep the index dynamically uniform
+layout(push_constant) uniform Material {
+    uint texture;
+} material;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+const uint TILE_SIZE = 128u;
+const float TILE_BORDER = 4.0;
+const float TILE_STRIDE = 136.0;
+const uint ENTRY_VALID = 0x80000000u;
+
+void main() {
+    VirtualTextureInfo info = textures[material.texture];
+    if (info.levelCount == 0u) {
+        outColor = vec4(1.0);
+        return;
+    }
+    uvec2 size = uvec2(info.width, info.height);
+
+    // The level the sampler would pick, from the texels one pixel steps over
+    vec2 dx = dFdx(fragTexCoord) * vec2(size);
+    vec2 dy = dFdy(fragTexCoord) * vec2(size);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));
+    uint level = uint(clamp(floor(lod), 0.0, float(info.levelCount - 1u)));
+
+    vec2 uv = fract(fragTexCoord);
+    uvec2 levelSize = max(size >> level, uvec2(1u));
+    uvec2 pages = (levelSize + TILE_SIZE - 1u) / TILE_SIZE;
+    uvec2 page = min(uvec2(uv * vec2(levelSize)) / TILE_SIZE, pages - 1u);
+    uint index = info.firstPage + info.levelFirstPage[level] + page.y * pages.x + page.x;
+
+    uvec2 pixel = uvec2(gl_FragCoord.xy) & 7u;
+    if (pixel.x + pixel.y * 8u == pageTable[0]) {
+        atomicOr(requested[index >> 5], 1u << (index & 31u));
+    }
+
+    uint entry = pageTable[4u + index];
+    if ((entry & ENTRY_VALID) == 0u) {
+        outColor = vec4(1.0);
+        return;
+    }
+    // uv in the tile of the level that is resident, then in the cache image
+    uint residentLevel = (entry >> 16) & 0x1Fu;
+    vec2 texel = uv * vec2(max(size >> residentLevel, uvec2(1u)));
+    vec2 inTile = texel - floor(texel / float(TILE_SIZE)) * float(TILE_SIZE);
+    vec2 slot = vec2(entry & 0xFFu, (entry >> 8) & 0xFFu);
+    vec2 cacheUv = (slot * TILE_STRIDE + TILE_BORDER + inTile) / float(pageTable[1]);
+    outColor = textureLod(cache, cacheUv, 0.0);
+}
\ No newline at end of file